@@ -0,0 +1 @@
+../src/sha3_cm0.s
\ No newline at end of file
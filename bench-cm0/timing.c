@@ -9,6 +9,12 @@
 uint32_t get_system_ticks(void);
 void usart_send(uint8_t x);
 
+/* Bottom of the stack area (from the linker script). */
+extern uint32_t _sstack;
+
+/* Keccak-f[1600] permutation (sha3_cm0.s). */
+void curve9767_inner_keccak_f1600(uint64_t *A);
+
 static void
 send_mult_chars(char c, size_t len)
 {
@@ -266,6 +272,43 @@ do_benchmark_slow(const char *name, funbench fun,
 	prf("\n");
 }
 
+/*
+ * Stack usage measure (stack painting): the free part of the stack area
+ * (from the bottom of the stack to the current stack pointer) is filled
+ * with a pattern, the function is called once, and the painted area is
+ * then scanned for the lowest overwritten word. The returned value is
+ * the peak stack usage of the call, in bytes (interrupt handlers that
+ * run during the call may add to it).
+ */
+#define STACK_PATTERN   0xA5A5A5A5
+
+uint32_t
+stack_usage(funbench fun, void *a0, void *a1, void *a2, void *a3,
+	void *a4, void *a5, void *a6)
+{
+	uint32_t *sp, *p;
+
+	__asm__ __volatile__ ("mov %0, sp" : "=r" (sp));
+	for (p = &_sstack; p < sp; p ++) {
+		*p = STACK_PATTERN;
+	}
+	fun(a0, a1, a2, a3, a4, a5, a6);
+	for (p = &_sstack; p < sp; p ++) {
+		if (*p != STACK_PATTERN) {
+			break;
+		}
+	}
+	return (uint32_t)((uint8_t *)sp - (uint8_t *)p);
+}
+
+void
+do_stack_usage(const char *name, funbench fun,
+	void *a0, void *a1, void *a2, void *a3, void *a4, void *a5, void *a6)
+{
+	prf("%-25s %10u\n", name,
+		stack_usage(fun, a0, a1, a2, a3, a4, a5, a6));
+}
+
 /*
  * These scalar values were generated randomly with Sage. They are
  * encoded in the usual unsigned little-endian format.
@@ -781,9 +824,10 @@ int
 main(void)
 {
 	field_element a, b, c;
-	curve9767_point Q2;
-	curve9767_scalar k;
-	uint8_t bb[32];
+	curve9767_point Q1, Q2;
+	curve9767_scalar k, k2;
+	uint8_t bb[32], t[32], sig[64], hv[64];
+	uint64_t kst[25];
 
 	/*
 	 * Q2 = k*G
@@ -833,6 +877,13 @@ main(void)
 	do_benchmark_fast("SHAKE256 48 -> 32",
 		(funbench)&do_shake256, bb, (void *)sizeof bb,
 		(void *)seed48, (void *)sizeof seed48, 0, 0, 0);
+	/*
+	 * One Keccak-f[1600] invocation is the cost of one SHAKE256
+	 * block (136 bytes), excluding the input/output byte handling.
+	 */
+	memset(kst, 0, sizeof kst);
+	do_benchmark_fast("keccak_f1600 (1 block)",
+		(funbench)&curve9767_inner_keccak_f1600, kst, 0, 0, 0, 0, 0, 0);
 
 	do_benchmark_fast("gf_mul",
 		(funbench)&curve9767_inner_gf_mul, &a, &b, &c, 0, 0, 0, 0);
@@ -847,6 +898,16 @@ main(void)
 	do_benchmark_fast("gf_cubert",
 		(funbench)&curve9767_inner_gf_cubert, &a, &b, 0, 0, 0, 0, 0);
 
+	curve9767_scalar_decode_strict(&k2, bk, sizeof bk);
+	do_shake256(hv, sizeof hv, seed48, sizeof seed48);
+	do_benchmark_fast("scalar_add",
+		(funbench)&curve9767_scalar_add, &k2, &k2, &k, 0, 0, 0, 0);
+	do_benchmark_fast("scalar_mul",
+		(funbench)&curve9767_scalar_mul, &k2, &k2, &k, 0, 0, 0, 0);
+	do_benchmark_fast("scalar_decode_reduce (64)",
+		(funbench)&curve9767_scalar_decode_reduce,
+		&k2, hv, (void *)sizeof hv, 0, 0, 0, 0);
+
 	memcpy(&Q2, &curve9767_generator, sizeof Q2);
 	do_benchmark_fast("point_add",
 		(funbench)&curve9767_point_add, &Q2, &Q2, &Q2, 0, 0, 0, 0);
@@ -909,5 +970,56 @@ main(void)
 	do_benchmark_reduce_basis();
 	do_benchmark_signature_vartime();
 
+	/*
+	 * Peak stack usage of the main API functions. Build with
+	 * 'make LOWRAM=1' for the low-RAM profile (smaller windows in
+	 * point_mul, point_mul_mulgen_add and verify_vartime); comparing
+	 * the output of both builds gives the cycles/RAM trade-off.
+	 */
+	prf("\n");
+	prf("stack usage (bytes), profile: %s\n",
+		CURVE9767_LOWRAM ? "low-RAM" : "default");
+	curve9767_keygen(&k, t, &Q1, seed48, sizeof seed48);
+	curve9767_sign_generate(sig, &k, t, &Q1,
+		CURVE9767_OID_SHA3_256, seed48, 32);
+	do_stack_usage("keccak_f1600",
+		(funbench)&curve9767_inner_keccak_f1600, kst, 0, 0, 0, 0, 0, 0);
+	do_stack_usage("point_add",
+		(funbench)&curve9767_point_add, &Q2, &Q1, &Q1, 0, 0, 0, 0);
+	do_stack_usage("point_mul16",
+		(funbench)&curve9767_point_mul2k,
+		&Q2, &Q1, (void *)4, 0, 0, 0, 0);
+	do_stack_usage("point_decode",
+		(funbench)&curve9767_point_decode,
+		&Q2, (void *)bQ2, 0, 0, 0, 0, 0);
+	do_stack_usage("point_mul",
+		(funbench)&curve9767_point_mul, &Q2, &Q1, &k, 0, 0, 0, 0);
+	do_stack_usage("point_mulgen",
+		(funbench)&curve9767_point_mulgen, &Q2, &k, 0, 0, 0, 0, 0);
+	do_stack_usage("point_mul_mulgen_add",
+		(funbench)&curve9767_point_mul_mulgen_add,
+		&Q2, &Q1, &k, &k, 0, 0, 0);
+	do_stack_usage("hash_to_curve",
+		(funbench)&do_hash_to_curve,
+		&Q2, (void *)seed48, (void *)sizeof seed48, 0, 0, 0, 0);
+	do_stack_usage("ecdh_keygen",
+		(funbench)&curve9767_ecdh_keygen,
+		&k, bb, (void *)seed48, (void *)sizeof seed48, 0, 0, 0);
+	do_stack_usage("ecdh_recv",
+		(funbench)&curve9767_ecdh_recv,
+		bb, (void *)sizeof bb, &k, bb, 0, 0, 0);
+	do_stack_usage("sign_generate",
+		(funbench)&curve9767_sign_generate,
+		sig, &k, t, &Q1, CURVE9767_OID_SHA3_256,
+		(void *)seed48, (void *)32);
+	do_stack_usage("sign_verify",
+		(funbench)&curve9767_sign_verify,
+		sig, &Q1, CURVE9767_OID_SHA3_256,
+		(void *)seed48, (void *)32, 0, 0);
+	do_stack_usage("sign_verify_vartime",
+		(funbench)&curve9767_sign_verify_vartime,
+		sig, &Q1, CURVE9767_OID_SHA3_256,
+		(void *)seed48, (void *)32, 0, 0);
+
 	return 0;
 }
@@ -827,8 +827,8 @@ main(void)
 {
 	field_element a, b, c;
 	curve9767_point Q2;
-	curve9767_scalar k;
-	uint8_t bb[32];
+	curve9767_scalar k, k2;
+	uint8_t bb[32], hv[64];
 
 	/* Setup clock. */
 	rcc_clock_setup_pll(&benchmarkclock);
@@ -939,6 +939,16 @@ main(void)
 	do_benchmark_fast("gf_cubert",
 		(funbench)&curve9767_inner_gf_cubert, &a, &b, 0, 0, 0, 0, 0);
 
+	curve9767_scalar_decode_strict(&k2, bk, sizeof bk);
+	do_shake256(hv, sizeof hv, seed48, sizeof seed48);
+	do_benchmark_fast("scalar_add",
+		(funbench)&curve9767_scalar_add, &k2, &k2, &k, 0, 0, 0, 0);
+	do_benchmark_fast("scalar_mul",
+		(funbench)&curve9767_scalar_mul, &k2, &k2, &k, 0, 0, 0, 0);
+	do_benchmark_fast("scalar_decode_reduce (64)",
+		(funbench)&curve9767_scalar_decode_reduce,
+		&k2, hv, (void *)sizeof hv, 0, 0, 0, 0);
+
 	memcpy(&Q2, &curve9767_generator, sizeof Q2);
 	do_benchmark_fast("point_add",
 		(funbench)&curve9767_point_add, &Q2, &Q2, &Q2, 0, 0, 0, 0);
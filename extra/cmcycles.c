@@ -0,0 +1,577 @@
+/*
+ * QEMU TCG plugin: per-function instruction counts and cycle estimates
+ * for the ARM Cortex-M0+ and Cortex-M4 test binaries (built with
+ * src/Makefile.cm0 and src/Makefile.cm4, and run with qemu-arm).
+ *
+ * QEMU is not cycle-accurate; this plugin applies a simple static
+ * cycle model to each executed instruction, and accumulates the counts
+ * per function symbol. The model follows the instruction timings of
+ * the Cortex-M0+ and Cortex-M4 technical reference manuals, with the
+ * following simplifications:
+ *
+ *   - No wait states (code and data in zero-wait-state memory).
+ *   - Conditional branches: the extra cost of a taken branch is added
+ *     when the next executed block does not start at the fall-through
+ *     address. Instructions in IT blocks (M4) are always counted as
+ *     executed.
+ *   - Cortex-M4: branch pipeline refill (P) is counted as 2 cycles;
+ *     LDR is counted as 1 cycle when it immediately follows another
+ *     single load or store (pipelined), 2 otherwise; STR is 2 cycles
+ *     (stores of N words were measured at N+1 cycles on the STM32F407,
+ *     see src/ops_cm4.s); UDIV/SDIV are counted as 7 cycles (actual:
+ *     2 to 12).
+ *   - Cortex-M0+: single-cycle multiplier (as on the SAM D20).
+ *   - ARM-mode (32-bit) instructions, which may appear in the C
+ *     library, count as 1 cycle each.
+ *
+ * The estimates are therefore meant to compare successive versions of
+ * the same code (e.g. in continuous integration), not to replace
+ * measures on actual hardware (bench-cm0/ and bench-cm4/). Applied to
+ * the straight-line code of gf_mul_inner() and gf_sqr_inner(), the
+ * Cortex-M0+ model yields 1573 and 993 cycles (measured: 1574 and 994);
+ * the Cortex-M4 model yields 606 and 347 cycles (measured: 628 and 396),
+ * i.e. it underestimates by 3 to 12%.
+ *
+ * Build (the QEMU source tree provides include/qemu/qemu-plugin.h):
+ *
+ *   gcc -O2 -shared -fPIC -I/path/to/qemu/include/qemu \
+ *       $(pkg-config --cflags glib-2.0) -o cmcycles.so cmcycles.c
+ *
+ * Use (see also cmcycles.sh):
+ *
+ *   qemu-arm -plugin ./cmcycles.so,model=m0,top=40 -d plugin \
+ *       ./test_curve9767
+ *
+ * Plugin arguments:
+ *   model=m0|m4   cycle model (default: m0)
+ *   top=N         number of functions to report (default: 40; 0 = all)
+ */
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <qemu-plugin.h>
+
+QEMU_PLUGIN_EXPORT int qemu_plugin_version = QEMU_PLUGIN_VERSION;
+
+#define MODEL_M0   0
+#define MODEL_M4   1
+
+static int model = MODEL_M0;
+static size_t top = 40;
+
+/* ====================================================================== */
+/*
+ * Per-function counters. Functions are identified by the symbol name
+ * returned by QEMU (the pointer is stable for the whole run); they are
+ * kept in an open-addressing hash table, which is accessed only at
+ * translation time (under a lock). Counters are updated with atomic
+ * additions, since several guest threads may run concurrently.
+ */
+
+typedef struct {
+	const char *name;
+	uint64_t insns;
+	uint64_t cycles;
+} func_stats;
+
+static pthread_mutex_t func_lock = PTHREAD_MUTEX_INITIALIZER;
+static func_stats **func_table;
+static size_t func_table_len;
+static size_t func_num;
+
+static uint32_t
+hash_name(const char *name)
+{
+	uint32_t h;
+
+	h = 2166136261u;
+	while (*name != 0) {
+		h = (h ^ (uint8_t)*name ++) * 16777619u;
+	}
+	return h;
+}
+
+static func_stats *
+func_lookup(const char *name)
+{
+	func_stats *f;
+	size_t u, mask;
+
+	if (name == NULL) {
+		name = "[unknown]";
+	}
+	pthread_mutex_lock(&func_lock);
+	if ((func_num + 1) * 2 > func_table_len) {
+		func_stats **nt;
+		size_t nlen, v;
+
+		nlen = func_table_len == 0 ? 1024 : func_table_len << 1;
+		nt = calloc(nlen, sizeof *nt);
+		if (nt == NULL) {
+			abort();
+		}
+		for (v = 0; v < func_table_len; v ++) {
+			if (func_table[v] != NULL) {
+				u = hash_name(func_table[v]->name) & (nlen - 1);
+				while (nt[u] != NULL) {
+					u = (u + 1) & (nlen - 1);
+				}
+				nt[u] = func_table[v];
+			}
+		}
+		free(func_table);
+		func_table = nt;
+		func_table_len = nlen;
+	}
+	mask = func_table_len - 1;
+	u = hash_name(name) & mask;
+	for (;;) {
+		f = func_table[u];
+		if (f == NULL) {
+			f = calloc(1, sizeof *f);
+			if (f == NULL) {
+				abort();
+			}
+			f->name = name;
+			func_table[u] = f;
+			func_num ++;
+			break;
+		}
+		if (strcmp(f->name, name) == 0) {
+			break;
+		}
+		u = (u + 1) & mask;
+	}
+	pthread_mutex_unlock(&func_lock);
+	return f;
+}
+
+/* ====================================================================== */
+/*
+ * Cycle model. insn_cost() returns the cost of an instruction (for a
+ * conditional branch, the cost when not taken; the extra cost when
+ * taken is written in *taken_extra, which is otherwise set to 0).
+ * Parameter *prev_ldst is the "previous instruction was a single load
+ * or store" flag, used and updated for the Cortex-M4 load pipelining.
+ */
+
+static unsigned
+popcount16(unsigned x)
+{
+	unsigned n;
+
+	n = 0;
+	while (x != 0) {
+		n += x & 1;
+		x >>= 1;
+	}
+	return n;
+}
+
+static unsigned
+branch_cost(void)
+{
+	/* M0+: 2 cycles (BL: 3, handled separately); M4: 1 + P. */
+	return model == MODEL_M0 ? 2 : 3;
+}
+
+static unsigned
+load_cost(int *prev_ldst)
+{
+	unsigned c;
+
+	if (model == MODEL_M0) {
+		c = 2;
+	} else {
+		c = *prev_ldst ? 1 : 2;
+	}
+	*prev_ldst = 1;
+	return c;
+}
+
+static unsigned
+store_cost(int *prev_ldst)
+{
+	*prev_ldst = 1;
+	return 2;
+}
+
+static unsigned
+cost_thumb16(unsigned hw, unsigned *taken_extra, int *prev_ldst)
+{
+	unsigned n;
+
+	/* LDR (literal) */
+	if ((hw & 0xF800) == 0x4800) {
+		return load_cost(prev_ldst);
+	}
+
+	/* Load/store, register offset: STR, STRH, STRB = 000..010 */
+	if ((hw & 0xF000) == 0x5000) {
+		if (((hw >> 9) & 7) <= 2) {
+			return store_cost(prev_ldst);
+		}
+		return load_cost(prev_ldst);
+	}
+
+	/* Load/store, immediate offset (word, byte, halfword, SP) */
+	if ((hw & 0xE000) == 0x6000 || (hw & 0xE000) == 0x8000) {
+		if ((hw & 0x0800) == 0) {
+			return store_cost(prev_ldst);
+		}
+		return load_cost(prev_ldst);
+	}
+
+	*prev_ldst = 0;
+
+	/* MULS */
+	if ((hw & 0xFFC0) == 0x4340) {
+		return 1;
+	}
+
+	/* BX, BLX (register) */
+	if ((hw & 0xFF00) == 0x4700) {
+		return branch_cost();
+	}
+
+	/* MOV PC, Rm / ADD PC, Rm */
+	if ((hw & 0xFC87) == 0x4487 && (hw & 0x0300) != 0x0100) {
+		return branch_cost();
+	}
+
+	/* PUSH */
+	if ((hw & 0xFE00) == 0xB400) {
+		return 1 + popcount16(hw & 0x1FF);
+	}
+
+	/* POP (with PC: pipeline refill) */
+	if ((hw & 0xFE00) == 0xBC00) {
+		n = popcount16(hw & 0xFF);
+		if (hw & 0x0100) {
+			return 3 + n;
+		}
+		return 1 + n;
+	}
+
+	/* CBZ, CBNZ (M4 only) */
+	if ((hw & 0xF500) == 0xB100) {
+		*taken_extra = branch_cost() - 1;
+		return 1;
+	}
+
+	/* LDM, STM */
+	if ((hw & 0xF000) == 0xC000) {
+		return 1 + popcount16(hw & 0xFF);
+	}
+
+	/* B<cond> (0xDE is UDF, 0xDF is SVC) */
+	if ((hw & 0xF000) == 0xD000 && (hw & 0x0E00) != 0x0E00) {
+		*taken_extra = branch_cost() - 1;
+		return 1;
+	}
+
+	/* B */
+	if ((hw & 0xF800) == 0xE000) {
+		return branch_cost();
+	}
+
+	return 1;
+}
+
+static unsigned
+cost_thumb32(unsigned hw1, unsigned hw2,
+	unsigned *taken_extra, int *prev_ldst)
+{
+	/* Branches and miscellaneous control */
+	if ((hw1 & 0xF800) == 0xF000 && (hw2 & 0x8000) != 0) {
+		*prev_ldst = 0;
+		switch (hw2 & 0x5000) {
+		case 0x5000:
+		case 0x4000:
+			/* BL, BLX (M0+: 3; M4: 1 + P) */
+			return 3;
+		case 0x1000:
+			/* B.W */
+			return branch_cost();
+		default:
+			/* B<cond>.W, or MSR/MRS/barriers (cond = 111x) */
+			if ((hw1 & 0x0380) == 0x0380) {
+				return model == MODEL_M0 ? 3 : 1;
+			}
+			*taken_extra = branch_cost() - 1;
+			return 1;
+		}
+	}
+
+	/* LDM/STM (IA, DB) */
+	if ((hw1 & 0xFF80) == 0xE880 || (hw1 & 0xFF80) == 0xE900) {
+		*prev_ldst = 0;
+		if ((hw1 & 0x0010) != 0 && (hw2 & 0x8000) != 0) {
+			/* load into PC */
+			return 2 + popcount16(hw2);
+		}
+		return 1 + popcount16(hw2);
+	}
+
+	/* LDRD/STRD (P = W = 0 is LDREX/STREX/TBB) */
+	if ((hw1 & 0xFE40) == 0xE840 && (hw1 & 0x0120) != 0) {
+		*prev_ldst = 0;
+		return 3;
+	}
+
+	/* Single load/store */
+	if ((hw1 & 0xFE00) == 0xF800) {
+		if ((hw1 & 0x0010) == 0) {
+			return store_cost(prev_ldst);
+		}
+		return load_cost(prev_ldst);
+	}
+
+	*prev_ldst = 0;
+
+	/* Long multiplies and divisions */
+	if ((hw1 & 0xFF80) == 0xFB80) {
+		if ((hw1 & 0x0070) == 0x0010 || (hw1 & 0x0070) == 0x0030) {
+			if ((hw2 & 0x00F0) == 0x00F0) {
+				/* SDIV, UDIV */
+				return 7;
+			}
+		}
+		return 1;
+	}
+
+	return 1;
+}
+
+static unsigned
+insn_cost(const uint8_t *d, size_t len,
+	unsigned *taken_extra, int *prev_ldst)
+{
+	unsigned hw1, hw2;
+
+	*taken_extra = 0;
+	hw1 = (unsigned)d[0] | ((unsigned)d[1] << 8);
+	if (len == 2) {
+		return cost_thumb16(hw1, taken_extra, prev_ldst);
+	}
+	if (len == 4 && (hw1 >> 11) >= 0x1D) {
+		hw2 = (unsigned)d[2] | ((unsigned)d[3] << 8);
+		return cost_thumb32(hw1, hw2, taken_extra, prev_ldst);
+	}
+
+	/* ARM-mode instruction. */
+	*prev_ldst = 0;
+	return 1;
+}
+
+/* ====================================================================== */
+/*
+ * Translation blocks. For each block, instructions are grouped into
+ * runs of consecutive instructions from the same function; executing
+ * the block adds the precomputed totals of each run to the function
+ * counters.
+ */
+
+typedef struct {
+	func_stats *f;
+	uint32_t insns;
+	uint32_t cycles;
+} tb_run;
+
+typedef struct {
+	uint64_t start;
+	uint64_t fallthrough;
+	func_stats *last_f;
+	uint32_t taken_extra;
+	uint32_t num_runs;
+	tb_run runs[];
+} tb_info;
+
+/*
+ * Last executed block, per virtual CPU (for conditional branches).
+ */
+#define MAX_VCPUS   1024
+static tb_info *last_tb[MAX_VCPUS];
+
+static void
+tb_exec(unsigned int vcpu_index, void *udata)
+{
+	tb_info *tb;
+	uint32_t u;
+
+	tb = udata;
+	if (vcpu_index < MAX_VCPUS) {
+		tb_info *prev;
+
+		prev = last_tb[vcpu_index];
+		if (prev != NULL && prev->taken_extra != 0
+			&& tb->start != prev->fallthrough)
+		{
+			__atomic_add_fetch(&prev->last_f->cycles,
+				prev->taken_extra, __ATOMIC_RELAXED);
+		}
+		last_tb[vcpu_index] = tb;
+	}
+	for (u = 0; u < tb->num_runs; u ++) {
+		__atomic_add_fetch(&tb->runs[u].f->insns,
+			tb->runs[u].insns, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&tb->runs[u].f->cycles,
+			tb->runs[u].cycles, __ATOMIC_RELAXED);
+	}
+}
+
+static void
+tb_trans(qemu_plugin_id_t id, struct qemu_plugin_tb *tb)
+{
+	tb_info *info;
+	size_t n, i;
+	int prev_ldst;
+	unsigned taken_extra;
+
+	(void)id;
+	n = qemu_plugin_tb_n_insns(tb);
+	if (n == 0) {
+		return;
+	}
+	info = calloc(1, sizeof *info + n * sizeof info->runs[0]);
+	if (info == NULL) {
+		abort();
+	}
+	info->start = qemu_plugin_tb_vaddr(tb);
+	prev_ldst = 0;
+	taken_extra = 0;
+	for (i = 0; i < n; i ++) {
+		struct qemu_plugin_insn *insn;
+		uint8_t d[4];
+		size_t len;
+		func_stats *f;
+		unsigned c;
+		tb_run *r;
+
+		insn = qemu_plugin_tb_get_insn(tb, i);
+		len = qemu_plugin_insn_size(insn);
+		memset(d, 0, sizeof d);
+#if QEMU_PLUGIN_VERSION >= 3
+		qemu_plugin_insn_data(insn, d, len < 4 ? len : 4);
+#else
+		memcpy(d, qemu_plugin_insn_data(insn), len < 4 ? len : 4);
+#endif
+		c = insn_cost(d, len, &taken_extra, &prev_ldst);
+		f = func_lookup(qemu_plugin_insn_symbol(insn));
+		if (info->num_runs == 0
+			|| info->runs[info->num_runs - 1].f != f)
+		{
+			info->runs[info->num_runs ++].f = f;
+		}
+		r = &info->runs[info->num_runs - 1];
+		r->insns ++;
+		r->cycles += c;
+		info->last_f = f;
+		info->fallthrough = qemu_plugin_insn_vaddr(insn) + len;
+	}
+
+	/* Only the last instruction of a block may be a branch. */
+	info->taken_extra = taken_extra;
+	qemu_plugin_register_vcpu_tb_exec_cb(tb, tb_exec,
+		QEMU_PLUGIN_CB_NO_REGS, info);
+}
+
+/* ====================================================================== */
+
+static int
+cmp_cycles(const void *a, const void *b)
+{
+	const func_stats *fa, *fb;
+
+	fa = *(const func_stats *const *)a;
+	fb = *(const func_stats *const *)b;
+	if (fa->cycles != fb->cycles) {
+		return fa->cycles < fb->cycles ? 1 : -1;
+	}
+	return strcmp(fa->name, fb->name);
+}
+
+static void
+plugin_exit(qemu_plugin_id_t id, void *p)
+{
+	func_stats **list;
+	uint64_t total_insns, total_cycles;
+	size_t u, v, num;
+	char line[256];
+
+	(void)id;
+	(void)p;
+	list = malloc((func_num + 1) * sizeof *list);
+	if (list == NULL) {
+		return;
+	}
+	total_insns = 0;
+	total_cycles = 0;
+	for (u = 0, v = 0; u < func_table_len; u ++) {
+		if (func_table[u] != NULL) {
+			list[v ++] = func_table[u];
+			total_insns += func_table[u]->insns;
+			total_cycles += func_table[u]->cycles;
+		}
+	}
+	num = v;
+	qsort(list, num, sizeof *list, cmp_cycles);
+	snprintf(line, sizeof line,
+		"# model: %s\n# %14s %14s %6s  %s\n",
+		model == MODEL_M0 ? "Cortex-M0+" : "Cortex-M4",
+		"cycles", "insns", "%", "function");
+	qemu_plugin_outs(line);
+	if (top != 0 && num > top) {
+		num = top;
+	}
+	for (u = 0; u < num; u ++) {
+		snprintf(line, sizeof line,
+			"  %14" PRIu64 " %14" PRIu64 " %6.2f  %s\n",
+			list[u]->cycles, list[u]->insns,
+			total_cycles == 0 ? 0.0
+			: 100.0 * (double)list[u]->cycles
+			/ (double)total_cycles,
+			list[u]->name);
+		qemu_plugin_outs(line);
+	}
+	snprintf(line, sizeof line,
+		"  %14" PRIu64 " %14" PRIu64 " %6.2f  (total)\n",
+		total_cycles, total_insns, 100.0);
+	qemu_plugin_outs(line);
+	free(list);
+}
+
+QEMU_PLUGIN_EXPORT int
+qemu_plugin_install(qemu_plugin_id_t id, const qemu_info_t *info,
+	int argc, char **argv)
+{
+	int i;
+
+	if (strcmp(info->target_name, "arm") != 0) {
+		fprintf(stderr, "cmcycles: unsupported target: %s\n",
+			info->target_name);
+		return -1;
+	}
+	for (i = 0; i < argc; i ++) {
+		if (strcmp(argv[i], "model=m0") == 0
+			|| strcmp(argv[i], "model=m0plus") == 0)
+		{
+			model = MODEL_M0;
+		} else if (strcmp(argv[i], "model=m4") == 0) {
+			model = MODEL_M4;
+		} else if (strncmp(argv[i], "top=", 4) == 0) {
+			top = (size_t)strtoul(argv[i] + 4, NULL, 10);
+		} else {
+			fprintf(stderr, "cmcycles: unknown argument: %s\n",
+				argv[i]);
+			return -1;
+		}
+	}
+	qemu_plugin_register_vcpu_tb_trans_cb(id, tb_trans);
+	qemu_plugin_register_atexit_cb(id, plugin_exit, NULL);
+	return 0;
+}
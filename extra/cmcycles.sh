@@ -0,0 +1,53 @@
+#! /bin/sh
+
+# Run an ARM Cortex-M test binary under qemu-arm with the cmcycles.c
+# plugin, and print the per-function instruction counts and cycle
+# estimates. The plugin is compiled on first use; QEMU_PLUGIN_INC must
+# then point to the directory that contains qemu-plugin.h.
+#
+# Usage: cmcycles.sh [-m m0|m4] [-n top] binary [args...]
+#
+# Environment:
+#   QEMU              emulator command (default: qemu-arm)
+#   QEMU_PLUGIN_INC   include directory for qemu-plugin.h
+#   CC                C compiler for the plugin (default: cc)
+#
+# The exit status is that of the emulated program.
+
+set -e
+
+model=m0
+top=40
+while getopts "m:n:" opt; do
+	case "$opt" in
+	m) model="$OPTARG" ;;
+	n) top="$OPTARG" ;;
+	*) echo "usage: $0 [-m m0|m4] [-n top] binary [args...]" >&2
+	   exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+if [ $# -eq 0 ]; then
+	echo "usage: $0 [-m m0|m4] [-n top] binary [args...]" >&2
+	exit 2
+fi
+
+dir=$(cd "$(dirname "$0")" && pwd)
+plugin="$dir/cmcycles.so"
+if [ ! -f "$plugin" ] || [ "$dir/cmcycles.c" -nt "$plugin" ]; then
+	if [ -z "$QEMU_PLUGIN_INC" ]; then
+		echo "$0: set QEMU_PLUGIN_INC to build the plugin" >&2
+		exit 2
+	fi
+	${CC:-cc} -O2 -shared -fPIC -I"$QEMU_PLUGIN_INC" \
+		$(pkg-config --cflags glib-2.0 2>/dev/null) \
+		-o "$plugin" "$dir/cmcycles.c"
+fi
+
+out=$(mktemp)
+trap 'rm -f "$out"' EXIT
+status=0
+${QEMU:-qemu-arm} -plugin "$plugin,model=$model,top=$top" \
+	-d plugin -D "$out" "$@" || status=$?
+cat "$out"
+exit $status
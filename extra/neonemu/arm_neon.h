@@ -0,0 +1,329 @@
+/*
+ * Portable C emulation of the NEON intrinsics used by src/ops_neon.c.
+ *
+ * This header is NOT a general <arm_neon.h> replacement: it covers only
+ * the unsigned 16-bit and 32-bit operations that ops_neon.c uses, with
+ * the AArch64 semantics (lane-wise, modular arithmetic). Putting this
+ * directory first in the include path compiles ops_neon.c with the host
+ * C compiler, so that the NEON code can be tested on machines without
+ * an AArch64 emulator (see the 'check-emu' target in Makefile.aarch64).
+ * It says nothing about performance.
+ */
+
+#ifndef CURVE9767_NEONEMU_ARM_NEON_H__
+#define CURVE9767_NEONEMU_ARM_NEON_H__
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+	uint16_t v[4];
+} uint16x4_t;
+
+typedef struct {
+	uint16_t v[8];
+} uint16x8_t;
+
+typedef struct {
+	uint32_t v[4];
+} uint32x4_t;
+
+static inline uint16x8_t
+vld1q_u16(const uint16_t *p)
+{
+	uint16x8_t r;
+
+	memcpy(r.v, p, sizeof r.v);
+	return r;
+}
+
+static inline void
+vst1q_u16(uint16_t *p, uint16x8_t x)
+{
+	memcpy(p, x.v, sizeof x.v);
+}
+
+static inline uint16x8_t
+vdupq_n_u16(uint16_t x)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i ++) {
+		r.v[i] = x;
+	}
+	return r;
+}
+
+static inline uint32x4_t
+vdupq_n_u32(uint32_t x)
+{
+	uint32x4_t r;
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		r.v[i] = x;
+	}
+	return r;
+}
+
+static inline uint16x8_t
+vsetq_lane_u16(uint16_t x, uint16x8_t a, int lane)
+{
+	a.v[lane] = x;
+	return a;
+}
+
+static inline uint32x4_t
+vsetq_lane_u32(uint32_t x, uint32x4_t a, int lane)
+{
+	a.v[lane] = x;
+	return a;
+}
+
+static inline uint16_t
+vgetq_lane_u16(uint16x8_t a, int lane)
+{
+	return a.v[lane];
+}
+
+static inline uint16x4_t
+vget_low_u16(uint16x8_t a)
+{
+	uint16x4_t r;
+
+	memcpy(r.v, a.v, sizeof r.v);
+	return r;
+}
+
+static inline uint16x8_t
+vcombine_u16(uint16x4_t a, uint16x4_t b)
+{
+	uint16x8_t r;
+
+	memcpy(r.v, a.v, sizeof a.v);
+	memcpy(r.v + 4, b.v, sizeof b.v);
+	return r;
+}
+
+static inline uint16x8_t
+vextq_u16(uint16x8_t a, uint16x8_t b, int n)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i ++) {
+		r.v[i] = (i + n < 8) ? a.v[i + n] : b.v[i + n - 8];
+	}
+	return r;
+}
+
+/*
+ * Lane-wise operations on 8x16 bits.
+ */
+#define NEONEMU_U16(name, expr) \
+	static inline uint16x8_t \
+	name(uint16x8_t a, uint16x8_t b) \
+	{ \
+		uint16x8_t r; \
+		int i; \
+		for (i = 0; i < 8; i ++) { \
+			r.v[i] = (uint16_t)(expr); \
+		} \
+		return r; \
+	}
+
+NEONEMU_U16(vaddq_u16, a.v[i] + b.v[i])
+NEONEMU_U16(vsubq_u16, a.v[i] - b.v[i])
+NEONEMU_U16(vandq_u16, a.v[i] & b.v[i])
+NEONEMU_U16(vorrq_u16, a.v[i] | b.v[i])
+NEONEMU_U16(vceqq_u16, a.v[i] == b.v[i] ? 0xFFFF : 0)
+NEONEMU_U16(vcgtq_u16, a.v[i] > b.v[i] ? 0xFFFF : 0)
+
+#undef NEONEMU_U16
+
+static inline uint16x8_t
+vmvnq_u16(uint16x8_t a)
+{
+	int i;
+
+	for (i = 0; i < 8; i ++) {
+		a.v[i] = (uint16_t)~a.v[i];
+	}
+	return a;
+}
+
+static inline uint16x8_t
+vbslq_u16(uint16x8_t m, uint16x8_t a, uint16x8_t b)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i ++) {
+		r.v[i] = (uint16_t)((m.v[i] & a.v[i]) | (~m.v[i] & b.v[i]));
+	}
+	return r;
+}
+
+static inline uint16x8_t
+vshlq_n_u16(uint16x8_t a, int n)
+{
+	int i;
+
+	for (i = 0; i < 8; i ++) {
+		a.v[i] = (uint16_t)(a.v[i] << n);
+	}
+	return a;
+}
+
+static inline uint16_t
+vminvq_u16(uint16x8_t a)
+{
+	uint16_t r;
+	int i;
+
+	r = a.v[0];
+	for (i = 1; i < 8; i ++) {
+		if (a.v[i] < r) {
+			r = a.v[i];
+		}
+	}
+	return r;
+}
+
+/*
+ * Lane-wise operations on 4x32 bits.
+ */
+static inline uint32x4_t
+vaddq_u32(uint32x4_t a, uint32x4_t b)
+{
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		a.v[i] += b.v[i];
+	}
+	return a;
+}
+
+static inline uint32x4_t
+vsubq_u32(uint32x4_t a, uint32x4_t b)
+{
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		a.v[i] -= b.v[i];
+	}
+	return a;
+}
+
+static inline uint32x4_t
+vminq_u32(uint32x4_t a, uint32x4_t b)
+{
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		if (b.v[i] < a.v[i]) {
+			a.v[i] = b.v[i];
+		}
+	}
+	return a;
+}
+
+static inline uint32x4_t
+vmulq_n_u32(uint32x4_t a, uint32_t b)
+{
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		a.v[i] *= b;
+	}
+	return a;
+}
+
+static inline uint32x4_t
+vshrq_n_u32(uint32x4_t a, int n)
+{
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		a.v[i] >>= n;
+	}
+	return a;
+}
+
+static inline uint16x4_t
+vmovn_u32(uint32x4_t a)
+{
+	uint16x4_t r;
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		r.v[i] = (uint16_t)a.v[i];
+	}
+	return r;
+}
+
+/*
+ * Widening multiplications (16x16->32), with or without accumulation.
+ * The "high" variants use lanes 4 to 7 of their 8-lane operands.
+ */
+static inline uint32x4_t
+neonemu_mlal(uint32x4_t d, const uint16_t *a, const uint16_t *b, int bstep)
+{
+	int i;
+
+	for (i = 0; i < 4; i ++) {
+		d.v[i] += (uint32_t)a[i] * (uint32_t)b[i * bstep];
+	}
+	return d;
+}
+
+static inline uint32x4_t
+vmull_u16(uint16x4_t a, uint16x4_t b)
+{
+	return neonemu_mlal(vdupq_n_u32(0), a.v, b.v, 1);
+}
+
+static inline uint32x4_t
+vmull_high_u16(uint16x8_t a, uint16x8_t b)
+{
+	return neonemu_mlal(vdupq_n_u32(0), a.v + 4, b.v + 4, 1);
+}
+
+static inline uint32x4_t
+vmull_n_u16(uint16x4_t a, uint16_t b)
+{
+	return neonemu_mlal(vdupq_n_u32(0), a.v, &b, 0);
+}
+
+static inline uint32x4_t
+vmull_high_n_u16(uint16x8_t a, uint16_t b)
+{
+	return neonemu_mlal(vdupq_n_u32(0), a.v + 4, &b, 0);
+}
+
+static inline uint32x4_t
+vmlal_n_u16(uint32x4_t d, uint16x4_t a, uint16_t b)
+{
+	return neonemu_mlal(d, a.v, &b, 0);
+}
+
+static inline uint32x4_t
+vmlal_high_n_u16(uint32x4_t d, uint16x8_t a, uint16_t b)
+{
+	return neonemu_mlal(d, a.v + 4, &b, 0);
+}
+
+static inline uint32x4_t
+vmlal_laneq_u16(uint32x4_t d, uint16x4_t a, uint16x8_t b, int lane)
+{
+	return neonemu_mlal(d, a.v, b.v + lane, 0);
+}
+
+static inline uint32x4_t
+vmlal_high_laneq_u16(uint32x4_t d, uint16x8_t a, uint16x8_t b, int lane)
+{
+	return neonemu_mlal(d, a.v + 4, b.v + lane, 0);
+}
+
+#endif
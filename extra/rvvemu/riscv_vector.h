@@ -0,0 +1,219 @@
+/*
+ * Portable C emulation of the RVV 1.0 intrinsics used by src/ops_rvv.c.
+ *
+ * This header is NOT a general <riscv_vector.h> replacement: it covers
+ * only the unsigned 16-bit (LMUL=4) and 32-bit (LMUL=8) operations that
+ * ops_rvv.c uses, with the semantics of the v1.0 intrinsics API
+ * (unmasked, tail-agnostic). Putting this directory first in the
+ * include path compiles ops_rvv.c with the host C compiler, so that the
+ * RVV code can be tested on machines without a RISC-V toolchain or
+ * emulator (see the 'check-emu' target in Makefile.rvv).
+ *
+ * The vector length is fixed at compile time with RVVEMU_VLEN (in bits,
+ * default 128). Tail elements (at index vl and beyond) of all results
+ * are set to all-ones, which the tail-agnostic policy allows, so that
+ * code that wrongly relies on them gets garbage. Loads and stores
+ * access exactly vl elements. It says nothing about performance.
+ */
+
+#ifndef CURVE9767_RVVEMU_RISCV_VECTOR_H__
+#define CURVE9767_RVVEMU_RISCV_VECTOR_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef RVVEMU_VLEN
+#define RVVEMU_VLEN   128
+#endif
+
+#if RVVEMU_VLEN < 128 || (RVVEMU_VLEN & (RVVEMU_VLEN - 1)) != 0
+#error RVVEMU_VLEN must be a power of two, at least 128 (V extension)
+#endif
+
+/*
+ * Number of elements in a group of registers, for SEW=16/LMUL=4 and
+ * SEW=32/LMUL=8 (both are VLEN/4), and in a mask with SEW/LMUL = 4.
+ */
+#define RVVEMU_VLMAX   (RVVEMU_VLEN / 4)
+
+typedef struct {
+	uint16_t v[RVVEMU_VLMAX];
+} vuint16m4_t;
+
+typedef struct {
+	uint32_t v[RVVEMU_VLMAX];
+} vuint32m8_t;
+
+typedef struct {
+	unsigned char v[RVVEMU_VLMAX];
+} vbool4_t;
+
+/*
+ * Check the vl argument of an intrinsic: values larger than VLMAX can
+ * only come from a misuse of vsetvl (or no vsetvl at all).
+ */
+static inline void
+rvvemu_check_vl(size_t vl)
+{
+	if (vl > RVVEMU_VLMAX) {
+		abort();
+	}
+}
+
+static inline size_t
+__riscv_vsetvl_e16m4(size_t avl)
+{
+	return avl < RVVEMU_VLMAX ? avl : RVVEMU_VLMAX;
+}
+
+static inline vuint16m4_t
+__riscv_vle16_v_u16m4(const uint16_t *p, size_t vl)
+{
+	vuint16m4_t r;
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < RVVEMU_VLMAX; i ++) {
+		r.v[i] = i < vl ? p[i] : 0xFFFF;
+	}
+	return r;
+}
+
+static inline void
+__riscv_vse16_v_u16m4(uint16_t *p, vuint16m4_t x, size_t vl)
+{
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < vl; i ++) {
+		p[i] = x.v[i];
+	}
+}
+
+/*
+ * Lane-wise operations on 16-bit elements; 'b' is either a vector
+ * (_vv variants) or a scalar (_vx variants).
+ */
+#define RVVEMU_U16(name, btype, bval, expr) \
+	static inline vuint16m4_t \
+	name(vuint16m4_t a, btype b, size_t vl) \
+	{ \
+		vuint16m4_t r; \
+		size_t i; \
+		rvvemu_check_vl(vl); \
+		for (i = 0; i < RVVEMU_VLMAX; i ++) { \
+			uint16_t x = a.v[i], y = (bval); \
+			r.v[i] = i < vl ? (uint16_t)(expr) : 0xFFFF; \
+		} \
+		return r; \
+	}
+
+RVVEMU_U16(__riscv_vadd_vv_u16m4, vuint16m4_t, b.v[i], x + y)
+RVVEMU_U16(__riscv_vsub_vv_u16m4, vuint16m4_t, b.v[i], x - y)
+RVVEMU_U16(__riscv_vxor_vv_u16m4, vuint16m4_t, b.v[i], x ^ y)
+RVVEMU_U16(__riscv_vadd_vx_u16m4, uint16_t, b, x + y)
+RVVEMU_U16(__riscv_vsub_vx_u16m4, uint16_t, b, x - y)
+RVVEMU_U16(__riscv_vrsub_vx_u16m4, uint16_t, b, y - x)
+RVVEMU_U16(__riscv_vand_vx_u16m4, uint16_t, b, x & y)
+RVVEMU_U16(__riscv_vsll_vx_u16m4, size_t, (uint16_t)(b & 15), x << y)
+
+#undef RVVEMU_U16
+
+static inline vbool4_t
+__riscv_vmsgtu_vx_u16m4_b4(vuint16m4_t a, uint16_t b, size_t vl)
+{
+	vbool4_t r;
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < RVVEMU_VLMAX; i ++) {
+		r.v[i] = i < vl ? (a.v[i] > b) : 1;
+	}
+	return r;
+}
+
+static inline vuint16m4_t
+__riscv_vmerge_vvm_u16m4(vuint16m4_t a, vuint16m4_t b, vbool4_t m,
+	size_t vl)
+{
+	vuint16m4_t r;
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < RVVEMU_VLMAX; i ++) {
+		r.v[i] = i < vl ? (m.v[i] ? b.v[i] : a.v[i]) : 0xFFFF;
+	}
+	return r;
+}
+
+/*
+ * Operations on 32-bit elements (widened accumulators).
+ */
+static inline vuint32m8_t
+__riscv_vmv_v_x_u32m8(uint32_t x, size_t vl)
+{
+	vuint32m8_t r;
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < RVVEMU_VLMAX; i ++) {
+		r.v[i] = i < vl ? x : 0xFFFFFFFF;
+	}
+	return r;
+}
+
+#define RVVEMU_U32(name, btype, expr) \
+	static inline vuint32m8_t \
+	name(vuint32m8_t a, btype b, size_t vl) \
+	{ \
+		vuint32m8_t r; \
+		size_t i; \
+		rvvemu_check_vl(vl); \
+		for (i = 0; i < RVVEMU_VLMAX; i ++) { \
+			uint32_t x = a.v[i]; \
+			r.v[i] = i < vl ? (uint32_t)(expr) : 0xFFFFFFFF; \
+		} \
+		return r; \
+	}
+
+RVVEMU_U32(__riscv_vadd_vx_u32m8, uint32_t, x + b)
+RVVEMU_U32(__riscv_vmul_vx_u32m8, uint32_t, x * b)
+RVVEMU_U32(__riscv_vsrl_vx_u32m8, size_t, x >> (b & 31))
+
+#undef RVVEMU_U32
+
+/*
+ * Widening multiply-accumulate: d += (uint32_t)a * (uint32_t)b[i].
+ */
+static inline vuint32m8_t
+__riscv_vwmaccu_vx_u32m8(vuint32m8_t d, uint16_t a, vuint16m4_t b,
+	size_t vl)
+{
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < RVVEMU_VLMAX; i ++) {
+		d.v[i] = i < vl
+			? d.v[i] + (uint32_t)a * (uint32_t)b.v[i] : 0xFFFFFFFF;
+	}
+	return d;
+}
+
+/*
+ * Narrowing shift: keep the low 16 bits of (a[i] >> b).
+ */
+static inline vuint16m4_t
+__riscv_vnsrl_wx_u16m4(vuint32m8_t a, size_t b, size_t vl)
+{
+	vuint16m4_t r;
+	size_t i;
+
+	rvvemu_check_vl(vl);
+	for (i = 0; i < RVVEMU_VLMAX; i ++) {
+		r.v[i] = i < vl ? (uint16_t)(a.v[i] >> (b & 31)) : 0xFFFF;
+	}
+	return r;
+}
+
+#endif
@@ -69,6 +69,113 @@ curve9767_point_decode(curve9767_point *Q, const void *src)
 	return r;
 }
 
+/* see curve9767.h */
+int
+curve9767_point_encode_full(void *dst, const curve9767_point *Q)
+{
+	int i;
+	uint8_t *buf;
+	uint8_t m;
+
+	buf = dst;
+	curve9767_inner_gf_encode(buf, Q->x);
+	curve9767_inner_gf_encode(buf + 32, Q->y);
+	m = (uint8_t)-Q->neutral;
+	for (i = 0; i < 31; i ++) {
+		buf[i] |= m;
+		buf[32 + i] |= m;
+	}
+	buf[31] |= m & 0x3F;
+	buf[63] |= m & 0x3F;
+	return 1 - Q->neutral;
+}
+
+/* see curve9767.h */
+int
+curve9767_point_decode_full(curve9767_point *Q, const void *src)
+{
+	const uint8_t *buf;
+	uint32_t r;
+
+	/*
+	 * Check that the top two bits of both coordinates are 0.
+	 */
+	buf = src;
+	r = (((uint32_t)(buf[31] | buf[63]) >> 6) - 1) >> 31;
+
+	/*
+	 * Decode both coordinates.
+	 */
+	r &= curve9767_inner_gf_decode(Q->x, buf);
+	r &= curve9767_inner_gf_decode(Q->y, buf + 32);
+
+	/*
+	 * Verify the curve equation; no square root is needed.
+	 */
+	r &= curve9767_inner_check_y(Q->x, Q->y);
+
+	/*
+	 * If one of the step failed, then the value is turned into the
+	 * point-at-infinity.
+	 */
+	Q->neutral = 1 - r;
+	return r;
+}
+
+/* see inner.h */
+int
+curve9767_inner_scalar_recode_short(uint8_t *sb,
+	const curve9767_scalar *s, unsigned bitlen, int w)
+{
+	uint8_t off[32];
+	unsigned cc;
+	int i, j, num;
+
+	if (bitlen > 252) {
+		bitlen = 252;
+	}
+	num = ((int)bitlen + w + 1) / w;
+	if (num < 2) {
+		num = 2;
+	}
+
+	/*
+	 * Encode the scalar and clear the bits beyond bitlen (which are
+	 * zero anyway, if the caller honoured the bound).
+	 */
+	curve9767_scalar_encode(sb, s);
+	for (j = 0; j < 32; j ++) {
+		int k;
+
+		k = (int)bitlen - (j << 3);
+		if (k <= 0) {
+			sb[j] = 0;
+		} else if (k < 8) {
+			sb[j] &= (uint8_t)((1 << k) - 1);
+		}
+	}
+
+	/*
+	 * Add the offset (top bit of each chunk).
+	 */
+	memset(off, 0, sizeof off);
+	for (i = 0; i < num; i ++) {
+		int p;
+
+		p = w * i + w - 1;
+		off[p >> 3] |= (uint8_t)(1 << (p & 7));
+	}
+	cc = 0;
+	for (j = 0; j < 32; j ++) {
+		unsigned z;
+
+		z = (unsigned)sb[j] + (unsigned)off[j] + cc;
+		sb[j] = (uint8_t)z;
+		cc = z >> 8;
+	}
+	return num;
+}
+
 /* see curve9767.h */
 void
 curve9767_point_neg(curve9767_point *Q2, const curve9767_point *Q1)
@@ -90,3 +197,47 @@ curve9767_point_sub(curve9767_point *Q3,
 	curve9767_point_neg(&T, Q2);
 	curve9767_point_add(Q3, Q1, &T);
 }
+
+/* ====================================================================== */
+
+#if CURVE9767_STATS
+CURVE9767_TLS uint64_t curve9767_inner_stats[CURVE9767_STAT_NUM];
+#endif
+
+/* see curve9767.h */
+int
+curve9767_stats_get(curve9767_stats *st)
+{
+#if CURVE9767_STATS
+	const uint64_t *c;
+
+	c = curve9767_inner_stats;
+	st->gf_add = c[CURVE9767_STAT_gf_add];
+	st->gf_sub = c[CURVE9767_STAT_gf_sub];
+	st->gf_neg = c[CURVE9767_STAT_gf_neg];
+	st->gf_mul = c[CURVE9767_STAT_gf_mul];
+	st->gf_sqr = c[CURVE9767_STAT_gf_sqr];
+	st->gf_mul_const = c[CURVE9767_STAT_gf_mul_const];
+	st->gf_frob = c[CURVE9767_STAT_gf_frob];
+	st->gf_inv = c[CURVE9767_STAT_gf_inv];
+	st->gf_sqrt = c[CURVE9767_STAT_gf_sqrt];
+	st->gf_cubert = c[CURVE9767_STAT_gf_cubert];
+	st->scalar_add = c[CURVE9767_STAT_scalar_add];
+	st->scalar_mul = c[CURVE9767_STAT_scalar_mul];
+	st->scalar_reduce = c[CURVE9767_STAT_scalar_reduce];
+	st->scalar_reduce_basis = c[CURVE9767_STAT_scalar_reduce_basis];
+	return 1;
+#else
+	memset(st, 0, sizeof *st);
+	return 0;
+#endif
+}
+
+/* see curve9767.h */
+void
+curve9767_stats_reset(void)
+{
+#if CURVE9767_STATS
+	memset(curve9767_inner_stats, 0, sizeof curve9767_inner_stats);
+#endif
+}
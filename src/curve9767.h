@@ -5,6 +5,10 @@
 #include <stdint.h>
 #include <string.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* ===================================================================== */
 /*
  * High-level operations use SHAKE; normally, we use SHAKE256 (since the
@@ -211,6 +215,36 @@ int curve9767_point_encode_X(void *dst, const curve9767_point *Q);
  */
 int curve9767_point_decode(curve9767_point *Q, const void *src);
 
+/*
+ * Encode a curve point into a sequence of 64 bytes, with the full X and
+ * Y coordinates (in that order, 32 bytes each, with the format used by
+ * curve9767_point_encode_X()). This "uncompressed" format is twice
+ * larger than the format of curve9767_point_encode(), but it can be
+ * decoded several times faster (about 5x on x86), since no square root
+ * is involved. If the source point is the point-at-infinity, then both
+ * halves are filled with 0xFF bytes (except the 32nd and the 64th, set
+ * to 0x3F), and the function returns 0; that output is invalid and will
+ * be rejected by curve9767_point_decode_full(). Otherwise, the function
+ * returns 1.
+ *
+ * This function is constant-time, including if the point is the
+ * point-at-infinity.
+ */
+int curve9767_point_encode_full(void *dst, const curve9767_point *Q);
+
+/*
+ * Decode a curve point from its 64-byte uncompressed format (see
+ * curve9767_point_encode_full()). Returned value is 1 on success, 0
+ * on error. An error is reported if either coordinate is not in the
+ * canonical encoding, or if the coordinates do not fulfill the curve
+ * equation. If an error is returned, then the destination structure
+ * contents are set to the point-at-infinity. Successful decoding
+ * cannot yield the point-at-infinity.
+ *
+ * This is constant-time, even if the source value is incorrect.
+ */
+int curve9767_point_decode_full(curve9767_point *Q, const void *src);
+
 /*
  * Point negation: set Q2 to -Q1. This is constant-time and works for
  * all points, including the point-at-infinity. Destination point Q2
@@ -263,6 +297,20 @@ void curve9767_point_mul2k(curve9767_point *Q3,
 void curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	const curve9767_scalar *s);
 
+/*
+ * Point multiplication by a short scalar: this is equivalent to
+ * curve9767_point_mul(), for a scalar s which is known to be lower
+ * than 2^bitlen. The number of point doublings and additions is
+ * proportional to bitlen, e.g. multiplication by a 128-bit scalar is
+ * about twice faster than with curve9767_point_mul(). This is
+ * constant-time with regard to Q1 and s, but not to bitlen, which is
+ * assumed to be public. If s is not lower than 2^bitlen, then the
+ * result is unspecified. If bitlen is 252 or more, then this function
+ * is equivalent to curve9767_point_mul().
+ */
+void curve9767_point_mul_short(curve9767_point *Q3,
+	const curve9767_point *Q1, const curve9767_scalar *s, unsigned bitlen);
+
 /*
  * Generator multiplication: this is a special case of point
  * multiplication, in which the point to multiply is the conventional
@@ -286,6 +334,19 @@ void curve9767_point_mul_mulgen_add(curve9767_point *Q3,
 	const curve9767_point *Q1, const curve9767_scalar *s1,
 	const curve9767_scalar *s2);
 
+/*
+ * Double point multiplication: this sets Q3 to s1*P1+s2*P2, for two
+ * arbitrary points P1 and P2 (e.g. for Pedersen commitments). Point
+ * doublings are shared between the two multiplications, which makes
+ * this substantially faster than two calls to curve9767_point_mul().
+ * This is constant-time with regard to P1, P2, s1 and s2. Either or
+ * both points may be the point-at-infinity. Destination point Q3 may
+ * be the same structure as P1 and/or P2.
+ */
+void curve9767_point_mul2_add(curve9767_point *Q3,
+	const curve9767_point *P1, const curve9767_scalar *s1,
+	const curve9767_point *P2, const curve9767_scalar *s2);
+
 /*
  * Combined point verification: this functions verifies that:
  *   s1*Q1+s2*G = Q2
@@ -306,6 +367,27 @@ int curve9767_point_verify_mul_mulgen_add_vartime(
 	const curve9767_point *Q1, const curve9767_scalar *s1,
 	const curve9767_scalar *s2, const curve9767_point *Q2);
 
+/*
+ * Multi-scalar multiplication: compute
+ *   Q3 = s_0*P_0 + s_1*P_1 + ... + s_{num-1}*P_{num-1}
+ * with the num points P_i in pts[] and the num scalars s_i in s[]. The
+ * number of points may be zero (Q3 is then the point-at-infinity).
+ *
+ * For large inputs, Pippenger's bucket method is used, and the work is
+ * split between num_threads threads (the calling thread being one of
+ * them; 0 is treated as 1). Each thread uses its own buckets, for a
+ * total memory usage of about num_threads*2^(c-1)*84 bytes (where c is
+ * the window size, about log2(num)-3, at most 16), plus 4*num*(252/c+1)
+ * bytes for the recoded scalars. This memory is obtained with malloc();
+ * if allocation fails, a slower single-threaded method without dynamic
+ * allocation is used.
+ *
+ * THIS FUNCTION IS NOT CONSTANT-TIME.
+ */
+void curve9767_point_mulN_vartime(curve9767_point *Q3,
+	const curve9767_point *pts, const curve9767_scalar *s, size_t num,
+	unsigned num_threads);
+
 /* ===================================================================== */
 /*
  * High-level operations.
@@ -327,6 +409,27 @@ int curve9767_point_verify_mul_mulgen_add_vartime(
  */
 void curve9767_hash_to_curve(curve9767_point *Q, shake_context *sc);
 
+/*
+ * Encode-to-curve. This is a cheaper variant of hash-to-curve, which
+ * extracts only 48 bytes from the SHAKE context, and applies Icart's
+ * map only once (no point addition). It is about twice faster than
+ * curve9767_hash_to_curve(). The output is deterministic, but it is
+ * NOT uniformly distributed over the curve (Icart's map reaches only
+ * about 5/8 of the points, some of them more often than others); it
+ * must not be used where a random-looking point is needed, but it is
+ * appropriate e.g. for deriving a commitment base from a label.
+ *
+ * Since the outputs of curve9767_hash_to_curve() and
+ * curve9767_encode_to_curve() over the same SHAKE output are related
+ * (the former is the latter plus another point), the caller MUST use
+ * a domain separation string that is distinct from all those used with
+ * curve9767_hash_to_curve().
+ *
+ * The point-at-infinity is obtained if the extracted seed maps to zero
+ * (probability about 2^(-251.82)).
+ */
+void curve9767_encode_to_curve(curve9767_point *Q, shake_context *sc);
+
 /*
  * Generate a key pair from a seed. A private key consists of:
  *  - a secret scalar s
@@ -429,6 +532,17 @@ void curve9767_ecdh_keygen(curve9767_scalar *s, uint8_t encoded_Q[32],
 int curve9767_ecdh_recv(void *shared_secret, size_t shared_secret_len,
 	const curve9767_scalar *s, const uint8_t encoded_Q2[32]);
 
+/*
+ * Same as curve9767_ecdh_recv(), except that the peer point Q2 is
+ * received in the 64-byte uncompressed format (see
+ * curve9767_point_encode_full()), which is faster to decode. The
+ * shared secret is the same as with curve9767_ecdh_recv() for the same
+ * point; on failure, the alternate pre-master secret is computed over
+ * the 64 received bytes.
+ */
+int curve9767_ecdh_recv_full(void *shared_secret, size_t shared_secret_len,
+	const curve9767_scalar *s, const uint8_t encoded_Q2[64]);
+
 /*
  * Signatures:
  *
@@ -581,6 +695,15 @@ int curve9767_ecdh_recv(void *shared_secret, size_t shared_secret_len,
 /* Hash function identifier: SHA3-512 */
 #define CURVE9767_OID_SHA3_512      "2.16.840.1.101.3.4.2.10"
 
+/*
+ * Hash function identifier: ParallelHash256 (NIST SP 800-185) with
+ * block size B = 8192 bytes, an empty customization string, and a
+ * 512-bit output. No OID is assigned to ParallelHash, hence this
+ * identifier spells out the parameters. Large inputs can be hashed on
+ * several cores with parallelhash_update_mt() (see sha3.h).
+ */
+#define CURVE9767_OID_PARALLELHASH256   "ParallelHash256-B8192-L512"
+
 /*
  * Signature generation. Secret scalar s, additional secret t, and
  * public key Q = s*G are provided, as well as the hashed message
@@ -620,4 +743,694 @@ int curve9767_sign_verify_vartime(const void *sig,
 	const curve9767_point *Q,
 	const char *hash_oid, const void *hv, size_t hv_len);
 
+/*
+ * Signatures with an uncompressed commitment point.
+ *
+ * A "full" signature has length 96 bytes: the point C encoded with
+ * curve9767_point_encode_full() (64 bytes), followed by the scalar d
+ * (32 bytes). The challenge e is still computed over the compressed
+ * encoding c of C, so that a full signature and the corresponding
+ * 64-byte signature (c, d) are interchangeable: the latter is obtained
+ * by recompressing C. Verification of a full signature skips the
+ * square root otherwise needed to decode C. Public keys can likewise
+ * be transmitted with curve9767_point_encode_full() and decoded with
+ * curve9767_point_decode_full().
+ */
+
+/*
+ * Signature generation, full format. This is identical to
+ * curve9767_sign_generate(), except that the output has length exactly
+ * 96 bytes.
+ */
+void curve9767_sign_generate_full(void *sig,
+	const curve9767_scalar *s, const uint8_t t[32],
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/*
+ * Signature verification, full format (96 bytes). Returned value is 1
+ * if the signature is correct, 0 otherwise. Like
+ * curve9767_sign_verify_vartime(), THIS FUNCTION IS NOT CONSTANT-TIME.
+ */
+int curve9767_sign_verify_full_vartime(const void *sig,
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/*
+ * Expanded signing key.
+ *
+ * curve9767_sign_generate() must encode the public key Q (for the
+ * challenge e) and inject the domain separation string and the
+ * additional secret t (for the deterministic k) on each call. An
+ * expanded signing key holds the secret scalar s, the encoded public
+ * key Q, and a SHAKE256 context in which the prefix
+ * "curve9767-sign-k:" || t is already injected. It is built once, then
+ * used for any number of signatures with curve9767_sign_generate_key(),
+ * which yields exactly the same signatures as curve9767_sign_generate().
+ *
+ * The decoded public key (curve9767_point) is deliberately not kept:
+ * signature generation uses Q only through its encoding, in the hash
+ * that computes the challenge e, so storing the point in the backend's
+ * internal format would only enlarge the structure. Callers that also
+ * verify signatures keep their own curve9767_point.
+ *
+ * The structure contains secret values; it should be cleared by the
+ * caller when no longer needed. It is not modified by signature
+ * generation, and thus may be shared by several threads.
+ */
+typedef struct {
+	curve9767_scalar s;
+	uint8_t eQ[32];
+	shake_context kc;
+} curve9767_sign_key;
+
+/*
+ * Build an expanded signing key from the secret scalar s, the
+ * additional secret t, and the public key Q = s*G.
+ */
+void curve9767_sign_key_init(curve9767_sign_key *sk,
+	const curve9767_scalar *s, const uint8_t t[32],
+	const curve9767_point *Q);
+
+/*
+ * Build an expanded signing key from a seed (see curve9767_keygen()).
+ * This computes Q = s*G.
+ */
+void curve9767_sign_key_from_seed(curve9767_sign_key *sk,
+	const void *seed, size_t seed_len);
+
+/*
+ * Signature generation with an expanded signing key. The hashed message
+ * hv has size hv_len bytes. Signature is written in sig[] and has
+ * length exactly 64 bytes.
+ */
+void curve9767_sign_generate_key(void *sig, const curve9767_sign_key *sk,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/*
+ * Signature half-aggregation.
+ *
+ * A list of n signatures (c_i, d_i) (for 0 <= i < n), each with its
+ * public key Q_i and hashed message hv_i, can be compressed into a
+ * single aggregate signature of 32*n+32 bytes: the concatenation of
+ * all c_i values (32 bytes each), followed by a single scalar d
+ * (32 bytes). Aggregation is a public operation which does not require
+ * knowledge of any private key. The process is the following:
+ *
+ *  1. For each i, recompute the challenge e_i (as in step 2 of the
+ *     signature verification).
+ *
+ *  2. Compute SHAKE256 over the concatenation of:
+ *        - the domain separation string "curve9767-sign-agg:"
+ *        - the number of signatures n (8 bytes, unsigned little-endian)
+ *        - for each i in order, c_i (32 bytes) and e_i (32 bytes)
+ *     Then extract n chunks of 16 bytes from the SHAKE output; chunk i
+ *     is interpreted as an integer z_i (unsigned little-endian).
+ *
+ *  3. Compute d = \sum z_i*d_i mod n.
+ *
+ * To verify an aggregate signature, the verifier decodes each c_i into
+ * a point C_i, recomputes the e_i and z_i values, and checks that:
+ *   d*G = \sum z_i*C_i + \sum (z_i*e_i)*Q_i
+ * For 32 signatures or more, this uses a single multi-scalar
+ * multiplication (with curve9767_point_mulN_vartime()) over the 2*n+1
+ * points; for fewer signatures, the points are processed in groups of
+ * 8 signatures, and the term in G uses precomputed tables. In both
+ * cases, this is substantially faster than verifying all signatures
+ * individually. If any of the aggregated signatures is invalid, then
+ * the aggregate signature is invalid (except with negligible
+ * probability).
+ *
+ * Verification allocates about 276*n bytes with malloc() (36*n bytes
+ * for fewer than 32 signatures). If allocation fails, the groups of 8
+ * signatures are used, and the e_i are computed twice.
+ *
+ * The aggregate signature binds each c_i to its position in the list;
+ * the verifier MUST provide the public keys and messages in the same
+ * order as was used for aggregation.
+ */
+
+/*
+ * A signed message, as used in aggregate signatures: public key Q, hash
+ * function identifier and hashed message hv (of size hv_len bytes).
+ */
+typedef struct {
+	const curve9767_point *Q;
+	const char *hash_oid;
+	const void *hv;
+	size_t hv_len;
+} curve9767_sign_msg;
+
+/*
+ * Aggregate num signatures. Source signatures are provided in sigs[]
+ * (64 bytes each, concatenated), with the corresponding public keys
+ * and hashed messages in msg[]. The aggregate signature is written in
+ * agg[], with length exactly 32*num+32 bytes. The agg[] buffer MUST
+ * NOT overlap with sigs[].
+ *
+ * Individual signatures are not verified by this function. Returned
+ * value is 1 on success, 0 on error (num is zero, or one of the source
+ * signatures is not properly encoded). On error, the contents of agg[]
+ * are unspecified.
+ */
+int curve9767_sign_aggregate(void *agg, const void *sigs,
+	const curve9767_sign_msg *msg, size_t num);
+
+/*
+ * Verify an aggregate signature (of length 32*num+32 bytes) over the
+ * num signed messages provided in msg[]. Returned value is 1 if the
+ * aggregate signature is correct, 0 otherwise. An aggregate over zero
+ * signatures is always reported as incorrect.
+ *
+ * THIS FUNCTION IS NOT CONSTANT-TIME (see
+ * curve9767_sign_verify_vartime()).
+ */
+int curve9767_sign_verify_aggregate_vartime(const void *agg,
+	const curve9767_sign_msg *msg, size_t num);
+
+/*
+ * Batch verification of num individual signatures (64 bytes each,
+ * concatenated in sigs[]) over the signed messages provided in msg[].
+ * Returned value is 1 if all signatures are correct, 0 otherwise (this
+ * function does not tell which signatures are incorrect; if needed,
+ * the caller may then verify them one by one). A batch of zero
+ * signatures is always reported as incorrect.
+ *
+ * This uses the same equation as aggregate signature verification,
+ * except that the z_i are computed with the domain separation string
+ * "curve9767-sign-batch:" and over the complete signatures (c_i and
+ * d_i, 64 bytes) instead of only the c_i. A batch of n signatures is
+ * substantially faster to verify than n individual signatures.
+ *
+ * THIS FUNCTION IS NOT CONSTANT-TIME (see
+ * curve9767_sign_verify_vartime()).
+ */
+int curve9767_sign_verify_batch_vartime(const void *sigs,
+	const curve9767_sign_msg *msg, size_t num);
+
+/*
+ * Offline/online signatures.
+ *
+ * In the normal signature generation process, most of the cost is in
+ * the computation of the point C = k*G, which does not depend on the
+ * message. With randomized nonces, this computation can be done
+ * beforehand (e.g. while the system is otherwise idle): a "nonce" holds
+ * a secret scalar k and the encoding of the point C = k*G. Signing with
+ * a prepared nonce then only requires computing the challenge e and the
+ * scalar d = k + e*s.
+ *
+ * A nonce is generated from a seed: the concatenation of the domain
+ * separation string "curve9767-sign-nonce:" and the seed is used as
+ * input to SHAKE256; 64 bytes are output and reduced modulo the curve
+ * order to yield k (if k is zero, it is replaced with 1).
+ *
+ * SECURITY WARNING: using the same nonce for two distinct signatures
+ * reveals the private key. Each nonce is thus marked as "ready" when
+ * generated, and consumed by curve9767_sign_generate_online(): the
+ * secret scalar is erased and the nonce cannot be used again. The seed
+ * used to generate a nonce MUST have at least 128 bits of entropy, and
+ * MUST NOT be reused for another nonce. Contrary to the deterministic
+ * signature generation, this mode relies on the quality of the random
+ * source.
+ *
+ * The signatures produced with this mode are verified with
+ * curve9767_sign_verify() and curve9767_sign_verify_vartime(), as
+ * usual. A nonce is not tied to a given private key.
+ */
+typedef struct {
+	curve9767_scalar k;
+	uint8_t c[32];
+	uint32_t ready;
+} curve9767_sign_nonce;
+
+/*
+ * Generate a nonce from the provided seed. This computes k*G and is
+ * about as expensive as curve9767_sign_generate().
+ */
+void curve9767_sign_nonce_generate(curve9767_sign_nonce *nonce,
+	const void *seed, size_t seed_len);
+
+/*
+ * Signature generation with a prepared nonce. Secret scalar s and
+ * public key Q = s*G are provided, as well as the hashed message
+ * hv (of size hv_len bytes). Signature is written in sig[] and
+ * has length exactly 64 bytes. The nonce is consumed.
+ *
+ * Returned value is 1 on success. If the nonce was already consumed
+ * (or was never generated, i.e. is filled with zeros), then nothing is
+ * written in sig[] and 0 is returned.
+ *
+ * A given nonce structure MUST NOT be used concurrently by several
+ * threads; use a nonce pool (see below) to share nonces between
+ * threads.
+ */
+int curve9767_sign_generate_online(void *sig,
+	const curve9767_scalar *s, const curve9767_point *Q,
+	curve9767_sign_nonce *nonce,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/*
+ * A nonce pool is a bounded queue of prepared nonces. Producer threads
+ * add new nonces with curve9767_sign_pool_put(), and consumer threads
+ * obtain signatures with curve9767_sign_pool_sign(). Each nonce is
+ * removed from the pool and erased when used, so that a nonce cannot
+ * be obtained twice. All pool functions (except initialization) can be
+ * called concurrently from several threads; the implementation is
+ * lock-free and uses the GCC/Clang __atomic built-in functions.
+ *
+ * The caller provides the storage for the pool entries (the pool does
+ * not perform any dynamic memory allocation). The number of entries
+ * MUST be a power of two, and not greater than 2^31.
+ */
+typedef struct {
+	uint32_t seq;
+	curve9767_sign_nonce nonce;
+} curve9767_sign_pool_entry;
+
+typedef struct {
+	curve9767_sign_pool_entry *buf;
+	uint32_t mask;
+	uint32_t head;
+	uint32_t tail;
+} curve9767_sign_pool;
+
+/*
+ * Initialize a nonce pool over the provided array of entries, of size
+ * num. The pool is initially empty. Returned value is 1 on success, 0
+ * if num is not a power of two (or is too large).
+ */
+int curve9767_sign_pool_init(curve9767_sign_pool *pool,
+	curve9767_sign_pool_entry *buf, size_t num);
+
+/*
+ * Generate a new nonce from the provided seed (as with
+ * curve9767_sign_nonce_generate()) and add it to the pool. The seed
+ * MUST be fresh (at least 128 bits of entropy, never reused). If the
+ * pool is full, then no nonce is computed, and 0 is returned; otherwise,
+ * 1 is returned.
+ */
+int curve9767_sign_pool_put(curve9767_sign_pool *pool,
+	const void *seed, size_t seed_len);
+
+/*
+ * Obtain a nonce from the pool and use it to sign the hashed message
+ * hv (see curve9767_sign_generate_online()). Returned value is 1 on
+ * success, 0 if the pool is empty (in which case sig[] is not written;
+ * the caller may then fall back to curve9767_sign_generate()).
+ */
+int curve9767_sign_pool_sign(void *sig, curve9767_sign_pool *pool,
+	const curve9767_scalar *s, const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/* ===================================================================== */
+/*
+ * Pre-decoded public key store.
+ *
+ * Decoding a public key (curve9767_point_decode()) involves a square
+ * root computation in the field. Applications that load a large set of
+ * public keys can instead build a store once, with the keys already
+ * decoded, save it into a file, and later map that file read-only into
+ * memory (e.g. with mmap()). Opening a store takes constant time, and
+ * all processes that map the same file share the same physical pages.
+ *
+ * The store contains a 64-byte header (see keystore.c for the exact
+ * layout), followed by one curve9767_keystore_entry per key, sorted by
+ * encoded key. Since the entries contain in-memory curve9767_point
+ * structures, the store format is specific to the architecture and to
+ * the implementation; a store is rejected at opening if its byte order
+ * or entry size does not match. Precomputed per-key windows are not
+ * stored: for a single verification, they would save only the few point
+ * additions needed to build the window, while multiplying the store
+ * size by more than ten.
+ *
+ * Store contents are trusted: curve9767_keystore_open() only checks the
+ * header. curve9767_keystore_check() can be used to fully validate a
+ * store that comes from an untrusted source (this costs about as much
+ * as decoding all keys).
+ */
+
+/*
+ * Size of the store header (in bytes).
+ */
+#define CURVE9767_KEYSTORE_HEADER   64
+
+/*
+ * A store entry: encoded public key, and the corresponding decoded point.
+ */
+typedef struct {
+	uint8_t encoded[32];
+	curve9767_point Q;
+} curve9767_keystore_entry;
+
+/*
+ * An opened store. The entries are not copied; they remain in the
+ * buffer that was provided to curve9767_keystore_open().
+ */
+typedef struct {
+	const curve9767_keystore_entry *entries;
+	size_t num;
+} curve9767_keystore;
+
+/*
+ * Get the size (in bytes) of a store containing num keys. Returned
+ * value is 0 if the size does not fit in a size_t.
+ */
+size_t curve9767_keystore_size(size_t num);
+
+/*
+ * Build a store from num encoded public keys (32 bytes each,
+ * consecutive in encoded_keys[]). The store is written in dst[], which
+ * must be 32-bit aligned and have length at least
+ * curve9767_keystore_size(num) bytes. Returned value is 1 on success,
+ * 0 on error (destination buffer is too small or misaligned, one of the
+ * keys fails to decode, or two keys are identical). On error, the
+ * contents of dst[] are unspecified, but cannot be opened as a store:
+ * the header is cleared first, even if dst[] previously contained a
+ * valid store (a misaligned buffer is not modified).
+ */
+int curve9767_keystore_build(void *dst, size_t dst_len,
+	const void *encoded_keys, size_t num);
+
+/*
+ * Open a store located in the provided buffer (of length len bytes),
+ * which must be 32-bit aligned. Only the header is checked; this
+ * function does not read the entries. Returned value is 1 on success,
+ * 0 on error. The buffer must remain unmodified and accessible as long
+ * as the store is used.
+ */
+int curve9767_keystore_open(curve9767_keystore *ks,
+	const void *data, size_t len);
+
+/*
+ * Get the decoded point for entry idx (which must be lower than
+ * ks->num).
+ */
+static inline const curve9767_point *
+curve9767_keystore_get(const curve9767_keystore *ks, size_t idx)
+{
+	return &ks->entries[idx].Q;
+}
+
+/*
+ * Look up a public key by its encoding (32 bytes). Returned value is a
+ * pointer to the decoded point (within the store), or NULL if the key
+ * is not in the store. Lookup cost is logarithmic in the number of keys.
+ * This function is not constant-time.
+ */
+const curve9767_point *curve9767_keystore_find(
+	const curve9767_keystore *ks, const void *encoded);
+
+/*
+ * Fully validate an opened store: entries must be sorted with no
+ * duplicates, and each decoded point must match the decoding of the
+ * corresponding encoded key. Returned value is 1 if the store is valid,
+ * 0 otherwise.
+ */
+int curve9767_keystore_check(const curve9767_keystore *ks);
+
+/* ===================================================================== */
+/*
+ * Asynchronous engine.
+ *
+ * An engine runs key generation, ECDH and signature jobs on a pool of
+ * worker threads, so that event-driven applications do not have to
+ * block their own threads on expensive operations. A job is described
+ * by a curve9767_job structure, filled with one of the
+ * curve9767_job_*() functions below, and submitted with
+ * curve9767_engine_submit(), which never blocks. When the job has
+ * completed, either the provided callback is invoked (from a worker
+ * thread), or, if no callback was provided, the job is added to the
+ * completion queue, from which it is obtained with
+ * curve9767_engine_poll().
+ *
+ * The submission and completion queues are bounded lock-free queues
+ * (with the same design as the nonce pool). Idle workers sleep on a
+ * condition variable.
+ *
+ * Signature verification jobs are queued separately from other jobs.
+ * When a worker takes a verification job while more verification jobs
+ * are queued, it takes these as well (up to CURVE9767_ENGINE_BATCH
+ * jobs); other jobs are left in their queue, for other workers. If at
+ * least batch_min verification jobs are thus obtained, they are
+ * verified together with curve9767_sign_verify_batch_vartime(). If the
+ * batch is rejected, the signatures are verified again individually, to
+ * obtain the result of each job. Verification jobs always use the
+ * variable-time functions (see curve9767_sign_verify_vartime()).
+ *
+ * The job structure, and all buffers referenced by the job, MUST remain
+ * valid and MUST NOT be modified (except for the outputs, by the
+ * engine) until the job has completed.
+ */
+
+#define CURVE9767_JOB_KEYGEN        1
+#define CURVE9767_JOB_ECDH_KEYGEN   2
+#define CURVE9767_JOB_ECDH_RECV     3
+#define CURVE9767_JOB_SIGN          4
+#define CURVE9767_JOB_VERIFY        5
+
+/*
+ * Maximum number of jobs processed together by a worker.
+ */
+#define CURVE9767_ENGINE_BATCH      32
+
+typedef struct curve9767_job_ curve9767_job;
+
+struct curve9767_job_ {
+	/* Operation and parameters (set by the curve9767_job_*() functions) */
+	int op;
+	curve9767_scalar *s_out;
+	uint8_t *t_out;
+	curve9767_point *Q_out;
+	uint8_t *enc_out;
+	void *out;
+	size_t out_len;
+	const void *in;
+	size_t in_len;
+	const curve9767_scalar *s;
+	const uint8_t *t;
+	const curve9767_point *Q;
+	const char *hash_oid;
+	const void *hv;
+	size_t hv_len;
+
+	/* Completion callback (set by curve9767_engine_submit()) */
+	void (*done)(curve9767_job *job);
+
+	/* Free for use by the caller (set it after preparing the job,
+	   since the curve9767_job_*() functions clear all fields) */
+	void *user;
+
+	/* Result: returned value of the underlying function (1 if that
+	   function does not return a value) */
+	int result;
+};
+
+/*
+ * Prepare a job for curve9767_keygen(). Parameters are the same.
+ */
+void curve9767_job_keygen(curve9767_job *job,
+	curve9767_scalar *s, uint8_t t[32], curve9767_point *Q,
+	const void *seed, size_t seed_len);
+
+/*
+ * Prepare a job for curve9767_ecdh_keygen(). Parameters are the same.
+ */
+void curve9767_job_ecdh_keygen(curve9767_job *job,
+	curve9767_scalar *s, uint8_t encoded_Q[32],
+	const void *seed, size_t seed_len);
+
+/*
+ * Prepare a job for curve9767_ecdh_recv(). Parameters are the same.
+ */
+void curve9767_job_ecdh_recv(curve9767_job *job,
+	void *shared_secret, size_t shared_secret_len,
+	const curve9767_scalar *s, const uint8_t encoded_Q2[32]);
+
+/*
+ * Prepare a job for curve9767_sign_generate(). Parameters are the same.
+ */
+void curve9767_job_sign(curve9767_job *job, void *sig,
+	const curve9767_scalar *s, const uint8_t t[32],
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/*
+ * Prepare a job for curve9767_sign_verify_vartime(). Parameters are
+ * the same.
+ */
+void curve9767_job_verify(curve9767_job *job, const void *sig,
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+typedef struct curve9767_engine_ curve9767_engine;
+
+/*
+ * Create an engine with num_threads worker threads (1 to 256). At most
+ * queue_len jobs (a power of two, at most 2^20) may be pending at any
+ * time; a job is pending from its submission until it has completed
+ * (with a callback) or it has been obtained with curve9767_engine_poll().
+ * If batch_min is zero, verification jobs are never batched; otherwise,
+ * it must be at least 2.
+ *
+ * Returned value is NULL on error (invalid parameters, memory allocation
+ * failure, or failure to start the threads).
+ */
+curve9767_engine *curve9767_engine_new(unsigned num_threads,
+	size_t queue_len, unsigned batch_min);
+
+/*
+ * Submit a job. If done is not NULL, then it is called (from a worker
+ * thread) when the job has completed; otherwise, the completed job is
+ * added to the completion queue. Returned value is 1 on success, 0 if
+ * the job could not be submitted (too many pending jobs, or unknown
+ * operation).
+ *
+ * This function may be called concurrently from several threads,
+ * including from completion callbacks.
+ */
+int curve9767_engine_submit(curve9767_engine *eng,
+	curve9767_job *job, void (*done)(curve9767_job *job));
+
+/*
+ * Get the next completed job from the completion queue. Returned value
+ * is NULL if no completed job is available. This function never blocks
+ * and may be called concurrently from several threads.
+ */
+curve9767_job *curve9767_engine_poll(curve9767_engine *eng);
+
+/*
+ * Stop and release an engine. All submitted jobs are first completed
+ * (callbacks are invoked); jobs remaining in the completion queue are
+ * not returned. This function MUST NOT be called from a completion
+ * callback.
+ */
+void curve9767_engine_free(curve9767_engine *eng);
+
+/* ===================================================================== */
+/*
+ * Verified-signature cache.
+ *
+ * When the same signed message is received many times (e.g. in a
+ * gossip network), the verification can be skipped for signatures
+ * that were already found to be valid. A cache records positive
+ * verification results only: each entry is a 32-byte key computed
+ * with SHAKE256 over the concatenation of:
+ *   - the domain separation string "curve9767-sigcache:"
+ *   - the signature (64 bytes)
+ *   - the encoded public key (32 bytes)
+ *   - the hash function identifier, including its terminating zero
+ *   - the hashed message length (8 bytes, unsigned little-endian)
+ *   - the hashed message
+ * A cache hit thus means that the exact same (signature, key, hash
+ * function, message) tuple was previously verified.
+ *
+ * The cache is a set-associative table (four entries per set, with
+ * LRU replacement within each set), protected by a fixed number of
+ * locks (each lock covers a subset of the sets); it can be used
+ * concurrently from several threads. Its capacity is fixed when it is
+ * created. Hit and miss counters are maintained with atomic operations.
+ *
+ * Since only valid signatures are recorded, a hit result is the same
+ * as what curve9767_sign_verify_vartime() would return. Cache accesses
+ * are not constant-time, and a cache hit is much faster than a
+ * verification; an observer may thus infer whether a given signature
+ * was recently verified.
+ */
+
+typedef struct curve9767_sigcache_ curve9767_sigcache;
+
+/*
+ * Create a cache with room for at least 'capacity' entries (the value
+ * is rounded up to a power of two, and to at least 4). Returned value
+ * is NULL on error (capacity greater than 2^30, or memory allocation
+ * failure).
+ */
+curve9767_sigcache *curve9767_sigcache_new(size_t capacity);
+
+/*
+ * Release a cache.
+ */
+void curve9767_sigcache_free(curve9767_sigcache *sc);
+
+/*
+ * Remove all entries from a cache (counters are not reset).
+ */
+void curve9767_sigcache_clear(curve9767_sigcache *sc);
+
+/*
+ * Get the number of cache hits and misses since the cache was created
+ * (each of hits and misses may be NULL).
+ */
+void curve9767_sigcache_stats(curve9767_sigcache *sc,
+	uint64_t *hits, uint64_t *misses);
+
+/*
+ * Signature verification with a cache. Parameters and returned value
+ * are the same as for curve9767_sign_verify_vartime(). If the signature
+ * is found in the cache, then 1 is returned immediately; otherwise,
+ * the signature is verified and, if valid, added to the cache (possibly
+ * evicting the least recently used entry of its set).
+ *
+ * THIS FUNCTION IS NOT CONSTANT-TIME (see above and
+ * curve9767_sign_verify_vartime()).
+ */
+int curve9767_sign_verify_cached(curve9767_sigcache *sc, const void *sig,
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
+/* ===================================================================== */
+/*
+ * Operation counters.
+ *
+ * If the library is compiled with CURVE9767_STATS defined to a non-zero
+ * value (e.g. with -DCURVE9767_STATS=1), then the field and scalar
+ * primitives count their invocations, in per-thread counters. This is
+ * meant to check operation counts of high-level functions (e.g. number
+ * of inversions in a signature verification) against expectations.
+ *
+ * Nested calls are counted: for instance, a field inversion also counts
+ * the multiplications and Frobenius operators it uses internally. On
+ * the ARM Cortex-M0+ and M4, the primitives implemented in assembly are
+ * counted only when invoked from C code.
+ *
+ * The counters cost a few cycles per primitive; they should not be
+ * enabled in production builds.
+ */
+
+typedef struct {
+	/* field operations */
+	uint64_t gf_add;       /* additions */
+	uint64_t gf_sub;       /* subtractions */
+	uint64_t gf_neg;       /* negations (including conditional) */
+	uint64_t gf_mul;       /* multiplications */
+	uint64_t gf_sqr;       /* squarings */
+	uint64_t gf_mul_const; /* multiplications by a constant in GF(p) */
+	uint64_t gf_frob;      /* Frobenius operators */
+	uint64_t gf_inv;       /* inversions */
+	uint64_t gf_sqrt;      /* square roots and QR tests */
+	uint64_t gf_cubert;    /* cube roots */
+
+	/* scalar operations */
+	uint64_t scalar_add;   /* additions, subtractions and negations */
+	uint64_t scalar_mul;   /* multiplications */
+	uint64_t scalar_reduce;        /* decoding with modular reduction */
+	uint64_t scalar_reduce_basis;  /* lattice basis reductions */
+} curve9767_stats;
+
+/*
+ * Get a snapshot of the operation counters of the current thread.
+ * Returned value is 1 if counters are supported, 0 otherwise (library
+ * compiled without CURVE9767_STATS; all counters are then set to zero).
+ */
+int curve9767_stats_get(curve9767_stats *st);
+
+/*
+ * Reset the operation counters of the current thread.
+ */
+void curve9767_stats_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
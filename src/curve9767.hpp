@@ -0,0 +1,751 @@
+#ifndef CURVE9767_HPP__
+#define CURVE9767_HPP__
+
+/*
+ * C++ wrapper for the curve9767 API (header-only, C++20).
+ *
+ * All types are thin value wrappers around the C structures: they have
+ * the same size and layout (a single data member), are trivially
+ * copyable, and all member functions are inline calls to the C
+ * functions, with no allocation and no extra copy. Arrays of wrapper
+ * values can thus be passed to the C batch functions directly; the
+ * std::span overloads do exactly that.
+ *
+ * Fixed-size byte arrays (encoded scalars and points, signatures) use
+ * std::span<const std::uint8_t, N> parameters, so that a std::array
+ * or a C array of the right size can be passed without conversion.
+ *
+ * Functions that report success with a returned value in the C API
+ * return a bool here. The only exceptions thrown are std::bad_alloc
+ * and std::invalid_argument, from the constructors of the classes that
+ * own resources (sign_pool and engine); these classes are movable but
+ * not copyable.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "curve9767.h"
+
+namespace curve9767 {
+
+/*
+ * Hash function identifiers (for signatures). These are NUL-terminated
+ * character arrays, usable as 'const char *' with the C API and as
+ * constant expressions (e.g. std::string_view(oid::sha3_256)).
+ */
+namespace oid {
+inline constexpr char sha224[] = CURVE9767_OID_SHA224;
+inline constexpr char sha256[] = CURVE9767_OID_SHA256;
+inline constexpr char sha384[] = CURVE9767_OID_SHA384;
+inline constexpr char sha512[] = CURVE9767_OID_SHA512;
+inline constexpr char sha512_224[] = CURVE9767_OID_SHA512_224;
+inline constexpr char sha512_256[] = CURVE9767_OID_SHA512_256;
+inline constexpr char sha3_224[] = CURVE9767_OID_SHA3_224;
+inline constexpr char sha3_256[] = CURVE9767_OID_SHA3_256;
+inline constexpr char sha3_384[] = CURVE9767_OID_SHA3_384;
+inline constexpr char sha3_512[] = CURVE9767_OID_SHA3_512;
+inline constexpr char parallelhash256[] = CURVE9767_OID_PARALLELHASH256;
+}
+
+/*
+ * Domain separation strings used by the high-level operations (see
+ * curve9767.h). They are provided for interoperability with other
+ * implementations; the C functions already include them.
+ */
+namespace domain {
+inline constexpr std::string_view keygen = "curve9767-keygen:";
+inline constexpr std::string_view ecdh = "curve9767-ecdh:";
+inline constexpr std::string_view ecdh_failed = "curve9767-ecdh-failed:";
+inline constexpr std::string_view sign_k = "curve9767-sign-k:";
+inline constexpr std::string_view sign_e = "curve9767-sign-e:";
+inline constexpr std::string_view sign_agg = "curve9767-sign-agg:";
+inline constexpr std::string_view sign_batch = "curve9767-sign-batch:";
+inline constexpr std::string_view sign_nonce = "curve9767-sign-nonce:";
+}
+
+/*
+ * Sizes of encoded values.
+ */
+inline constexpr std::size_t scalar_size = 32;
+inline constexpr std::size_t point_size = 32;
+inline constexpr std::size_t signature_size = 64;
+inline constexpr std::size_t full_point_size = 64;
+inline constexpr std::size_t full_signature_size = 96;
+
+using bytes = std::span<const std::uint8_t>;
+using encoded_scalar = std::array<std::uint8_t, scalar_size>;
+using encoded_point = std::array<std::uint8_t, point_size>;
+using signature = std::array<std::uint8_t, signature_size>;
+using encoded_full_point = std::array<std::uint8_t, full_point_size>;
+using full_signature = std::array<std::uint8_t, full_signature_size>;
+
+/* ===================================================================== */
+
+/*
+ * Scalar (integer modulo the curve order). A default-constructed
+ * scalar is zero.
+ */
+class scalar {
+public:
+	scalar() noexcept : v_() { }
+	explicit scalar(const curve9767_scalar& s) noexcept : v_(s) { }
+
+	static scalar zero() noexcept { return scalar(curve9767_scalar_zero); }
+	static scalar one() noexcept { return scalar(curve9767_scalar_one); }
+
+	/* Decode with reduction modulo the curve order (any length). */
+	static scalar reduce(bytes src) noexcept
+	{
+		scalar r;
+		curve9767_scalar_decode_reduce(&r.v_, src.data(), src.size());
+		return r;
+	}
+
+	/* Strict decoding; returns false if the value is out of range. */
+	bool decode(bytes src) noexcept
+	{
+		return curve9767_scalar_decode_strict(&v_,
+			src.data(), src.size()) != 0;
+	}
+
+	void encode(std::span<std::uint8_t, scalar_size> dst) const noexcept
+	{
+		curve9767_scalar_encode(dst.data(), &v_);
+	}
+
+	encoded_scalar encode() const noexcept
+	{
+		encoded_scalar r;
+		encode(r);
+		return r;
+	}
+
+	bool is_zero() const noexcept
+	{
+		return curve9767_scalar_is_zero(&v_) != 0;
+	}
+
+	friend bool operator==(const scalar& a, const scalar& b) noexcept
+	{
+		return curve9767_scalar_eq(&a.v_, &b.v_) != 0;
+	}
+
+	friend scalar operator+(const scalar& a, const scalar& b) noexcept
+	{
+		scalar r;
+		curve9767_scalar_add(&r.v_, &a.v_, &b.v_);
+		return r;
+	}
+
+	friend scalar operator-(const scalar& a, const scalar& b) noexcept
+	{
+		scalar r;
+		curve9767_scalar_sub(&r.v_, &a.v_, &b.v_);
+		return r;
+	}
+
+	friend scalar operator*(const scalar& a, const scalar& b) noexcept
+	{
+		scalar r;
+		curve9767_scalar_mul(&r.v_, &a.v_, &b.v_);
+		return r;
+	}
+
+	scalar operator-() const noexcept
+	{
+		scalar r;
+		curve9767_scalar_neg(&r.v_, &v_);
+		return r;
+	}
+
+	scalar& operator+=(const scalar& b) noexcept
+	{
+		curve9767_scalar_add(&v_, &v_, &b.v_);
+		return *this;
+	}
+
+	scalar& operator-=(const scalar& b) noexcept
+	{
+		curve9767_scalar_sub(&v_, &v_, &b.v_);
+		return *this;
+	}
+
+	scalar& operator*=(const scalar& b) noexcept
+	{
+		curve9767_scalar_mul(&v_, &v_, &b.v_);
+		return *this;
+	}
+
+	/* Set this scalar to a if ctl is 1, unchanged if ctl is 0. */
+	void condcopy(const scalar& a, std::uint32_t ctl) noexcept
+	{
+		curve9767_scalar_condcopy(&v_, &a.v_, ctl);
+	}
+
+	curve9767_scalar *c() noexcept { return &v_; }
+	const curve9767_scalar *c() const noexcept { return &v_; }
+
+private:
+	curve9767_scalar v_;
+};
+
+/*
+ * Curve point. A default-constructed point is the point-at-infinity.
+ */
+class point {
+public:
+	point() noexcept { curve9767_point_set_neutral(&v_); }
+	explicit point(const curve9767_point& Q) noexcept : v_(Q) { }
+
+	static point neutral() noexcept { return point(); }
+	static point generator() noexcept
+	{
+		return point(curve9767_generator);
+	}
+
+	/* Decode 32 bytes; returns false (point is neutral) on error. */
+	bool decode(std::span<const std::uint8_t, point_size> src) noexcept
+	{
+		return curve9767_point_decode(&v_, src.data()) != 0;
+	}
+
+	/* Encode; returns false if the point is the point-at-infinity. */
+	bool encode(std::span<std::uint8_t, point_size> dst) const noexcept
+	{
+		return curve9767_point_encode(dst.data(), &v_) != 0;
+	}
+
+	encoded_point encode() const noexcept
+	{
+		encoded_point r;
+		encode(r);
+		return r;
+	}
+
+	bool encode_x(std::span<std::uint8_t, point_size> dst) const noexcept
+	{
+		return curve9767_point_encode_X(dst.data(), &v_) != 0;
+	}
+
+	/* Uncompressed format (see curve9767_point_decode_full()). */
+	bool decode_full(
+		std::span<const std::uint8_t, full_point_size> src) noexcept
+	{
+		return curve9767_point_decode_full(&v_, src.data()) != 0;
+	}
+
+	bool encode_full(
+		std::span<std::uint8_t, full_point_size> dst) const noexcept
+	{
+		return curve9767_point_encode_full(dst.data(), &v_) != 0;
+	}
+
+	encoded_full_point encode_full() const noexcept
+	{
+		encoded_full_point r;
+		encode_full(r);
+		return r;
+	}
+
+	bool is_neutral() const noexcept
+	{
+		return curve9767_point_is_neutral(&v_) != 0;
+	}
+
+	friend point operator+(const point& a, const point& b) noexcept
+	{
+		point r(no_init);
+		curve9767_point_add(&r.v_, &a.v_, &b.v_);
+		return r;
+	}
+
+	friend point operator-(const point& a, const point& b) noexcept
+	{
+		point r(no_init);
+		curve9767_point_sub(&r.v_, &a.v_, &b.v_);
+		return r;
+	}
+
+	point operator-() const noexcept
+	{
+		point r(no_init);
+		curve9767_point_neg(&r.v_, &v_);
+		return r;
+	}
+
+	friend point operator*(const point& a, const scalar& s) noexcept
+	{
+		point r(no_init);
+		curve9767_point_mul(&r.v_, &a.v_, s.c());
+		return r;
+	}
+
+	friend point operator*(const scalar& s, const point& a) noexcept
+	{
+		return a * s;
+	}
+
+	point& operator+=(const point& b) noexcept
+	{
+		curve9767_point_add(&v_, &v_, &b.v_);
+		return *this;
+	}
+
+	point& operator-=(const point& b) noexcept
+	{
+		curve9767_point_sub(&v_, &v_, &b.v_);
+		return *this;
+	}
+
+	point& operator*=(const scalar& s) noexcept
+	{
+		curve9767_point_mul(&v_, &v_, s.c());
+		return *this;
+	}
+
+	/* 2^k times this point. */
+	point mul2k(unsigned k) const noexcept
+	{
+		point r(no_init);
+		curve9767_point_mul2k(&r.v_, &v_, k);
+		return r;
+	}
+
+	/* s times this point, for s < 2^bitlen (bitlen is public). */
+	point mul_short(const scalar& s, unsigned bitlen) const noexcept
+	{
+		point r(no_init);
+		curve9767_point_mul_short(&r.v_, &v_, s.c(), bitlen);
+		return r;
+	}
+
+	/* s*G (generator). */
+	static point mulgen(const scalar& s) noexcept
+	{
+		point r(no_init);
+		curve9767_point_mulgen(&r.v_, s.c());
+		return r;
+	}
+
+	/* s1*P1 + s2*P2 (constant-time). */
+	static point mul2_add(const point& P1, const scalar& s1,
+		const point& P2, const scalar& s2) noexcept
+	{
+		point r(no_init);
+		curve9767_point_mul2_add(&r.v_, &P1.v_, s1.c(),
+			&P2.v_, s2.c());
+		return r;
+	}
+
+	/* s1*Q1 + s2*G. */
+	static point mul_mulgen_add(const point& Q1,
+		const scalar& s1, const scalar& s2) noexcept
+	{
+		point r(no_init);
+		curve9767_point_mul_mulgen_add(&r.v_, &Q1.v_, s1.c(), s2.c());
+		return r;
+	}
+
+	curve9767_point *c() noexcept { return &v_; }
+	const curve9767_point *c() const noexcept { return &v_; }
+
+private:
+	struct no_init_t { };
+	static constexpr no_init_t no_init{};
+	explicit point(no_init_t) noexcept { }
+
+	curve9767_point v_;
+};
+
+/*
+ * The wrappers have exactly the layout of the C structures, so that
+ * spans of wrappers can be passed as arrays to the C functions.
+ */
+static_assert(sizeof(scalar) == sizeof(curve9767_scalar));
+static_assert(sizeof(point) == sizeof(curve9767_point));
+static_assert(std::is_standard_layout_v<scalar>);
+static_assert(std::is_standard_layout_v<point>);
+static_assert(std::is_trivially_copyable_v<scalar>);
+static_assert(std::is_trivially_copyable_v<point>);
+
+/*
+ * Multi-scalar multiplication: r is set to the sum of s[i]*pts[i] (see
+ * curve9767_point_mulN_vartime()). Returns false (and leaves r
+ * unmodified) if the two spans do not have the same size.
+ * NOT CONSTANT-TIME.
+ */
+inline bool
+mulN_vartime(point& r, std::span<const point> pts,
+	std::span<const scalar> s, unsigned num_threads = 1) noexcept
+{
+	if (pts.size() != s.size()) {
+		return false;
+	}
+	curve9767_point_mulN_vartime(r.c(),
+		reinterpret_cast<const curve9767_point *>(pts.data()),
+		reinterpret_cast<const curve9767_scalar *>(s.data()),
+		pts.size(), num_threads);
+	return true;
+}
+
+/* ===================================================================== */
+
+/*
+ * SHAKE context (SHAKE128 or SHAKE256). Copying a context clones the
+ * running state.
+ */
+class shake {
+public:
+	explicit shake(unsigned size = 256) noexcept { shake_init(&sc_, size); }
+
+	shake& inject(bytes src) noexcept
+	{
+		shake_inject(&sc_, src.data(), src.size());
+		return *this;
+	}
+
+	shake& inject(std::string_view src) noexcept
+	{
+		shake_inject(&sc_, src.data(), src.size());
+		return *this;
+	}
+
+	shake& flip() noexcept
+	{
+		shake_flip(&sc_);
+		return *this;
+	}
+
+	void extract(std::span<std::uint8_t> dst) noexcept
+	{
+		shake_extract(&sc_, dst.data(), dst.size());
+	}
+
+	/* Map the (flipped) SHAKE output to a curve point. */
+	point hash_to_curve() noexcept
+	{
+		point r;
+		curve9767_hash_to_curve(r.c(), &sc_);
+		return r;
+	}
+
+	/* Non-uniform variant (see curve9767_encode_to_curve()). */
+	point encode_to_curve() noexcept
+	{
+		point r;
+		curve9767_encode_to_curve(r.c(), &sc_);
+		return r;
+	}
+
+	shake_context *c() noexcept { return &sc_; }
+	const shake_context *c() const noexcept { return &sc_; }
+
+private:
+	shake_context sc_;
+};
+
+/* ===================================================================== */
+
+/*
+ * Prepared public key: the decoded point and its encoding, so that
+ * signature verification does not decode the key again.
+ */
+class public_key {
+public:
+	public_key() noexcept : enc_() { }
+
+	/* Decode a public key; returns false on error. */
+	bool decode(std::span<const std::uint8_t, point_size> src) noexcept
+	{
+		std::copy(src.begin(), src.end(), enc_.begin());
+		return Q_.decode(src);
+	}
+
+	/* Decode a public key in uncompressed format. */
+	bool decode_full(
+		std::span<const std::uint8_t, full_point_size> src) noexcept
+	{
+		bool r;
+
+		r = Q_.decode_full(src);
+		Q_.encode(enc_);
+		return r;
+	}
+
+	/* Set from a point (which must not be the point-at-infinity). */
+	explicit public_key(const point& Q) noexcept : Q_(Q), enc_(Q.encode())
+	{ }
+
+	const point& Q() const noexcept { return Q_; }
+	const encoded_point& encoded() const noexcept { return enc_; }
+
+	bool verify(std::span<const std::uint8_t, signature_size> sig,
+		const char *hash_oid, bytes hv) const noexcept
+	{
+		return curve9767_sign_verify(sig.data(), Q_.c(),
+			hash_oid, hv.data(), hv.size()) != 0;
+	}
+
+	/* NOT CONSTANT-TIME (see curve9767_sign_verify_vartime()). */
+	bool verify_vartime(std::span<const std::uint8_t, signature_size> sig,
+		const char *hash_oid, bytes hv) const noexcept
+	{
+		return curve9767_sign_verify_vartime(sig.data(), Q_.c(),
+			hash_oid, hv.data(), hv.size()) != 0;
+	}
+
+	/* NOT CONSTANT-TIME (see curve9767_sign_verify_full_vartime()). */
+	bool verify_full_vartime(
+		std::span<const std::uint8_t, full_signature_size> sig,
+		const char *hash_oid, bytes hv) const noexcept
+	{
+		return curve9767_sign_verify_full_vartime(sig.data(), Q_.c(),
+			hash_oid, hv.data(), hv.size()) != 0;
+	}
+
+	/* Signed message descriptor for the aggregate/batch functions. */
+	curve9767_sign_msg msg(const char *hash_oid, bytes hv) const noexcept
+	{
+		return curve9767_sign_msg{ Q_.c(), hash_oid, hv.data(),
+			hv.size() };
+	}
+
+private:
+	point Q_;
+	encoded_point enc_;
+};
+
+/*
+ * Private key (secret scalar s, additional secret t) with the
+ * corresponding public key.
+ */
+class private_key {
+public:
+	/* Generate from a seed (see curve9767_keygen()). */
+	explicit private_key(bytes seed) noexcept
+	{
+		point Q;
+
+		curve9767_keygen(s_.c(), t_.data(), Q.c(),
+			seed.data(), seed.size());
+		pub_ = public_key(Q);
+		curve9767_sign_key_init(&sk_, s_.c(), t_.data(), Q.c());
+	}
+
+	~private_key()
+	{
+		volatile std::uint8_t *p;
+
+		p = reinterpret_cast<volatile std::uint8_t *>(&s_);
+		for (std::size_t u = 0; u < sizeof s_; u ++) {
+			p[u] = 0;
+		}
+		p = t_.data();
+		for (std::size_t u = 0; u < t_.size(); u ++) {
+			p[u] = 0;
+		}
+		p = reinterpret_cast<volatile std::uint8_t *>(&sk_);
+		for (std::size_t u = 0; u < sizeof sk_; u ++) {
+			p[u] = 0;
+		}
+	}
+
+	private_key(const private_key&) noexcept = default;
+	private_key& operator=(const private_key&) noexcept = default;
+
+	const scalar& s() const noexcept { return s_; }
+	const public_key& pub() const noexcept { return pub_; }
+
+	/* Uses the expanded key (see curve9767_sign_generate_key()). */
+	void sign(std::span<std::uint8_t, signature_size> sig,
+		const char *hash_oid, bytes hv) const noexcept
+	{
+		curve9767_sign_generate_key(sig.data(), &sk_,
+			hash_oid, hv.data(), hv.size());
+	}
+
+	signature sign(const char *hash_oid, bytes hv) const noexcept
+	{
+		signature r;
+		sign(r, hash_oid, hv);
+		return r;
+	}
+
+	void sign_full(std::span<std::uint8_t, full_signature_size> sig,
+		const char *hash_oid, bytes hv) const noexcept
+	{
+		curve9767_sign_generate_full(sig.data(), s_.c(), t_.data(),
+			pub_.Q().c(), hash_oid, hv.data(), hv.size());
+	}
+
+	full_signature sign_full(const char *hash_oid, bytes hv) const noexcept
+	{
+		full_signature r;
+		sign_full(r, hash_oid, hv);
+		return r;
+	}
+
+	/* ECDH with the encoded peer point; returns false if invalid. */
+	bool ecdh(std::span<std::uint8_t> shared_secret,
+		std::span<const std::uint8_t, point_size> peer) const noexcept
+	{
+		return curve9767_ecdh_recv(shared_secret.data(),
+			shared_secret.size(), s_.c(), peer.data()) != 0;
+	}
+
+	/* ECDH with the peer point in uncompressed format. */
+	bool ecdh_full(std::span<std::uint8_t> shared_secret,
+		std::span<const std::uint8_t, full_point_size> peer)
+		const noexcept
+	{
+		return curve9767_ecdh_recv_full(shared_secret.data(),
+			shared_secret.size(), s_.c(), peer.data()) != 0;
+	}
+
+private:
+	scalar s_;
+	std::array<std::uint8_t, 32> t_;
+	public_key pub_;
+	curve9767_sign_key sk_;
+};
+
+/*
+ * Batch verification of sigs.size()/64 signatures (see
+ * curve9767_sign_verify_batch_vartime()). Returns false if the sizes
+ * do not match. NOT CONSTANT-TIME.
+ */
+inline bool
+verify_batch_vartime(bytes sigs, std::span<const curve9767_sign_msg> msg)
+	noexcept
+{
+	if (sigs.size() != signature_size * msg.size()) {
+		return false;
+	}
+	return curve9767_sign_verify_batch_vartime(sigs.data(),
+		msg.data(), msg.size()) != 0;
+}
+
+/*
+ * Aggregate signatures (see curve9767_sign_aggregate()); agg must have
+ * size 32*msg.size()+32.
+ */
+inline bool
+aggregate(std::span<std::uint8_t> agg, bytes sigs,
+	std::span<const curve9767_sign_msg> msg) noexcept
+{
+	if (sigs.size() != signature_size * msg.size()
+		|| agg.size() != 32 * msg.size() + 32)
+	{
+		return false;
+	}
+	return curve9767_sign_aggregate(agg.data(), sigs.data(),
+		msg.data(), msg.size()) != 0;
+}
+
+/*
+ * Verify an aggregate signature. NOT CONSTANT-TIME.
+ */
+inline bool
+verify_aggregate_vartime(bytes agg, std::span<const curve9767_sign_msg> msg)
+	noexcept
+{
+	if (agg.size() != 32 * msg.size() + 32) {
+		return false;
+	}
+	return curve9767_sign_verify_aggregate_vartime(agg.data(),
+		msg.data(), msg.size()) != 0;
+}
+
+/* ===================================================================== */
+
+/*
+ * Nonce pool (fixed-base precomputations for offline/online signing),
+ * owning its entries. The number of entries must be a power of two.
+ */
+class sign_pool {
+public:
+	explicit sign_pool(std::size_t num)
+		: buf_(new curve9767_sign_pool_entry[num])
+	{
+		if (!curve9767_sign_pool_init(&pool_, buf_.get(), num)) {
+			throw std::invalid_argument("curve9767::sign_pool");
+		}
+	}
+
+	/* The entries stay at the same address when the pool is moved. */
+	sign_pool(sign_pool&&) noexcept = default;
+	sign_pool& operator=(sign_pool&&) noexcept = default;
+
+	bool put(bytes seed) noexcept
+	{
+		return curve9767_sign_pool_put(&pool_,
+			seed.data(), seed.size()) != 0;
+	}
+
+	bool sign(std::span<std::uint8_t, signature_size> sig,
+		const private_key& sk, const char *hash_oid, bytes hv) noexcept
+	{
+		return curve9767_sign_pool_sign(sig.data(), &pool_,
+			sk.s().c(), sk.pub().Q().c(),
+			hash_oid, hv.data(), hv.size()) != 0;
+	}
+
+	curve9767_sign_pool *c() noexcept { return &pool_; }
+
+private:
+	std::unique_ptr<curve9767_sign_pool_entry[]> buf_;
+	curve9767_sign_pool pool_;
+};
+
+/*
+ * Asynchronous engine (see curve9767_engine_new()). Jobs are prepared
+ * with the curve9767_job_*() C functions.
+ */
+class engine {
+public:
+	engine(unsigned num_threads, std::size_t queue_len,
+		unsigned batch_min = CURVE9767_ENGINE_BATCH)
+		: eng_(curve9767_engine_new(num_threads, queue_len, batch_min))
+	{
+		if (eng_ == nullptr) {
+			throw std::bad_alloc();
+		}
+	}
+
+	bool submit(curve9767_job& job,
+		void (*done)(curve9767_job *job) = nullptr) noexcept
+	{
+		return curve9767_engine_submit(eng_.get(), &job, done) != 0;
+	}
+
+	curve9767_job *poll() noexcept
+	{
+		return curve9767_engine_poll(eng_.get());
+	}
+
+	curve9767_engine *c() noexcept { return eng_.get(); }
+
+private:
+	struct deleter {
+		void operator()(curve9767_engine *eng) const noexcept
+		{
+			curve9767_engine_free(eng);
+		}
+	};
+
+	std::unique_ptr<curve9767_engine, deleter> eng_;
+};
+
+}
+
+#endif
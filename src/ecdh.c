@@ -18,24 +18,26 @@ curve9767_ecdh_keygen(curve9767_scalar *s, uint8_t encoded_Q[32],
 	}
 }
 
-/* see curve9767.h */
-int
-curve9767_ecdh_recv(void *shared_secret, size_t shared_secret_len,
-	const curve9767_scalar *s, const uint8_t encoded_Q2[32])
+/*
+ * Finish ECDH processing, with the decoded peer point Q2 (r = 1 if
+ * decoding succeeded, 0 otherwise). The received encoded point (of
+ * length enc_len bytes) is used for the alternate pre-master secret.
+ */
+static int
+ecdh_finish(void *shared_secret, size_t shared_secret_len,
+	const curve9767_scalar *s, curve9767_point *Q2, uint32_t r,
+	const uint8_t *encoded_Q2, size_t enc_len)
 {
 	uint8_t pm[32], tmp[32];
-	curve9767_point Q2;
-	uint32_t r;
 	shake_context sc;
 	int i;
 
 	/*
-	 * Decode input point, do the point multiplication, and encode
-	 * the result into the pre-master array.
+	 * Do the point multiplication, and encode the result into the
+	 * pre-master array.
 	 */
-	r = curve9767_point_decode(&Q2, encoded_Q2);
-	curve9767_point_mul(&Q2, &Q2, s);
-	curve9767_point_encode_X(pm, &Q2);
+	curve9767_point_mul(Q2, Q2, s);
+	curve9767_point_encode_X(pm, Q2);
 
 	/*
 	 * Compute the alternate pre-master secret, to be used in case
@@ -45,7 +47,7 @@ curve9767_ecdh_recv(void *shared_secret, size_t shared_secret_len,
 	shake_init(&sc, 256);
 	shake_inject(&sc, DOM_ECDH_FAIL, strlen(DOM_ECDH_FAIL));
 	shake_inject(&sc, tmp, 32);
-	shake_inject(&sc, encoded_Q2, 32);
+	shake_inject(&sc, encoded_Q2, enc_len);
 	shake_flip(&sc);
 	shake_extract(&sc, tmp, 32);
 
@@ -68,3 +70,29 @@ curve9767_ecdh_recv(void *shared_secret, size_t shared_secret_len,
 
 	return (int)r;
 }
+
+/* see curve9767.h */
+int
+curve9767_ecdh_recv(void *shared_secret, size_t shared_secret_len,
+	const curve9767_scalar *s, const uint8_t encoded_Q2[32])
+{
+	curve9767_point Q2;
+	uint32_t r;
+
+	r = curve9767_point_decode(&Q2, encoded_Q2);
+	return ecdh_finish(shared_secret, shared_secret_len,
+		s, &Q2, r, encoded_Q2, 32);
+}
+
+/* see curve9767.h */
+int
+curve9767_ecdh_recv_full(void *shared_secret, size_t shared_secret_len,
+	const curve9767_scalar *s, const uint8_t encoded_Q2[64])
+{
+	curve9767_point Q2;
+	uint32_t r;
+
+	r = curve9767_point_decode_full(&Q2, encoded_Q2);
+	return ecdh_finish(shared_secret, shared_secret_len,
+		s, &Q2, r, encoded_Q2, 64);
+}
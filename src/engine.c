@@ -0,0 +1,535 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "inner.h"
+
+/*
+ * The submission and completion queues are bounded multi-producer
+ * multi-consumer queues of job pointers, with the same design as the
+ * nonce pool (see signpool.c): each slot has a sequence number which
+ * tells whether it is free for the producer at a given position, or
+ * holds a job for the consumer at that position.
+ *
+ * When batching is enabled, verification jobs are submitted into their
+ * own queue: a worker which takes a verification job then takes further
+ * verification jobs only, so that other jobs (which cannot be batched)
+ * are never held back by a worker while other workers are idle. Workers
+ * alternate between the two queues to choose which one to check first,
+ * so that neither kind of job can starve the other.
+ *
+ * The number of pending jobs (submitted, and not yet returned to the
+ * caller) is bounded by the queue length; thus, no queue can
+ * actually be full when a job is pushed. A push may still transiently
+ * fail if a consumer has reserved a slot but not yet released it; the
+ * push is then retried.
+ *
+ * Workers that find the submission queue empty sleep on a condition
+ * variable. A submitter wakes up a worker only if some are sleeping;
+ * the 'sleepers' counter is incremented by a worker before it checks
+ * the queue a last time, and read by the submitter after its push,
+ * with sequentially consistent ordering on both sides, so that a job
+ * cannot be left in the queue while all workers sleep.
+ */
+
+typedef struct {
+	uint32_t seq;
+	curve9767_job *job;
+} queue_slot;
+
+typedef struct {
+	queue_slot *buf;
+	uint32_t mask;
+	uint32_t head;
+	uint32_t tail;
+} job_queue;
+
+#define ENGINE_MAX_THREADS   256
+#define ENGINE_MAX_QUEUE     ((size_t)1 << 20)
+
+struct curve9767_engine_ {
+	job_queue sq, vq, cq;
+	uint32_t capacity;
+	uint32_t pending;
+	unsigned batch_min;
+	unsigned num_threads;
+	pthread_t *th;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t sleepers;
+	uint32_t stop;
+};
+
+static void
+queue_init(job_queue *q, queue_slot *buf, size_t num)
+{
+	size_t u;
+
+	for (u = 0; u < num; u ++) {
+		buf[u].seq = (uint32_t)u;
+		buf[u].job = NULL;
+	}
+	q->buf = buf;
+	q->mask = (uint32_t)(num - 1);
+	q->head = 0;
+	q->tail = 0;
+}
+
+/*
+ * Push a job. Returned value is 0 if no slot is currently available.
+ */
+static int
+queue_push(job_queue *q, curve9767_job *job)
+{
+	uint32_t p;
+
+	p = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+	for (;;) {
+		queue_slot *e;
+		int32_t dif;
+
+		e = &q->buf[p & q->mask];
+		dif = (int32_t)(__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) - p);
+		if (dif == 0) {
+			if (__atomic_compare_exchange_n(&q->tail, &p, p + 1, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				e->job = job;
+				__atomic_store_n(&e->seq, p + 1,
+					__ATOMIC_RELEASE);
+				return 1;
+			}
+		} else if (dif < 0) {
+			return 0;
+		} else {
+			p = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/*
+ * Pop a job. Returned value is NULL if the queue is empty.
+ */
+static curve9767_job *
+queue_pop(job_queue *q)
+{
+	uint32_t p;
+
+	p = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+	for (;;) {
+		queue_slot *e;
+		int32_t dif;
+
+		e = &q->buf[p & q->mask];
+		dif = (int32_t)(__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE)
+			- (p + 1));
+		if (dif == 0) {
+			if (__atomic_compare_exchange_n(&q->head, &p, p + 1, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				curve9767_job *job;
+
+				job = e->job;
+				__atomic_store_n(&e->seq, p + q->mask + 1,
+					__ATOMIC_RELEASE);
+				return job;
+			}
+		} else if (dif < 0) {
+			return NULL;
+		} else {
+			p = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/*
+ * Push a job into a queue which is known not to be full (see above).
+ */
+static void
+queue_push_retry(job_queue *q, curve9767_job *job)
+{
+	while (!queue_push(q, job)) {
+		sched_yield();
+	}
+}
+
+/*
+ * Report a completed job.
+ */
+static void
+complete(curve9767_engine *eng, curve9767_job *job)
+{
+	if (job->done != NULL) {
+		job->done(job);
+		__atomic_sub_fetch(&eng->pending, 1, __ATOMIC_RELEASE);
+	} else {
+		queue_push_retry(&eng->cq, job);
+	}
+}
+
+/*
+ * Run a single job.
+ */
+static void
+run_job(curve9767_job *job)
+{
+	switch (job->op) {
+	case CURVE9767_JOB_KEYGEN:
+		curve9767_keygen(job->s_out, job->t_out, job->Q_out,
+			job->in, job->in_len);
+		job->result = 1;
+		break;
+	case CURVE9767_JOB_ECDH_KEYGEN:
+		curve9767_ecdh_keygen(job->s_out, job->enc_out,
+			job->in, job->in_len);
+		job->result = 1;
+		break;
+	case CURVE9767_JOB_ECDH_RECV:
+		job->result = curve9767_ecdh_recv(job->out, job->out_len,
+			job->s, job->in);
+		break;
+	case CURVE9767_JOB_SIGN:
+		curve9767_sign_generate(job->out, job->s, job->t, job->Q,
+			job->hash_oid, job->hv, job->hv_len);
+		job->result = 1;
+		break;
+	case CURVE9767_JOB_VERIFY:
+		job->result = curve9767_sign_verify_vartime(job->in, job->Q,
+			job->hash_oid, job->hv, job->hv_len);
+		break;
+	default:
+		job->result = 0;
+		break;
+	}
+}
+
+/*
+ * Verify a batch of signatures. If the batch verification fails, the
+ * signatures are verified individually.
+ */
+static void
+run_verify_batch(curve9767_engine *eng, curve9767_job **jobs, size_t num)
+{
+	uint8_t sigs[CURVE9767_ENGINE_BATCH * 64];
+	curve9767_sign_msg msg[CURVE9767_ENGINE_BATCH];
+	size_t u;
+	int r;
+
+	for (u = 0; u < num; u ++) {
+		memcpy(sigs + (u << 6), jobs[u]->in, 64);
+		msg[u].Q = jobs[u]->Q;
+		msg[u].hash_oid = jobs[u]->hash_oid;
+		msg[u].hv = jobs[u]->hv;
+		msg[u].hv_len = jobs[u]->hv_len;
+	}
+	r = curve9767_sign_verify_batch_vartime(sigs, msg, num);
+	for (u = 0; u < num; u ++) {
+		if (r) {
+			jobs[u]->result = 1;
+		} else {
+			run_job(jobs[u]);
+		}
+		complete(eng, jobs[u]);
+	}
+}
+
+/*
+ * Take a job from the submission queues. The verification queue is
+ * checked first if *vfirst is non-zero; *vfirst is toggled on each
+ * call. Returned value is NULL if both queues are empty.
+ */
+static curve9767_job *
+next_job(curve9767_engine *eng, int *vfirst)
+{
+	curve9767_job *job;
+
+	if (*vfirst) {
+		job = queue_pop(&eng->vq);
+		if (job == NULL) {
+			job = queue_pop(&eng->sq);
+		}
+	} else {
+		job = queue_pop(&eng->sq);
+		if (job == NULL) {
+			job = queue_pop(&eng->vq);
+		}
+	}
+	*vfirst = !*vfirst;
+	return job;
+}
+
+/*
+ * Process a job obtained from the submission queues. For a verification
+ * job (taken from the verification queue), further queued verification
+ * jobs are taken, so that they may be batched.
+ */
+static void
+process(curve9767_engine *eng, curve9767_job *job)
+{
+	curve9767_job *vj[CURVE9767_ENGINE_BATCH];
+	size_t nv, u;
+
+	if (job->op != CURVE9767_JOB_VERIFY || eng->batch_min == 0) {
+		run_job(job);
+		complete(eng, job);
+		return;
+	}
+	vj[0] = job;
+	nv = 1;
+	while (nv < CURVE9767_ENGINE_BATCH) {
+		curve9767_job *j;
+
+		j = queue_pop(&eng->vq);
+		if (j == NULL) {
+			break;
+		}
+		vj[nv ++] = j;
+	}
+	if (nv >= eng->batch_min) {
+		run_verify_batch(eng, vj, nv);
+	} else {
+		for (u = 0; u < nv; u ++) {
+			run_job(vj[u]);
+			complete(eng, vj[u]);
+		}
+	}
+}
+
+static void *
+worker(void *arg)
+{
+	curve9767_engine *eng;
+	int vfirst;
+
+	eng = arg;
+	vfirst = 0;
+	for (;;) {
+		curve9767_job *job;
+
+		job = next_job(eng, &vfirst);
+		if (job == NULL) {
+			pthread_mutex_lock(&eng->lock);
+			__atomic_add_fetch(&eng->sleepers, 1, __ATOMIC_SEQ_CST);
+			for (;;) {
+				job = next_job(eng, &vfirst);
+				if (job != NULL || __atomic_load_n(&eng->stop,
+					__ATOMIC_ACQUIRE))
+				{
+					break;
+				}
+				pthread_cond_wait(&eng->cond, &eng->lock);
+			}
+			__atomic_sub_fetch(&eng->sleepers, 1, __ATOMIC_SEQ_CST);
+			pthread_mutex_unlock(&eng->lock);
+			if (job == NULL) {
+				return NULL;
+			}
+		}
+		process(eng, job);
+	}
+}
+
+static void
+wake_all(curve9767_engine *eng)
+{
+	pthread_mutex_lock(&eng->lock);
+	pthread_cond_broadcast(&eng->cond);
+	pthread_mutex_unlock(&eng->lock);
+}
+
+/* see curve9767.h */
+curve9767_engine *
+curve9767_engine_new(unsigned num_threads, size_t queue_len,
+	unsigned batch_min)
+{
+	curve9767_engine *eng;
+	queue_slot *slots;
+	unsigned u;
+
+	if (num_threads == 0 || num_threads > ENGINE_MAX_THREADS
+		|| queue_len == 0 || queue_len > ENGINE_MAX_QUEUE
+		|| (queue_len & (queue_len - 1)) != 0
+		|| batch_min == 1)
+	{
+		return NULL;
+	}
+	eng = malloc(sizeof *eng);
+	slots = malloc(3 * queue_len * sizeof *slots);
+	if (eng == NULL || slots == NULL) {
+		free(eng);
+		free(slots);
+		return NULL;
+	}
+	eng->th = malloc(num_threads * sizeof *eng->th);
+	if (eng->th == NULL) {
+		free(eng);
+		free(slots);
+		return NULL;
+	}
+	queue_init(&eng->sq, slots, queue_len);
+	queue_init(&eng->vq, slots + queue_len, queue_len);
+	queue_init(&eng->cq, slots + 2 * queue_len, queue_len);
+	eng->capacity = (uint32_t)queue_len;
+	eng->pending = 0;
+	eng->batch_min = batch_min;
+	eng->sleepers = 0;
+	eng->stop = 0;
+	pthread_mutex_init(&eng->lock, NULL);
+	pthread_cond_init(&eng->cond, NULL);
+	for (u = 0; u < num_threads; u ++) {
+		if (pthread_create(&eng->th[u], NULL, worker, eng) != 0) {
+			break;
+		}
+	}
+	eng->num_threads = u;
+	if (u < num_threads) {
+		curve9767_engine_free(eng);
+		return NULL;
+	}
+	return eng;
+}
+
+/* see curve9767.h */
+int
+curve9767_engine_submit(curve9767_engine *eng,
+	curve9767_job *job, void (*done)(curve9767_job *job))
+{
+	uint32_t p;
+
+	if (job->op < CURVE9767_JOB_KEYGEN || job->op > CURVE9767_JOB_VERIFY) {
+		return 0;
+	}
+	p = __atomic_load_n(&eng->pending, __ATOMIC_RELAXED);
+	do {
+		if (p >= eng->capacity) {
+			return 0;
+		}
+	} while (!__atomic_compare_exchange_n(&eng->pending, &p, p + 1, 0,
+		__ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+	job->done = done;
+	if (job->op == CURVE9767_JOB_VERIFY && eng->batch_min != 0) {
+		queue_push_retry(&eng->vq, job);
+	} else {
+		queue_push_retry(&eng->sq, job);
+	}
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&eng->sleepers, __ATOMIC_SEQ_CST) != 0) {
+		pthread_mutex_lock(&eng->lock);
+		pthread_cond_signal(&eng->cond);
+		pthread_mutex_unlock(&eng->lock);
+	}
+	return 1;
+}
+
+/* see curve9767.h */
+curve9767_job *
+curve9767_engine_poll(curve9767_engine *eng)
+{
+	curve9767_job *job;
+
+	job = queue_pop(&eng->cq);
+	if (job != NULL) {
+		__atomic_sub_fetch(&eng->pending, 1, __ATOMIC_RELEASE);
+	}
+	return job;
+}
+
+/* see curve9767.h */
+void
+curve9767_engine_free(curve9767_engine *eng)
+{
+	unsigned u;
+
+	if (eng == NULL) {
+		return;
+	}
+	__atomic_store_n(&eng->stop, 1, __ATOMIC_RELEASE);
+	wake_all(eng);
+	for (u = 0; u < eng->num_threads; u ++) {
+		pthread_join(eng->th[u], NULL);
+	}
+	pthread_mutex_destroy(&eng->lock);
+	pthread_cond_destroy(&eng->cond);
+	free(eng->sq.buf);
+	free(eng->th);
+	free(eng);
+}
+
+/* see curve9767.h */
+void
+curve9767_job_keygen(curve9767_job *job,
+	curve9767_scalar *s, uint8_t t[32], curve9767_point *Q,
+	const void *seed, size_t seed_len)
+{
+	memset(job, 0, sizeof *job);
+	job->op = CURVE9767_JOB_KEYGEN;
+	job->s_out = s;
+	job->t_out = t;
+	job->Q_out = Q;
+	job->in = seed;
+	job->in_len = seed_len;
+}
+
+/* see curve9767.h */
+void
+curve9767_job_ecdh_keygen(curve9767_job *job,
+	curve9767_scalar *s, uint8_t encoded_Q[32],
+	const void *seed, size_t seed_len)
+{
+	memset(job, 0, sizeof *job);
+	job->op = CURVE9767_JOB_ECDH_KEYGEN;
+	job->s_out = s;
+	job->enc_out = encoded_Q;
+	job->in = seed;
+	job->in_len = seed_len;
+}
+
+/* see curve9767.h */
+void
+curve9767_job_ecdh_recv(curve9767_job *job,
+	void *shared_secret, size_t shared_secret_len,
+	const curve9767_scalar *s, const uint8_t encoded_Q2[32])
+{
+	memset(job, 0, sizeof *job);
+	job->op = CURVE9767_JOB_ECDH_RECV;
+	job->out = shared_secret;
+	job->out_len = shared_secret_len;
+	job->s = s;
+	job->in = encoded_Q2;
+	job->in_len = 32;
+}
+
+/* see curve9767.h */
+void
+curve9767_job_sign(curve9767_job *job, void *sig,
+	const curve9767_scalar *s, const uint8_t t[32],
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	memset(job, 0, sizeof *job);
+	job->op = CURVE9767_JOB_SIGN;
+	job->out = sig;
+	job->out_len = 64;
+	job->s = s;
+	job->t = t;
+	job->Q = Q;
+	job->hash_oid = hash_oid;
+	job->hv = hv;
+	job->hv_len = hv_len;
+}
+
+/* see curve9767.h */
+void
+curve9767_job_verify(curve9767_job *job, const void *sig,
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	memset(job, 0, sizeof *job);
+	job->op = CURVE9767_JOB_VERIFY;
+	job->in = sig;
+	job->in_len = 64;
+	job->Q = Q;
+	job->hash_oid = hash_oid;
+	job->hv = hv;
+	job->hv_len = hv_len;
+}
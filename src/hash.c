@@ -22,3 +22,19 @@ curve9767_hash_to_curve(curve9767_point *Q, shake_context *sc)
 	curve9767_inner_Icart_map(&T, u.v);
 	curve9767_point_add(Q, Q, &T);
 }
+
+/* see curve9767.h */
+void
+curve9767_encode_to_curve(curve9767_point *Q, shake_context *sc)
+{
+	/*
+	 * A single 48-byte seed is mapped to a field element, then to
+	 * a curve point with Icart's map.
+	 */
+	uint8_t seed[48];
+	field_element u;
+
+	shake_extract(sc, seed, sizeof seed);
+	curve9767_inner_gf_map_to_base(u.v, seed);
+	curve9767_inner_Icart_map(Q, u.v);
+}
@@ -3,6 +3,82 @@
 
 #include "curve9767.h"
 
+/* ==================================================================== */
+/*
+ * Operation counters (see curve9767_stats in curve9767.h). When
+ * CURVE9767_STATS is defined to a non-zero value at compile time, the
+ * field and scalar primitives increment per-thread counters; otherwise,
+ * the macros below compile to nothing.
+ */
+
+#ifndef CURVE9767_STATS
+#define CURVE9767_STATS   0
+#endif
+
+/*
+ * Counters are stored in an array indexed by the CURVE9767_STAT_*
+ * constants (one per field of curve9767_stats, in the same order). The
+ * counter name is pasted onto the prefix, so that it is not subject to
+ * macro expansion (the ops_*.c files define gf_* macros that would
+ * otherwise clash with the counter names).
+ */
+enum {
+	CURVE9767_STAT_gf_add,
+	CURVE9767_STAT_gf_sub,
+	CURVE9767_STAT_gf_neg,
+	CURVE9767_STAT_gf_mul,
+	CURVE9767_STAT_gf_sqr,
+	CURVE9767_STAT_gf_mul_const,
+	CURVE9767_STAT_gf_frob,
+	CURVE9767_STAT_gf_inv,
+	CURVE9767_STAT_gf_sqrt,
+	CURVE9767_STAT_gf_cubert,
+	CURVE9767_STAT_scalar_add,
+	CURVE9767_STAT_scalar_mul,
+	CURVE9767_STAT_scalar_reduce,
+	CURVE9767_STAT_scalar_reduce_basis,
+	CURVE9767_STAT_NUM
+};
+
+#if CURVE9767_STATS
+#if defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+#define CURVE9767_TLS   _Thread_local
+#else
+#define CURVE9767_TLS   __thread
+#endif
+extern CURVE9767_TLS uint64_t curve9767_inner_stats[CURVE9767_STAT_NUM];
+#define CURVE9767_STATS_INC(name) \
+	(curve9767_inner_stats[CURVE9767_STAT_ ## name] ++)
+#define CURVE9767_STATS_ADD(name, n) \
+	(curve9767_inner_stats[CURVE9767_STAT_ ## name] += (n))
+#else
+#define CURVE9767_STATS_INC(name)      ((void)0)
+#define CURVE9767_STATS_ADD(name, n)   ((void)0)
+#endif
+
+/* ==================================================================== */
+/*
+ * Low-RAM profile. When CURVE9767_LOWRAM is defined to a non-zero value
+ * at compile time, the generic point multiplication routines use
+ * smaller windows, trading some speed for stack space:
+ *
+ *  - curve9767_point_mul() and curve9767_point_mul_mulgen_add() use a
+ *    3-bit signed window (4 points, 320 bytes) instead of a 4-bit one
+ *    (8 points, 640 bytes); this adds 21 point additions per scalar.
+ *
+ *  - curve9767_inner_mul2_mulgen_add_vartime() (signature verification)
+ *    uses NAF_3 instead of NAF_4 for the two 128-bit multipliers, with
+ *    two-point windows instead of four-point windows (336 bytes saved);
+ *    this adds about 6 point additions per multiplier, on average.
+ *
+ * Only the portable C (ops_ref.c) and ARM (ops_arm.c) implementations
+ * support this profile.
+ */
+
+#ifndef CURVE9767_LOWRAM
+#define CURVE9767_LOWRAM   0
+#endif
+
 /* ==================================================================== */
 /*
  * Scalar functions (modulo curve order n).
@@ -133,6 +209,40 @@ uint32_t curve9767_inner_gf_sqrt(uint16_t *c, const uint16_t *a);
  */
 #define curve9767_inner_gf_is_qr(a)   curve9767_inner_gf_sqrt(NULL, (a))
 
+/*
+ * Compute c = 1/sqrt(a).
+ *
+ * If a is not a quadratic residue, then this function writes into c an
+ * inverse square root of -a. If a is zero, then c is set to zero. The
+ * inversion shares the exponentiation chain of the square root, which
+ * makes this function substantially cheaper than a call to
+ * curve9767_inner_gf_sqrt() followed by curve9767_inner_gf_inv().
+ * This is a test-only helper: no curve code calls it (point decoding
+ * and Icart's map never need both the square root and the inverse of
+ * the same value). It is exercised by test_curve9767.c and measured by
+ * speed_curve9767.c, for map variants that need square roots of ratios.
+ *
+ * Returned value is 1 if the input was a quadratic residue, 0 otherwise.
+ * Zero is a quadratic residue.
+ */
+uint32_t curve9767_inner_gf_isqrt(uint16_t *c, const uint16_t *a);
+
+/*
+ * Compute c = sqrt(u/v), without a separate inversion of v.
+ *
+ * If u/v is not a quadratic residue, then this function writes into c
+ * one of the square roots of -u/v. If u or v is zero, then c is set to
+ * zero.
+ *
+ * Returned value is 1 if u/v was a quadratic residue, 0 otherwise. If
+ * u or v is zero, then 1 is returned.
+ *
+ * Like curve9767_inner_gf_isqrt(), this is a test-only helper with no
+ * caller in the curve code.
+ */
+uint32_t curve9767_inner_gf_sqrt_ratio(uint16_t *c,
+	const uint16_t *u, const uint16_t *v);
+
 /*
  * Compute the cube root of a, result in c.
  * In the field, every element has a single cube root.
@@ -200,6 +310,28 @@ void curve9767_inner_gf_map_to_base(uint16_t *c, const void *src);
  */
 uint32_t curve9767_inner_make_y(uint16_t *y, const uint16_t *x, uint32_t neg);
 
+/*
+ * Check that the provided coordinates X and Y (normalized, in Montgomery
+ * representation) match the curve equation Y^2 = X^3 - 3*X + B. Returns
+ * 1 if they do, 0 otherwise. This is much cheaper than recomputing Y
+ * with curve9767_inner_make_y(), since no square root is involved.
+ */
+uint32_t curve9767_inner_check_y(const uint16_t *x, const uint16_t *y);
+
+/*
+ * Recode a short scalar for a signed window of w bits (w = 3 to 5): the
+ * scalar s (assumed lower than 2^bitlen) is encoded over 32 bytes into
+ * sb[], and the constant 2^(w-1) is added to each of the num w-bit
+ * chunks, with num = max(2, floor((bitlen + w + 1) / w)). This is an
+ * integer addition (no reduction modulo n), and this value of num
+ * ensures that it does not overflow num*w bits. Returned value is num.
+ * Processing the chunks from the top, with digit e-2^(w-1) for each
+ * chunk value e, yields s*Q as in the generic point multiplication.
+ * If bitlen is greater than 252, then it is replaced with 252.
+ */
+int curve9767_inner_scalar_recode_short(uint8_t *sb,
+	const curve9767_scalar *s, unsigned bitlen, int w);
+
 /*
  * The window contains the X and Y coordinates of eight points,
  * referenced by index (0 to 7); they are internally stored in an
@@ -267,6 +399,32 @@ void curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 	const curve9767_point *Q1, const uint8_t *c1, int neg1,
 	const uint8_t *c2);
 
+/*
+ * Compute Q3 = c_0*P_0 + c_1*P_1 + ... + c_{num-1}*P_{num-1} + c2*G.
+ * The num points P_i are provided in pts[]. Each multiplier c_i is
+ * unsigned, encoded over exactly 32 bytes (unsigned little-endian,
+ * c_i starts at c + 32*i), and less than 2^252. Value c2 uses the same
+ * format; if c2 is NULL, then it is taken to be zero. The number of
+ * points (num) may be zero.
+ *
+ * Points are processed in batches of a few points, each batch sharing
+ * a single doubling chain; stack usage does not depend on num.
+ *
+ * THIS FUNCTION IS NOT CONSTANT-TIME.
+ */
+void curve9767_inner_mulN_mulgen_add_vartime(curve9767_point *Q3,
+	const curve9767_point *pts, const uint8_t *c, size_t num,
+	const uint8_t *c2);
+
+/*
+ * Compute the signature challenge e from the encoded commitment point
+ * c (32 bytes), the public key Q, and the hashed message (defined in
+ * sign.c, also used by sign_agg.c).
+ */
+void curve9767_inner_sign_make_e(curve9767_scalar *e, const uint8_t c[32],
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len);
+
 /* ==================================================================== */
 
 #endif
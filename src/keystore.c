@@ -0,0 +1,217 @@
+#include <stdlib.h>
+
+#include "inner.h"
+
+/*
+ * Store layout (see curve9767.h):
+ *
+ *   offset  size  contents
+ *      0      8   magic "C9767PKS"
+ *      8      4   format version (native-endian uint32, currently 1)
+ *     12      4   byte order marker (native-endian uint32 0x01020304)
+ *     16      4   entry size (native-endian uint32)
+ *     20      4   reserved (zero)
+ *     24      8   number of entries (native-endian uint64)
+ *     32     32   reserved (zero)
+ *     64    ...   entries, sorted by encoded key
+ *
+ * All multi-byte header fields use the native byte order: the store is
+ * meant to be built and used on the same architecture, since entries
+ * contain the in-memory curve9767_point structures, whose contents are
+ * implementation-specific.
+ */
+
+#define KEYSTORE_MAGIC     "C9767PKS"
+#define KEYSTORE_VERSION   1
+#define KEYSTORE_BOM       0x01020304
+
+/*
+ * Comparison function for qsort() and bsearch(): entries are ordered
+ * by encoded key (lexicographic order).
+ */
+static int
+entry_cmp(const void *a, const void *b)
+{
+	return memcmp(a, b, 32);
+}
+
+/*
+ * Check that a stored point matches the provided decoded point. Padding
+ * fields are ignored.
+ */
+static int
+point_equals(const curve9767_point *Q1, const curve9767_point *Q2)
+{
+	return Q1->neutral == Q2->neutral
+		&& memcmp(Q1->x, Q2->x, sizeof Q1->x) == 0
+		&& memcmp(Q1->y, Q2->y, sizeof Q1->y) == 0;
+}
+
+/* see curve9767.h */
+size_t
+curve9767_keystore_size(size_t num)
+{
+	if (num > ((size_t)-1 - CURVE9767_KEYSTORE_HEADER)
+		/ sizeof(curve9767_keystore_entry))
+	{
+		return 0;
+	}
+	return CURVE9767_KEYSTORE_HEADER
+		+ num * sizeof(curve9767_keystore_entry);
+}
+
+/* see curve9767.h */
+int
+curve9767_keystore_build(void *dst, size_t dst_len,
+	const void *encoded_keys, size_t num)
+{
+	uint8_t *buf;
+	const uint8_t *src;
+	curve9767_keystore_entry *e;
+	size_t len, u;
+	uint32_t x32;
+	uint64_t x64;
+
+	buf = dst;
+	if (((uintptr_t)buf & 3) != 0) {
+		return 0;
+	}
+
+	/*
+	 * Clear the header before any other check or modification: if
+	 * dst[] already contains a store, it must not remain openable if
+	 * the build fails.
+	 */
+	if (dst_len >= CURVE9767_KEYSTORE_HEADER) {
+		memset(buf, 0, CURVE9767_KEYSTORE_HEADER);
+	}
+	len = curve9767_keystore_size(num);
+	if (len == 0 || dst_len < len) {
+		return 0;
+	}
+	e = (curve9767_keystore_entry *)(buf + CURVE9767_KEYSTORE_HEADER);
+	src = encoded_keys;
+
+	/*
+	 * Decode all keys. Padding bytes in each entry are cleared so
+	 * that the output is deterministic.
+	 */
+	for (u = 0; u < num; u ++) {
+		curve9767_point Q;
+
+		if (!curve9767_point_decode(&Q, src + (u << 5))) {
+			return 0;
+		}
+		memset(&e[u], 0, sizeof e[u]);
+		memcpy(e[u].encoded, src + (u << 5), 32);
+		e[u].Q.neutral = Q.neutral;
+		memcpy(e[u].Q.x, Q.x, sizeof Q.x);
+		memcpy(e[u].Q.y, Q.y, sizeof Q.y);
+	}
+
+	/*
+	 * Sort entries and reject duplicates.
+	 */
+	if (num > 1) {
+		qsort(e, num, sizeof *e, entry_cmp);
+		for (u = 1; u < num; u ++) {
+			if (entry_cmp(&e[u - 1], &e[u]) == 0) {
+				return 0;
+			}
+		}
+	}
+
+	/*
+	 * Header is written last, so that an interrupted build never
+	 * yields a store that can be opened.
+	 */
+	memcpy(buf, KEYSTORE_MAGIC, 8);
+	x32 = KEYSTORE_VERSION;
+	memcpy(buf + 8, &x32, 4);
+	x32 = KEYSTORE_BOM;
+	memcpy(buf + 12, &x32, 4);
+	x32 = sizeof(curve9767_keystore_entry);
+	memcpy(buf + 16, &x32, 4);
+	x64 = num;
+	memcpy(buf + 24, &x64, 8);
+	return 1;
+}
+
+/* see curve9767.h */
+int
+curve9767_keystore_open(curve9767_keystore *ks, const void *data, size_t len)
+{
+	const uint8_t *buf;
+	uint32_t x32;
+	uint64_t x64;
+
+	ks->entries = NULL;
+	ks->num = 0;
+	buf = data;
+	if (len < CURVE9767_KEYSTORE_HEADER || ((uintptr_t)buf & 3) != 0) {
+		return 0;
+	}
+	if (memcmp(buf, KEYSTORE_MAGIC, 8) != 0) {
+		return 0;
+	}
+	memcpy(&x32, buf + 8, 4);
+	if (x32 != KEYSTORE_VERSION) {
+		return 0;
+	}
+	memcpy(&x32, buf + 12, 4);
+	if (x32 != KEYSTORE_BOM) {
+		return 0;
+	}
+	memcpy(&x32, buf + 16, 4);
+	if (x32 != sizeof(curve9767_keystore_entry)) {
+		return 0;
+	}
+	memcpy(&x64, buf + 24, 8);
+	if (x64 != (uint64_t)((len - CURVE9767_KEYSTORE_HEADER)
+		/ sizeof(curve9767_keystore_entry))
+		|| curve9767_keystore_size((size_t)x64) != len)
+	{
+		return 0;
+	}
+	ks->entries = (const curve9767_keystore_entry *)
+		(buf + CURVE9767_KEYSTORE_HEADER);
+	ks->num = (size_t)x64;
+	return 1;
+}
+
+/* see curve9767.h */
+const curve9767_point *
+curve9767_keystore_find(const curve9767_keystore *ks, const void *encoded)
+{
+	const curve9767_keystore_entry *e;
+
+	if (ks->num == 0) {
+		return NULL;
+	}
+	e = bsearch(encoded, ks->entries, ks->num, sizeof *e, entry_cmp);
+	return e == NULL ? NULL : &e->Q;
+}
+
+/* see curve9767.h */
+int
+curve9767_keystore_check(const curve9767_keystore *ks)
+{
+	size_t u;
+
+	for (u = 0; u < ks->num; u ++) {
+		curve9767_point Q;
+
+		if (u > 0 && entry_cmp(&ks->entries[u - 1],
+			&ks->entries[u]) >= 0)
+		{
+			return 0;
+		}
+		if (!curve9767_point_decode(&Q, ks->entries[u].encoded)) {
+			return 0;
+		}
+		if (!point_equals(&Q, &ks->entries[u].Q)) {
+			return 0;
+		}
+	}
+	return 1;
+}
@@ -0,0 +1,446 @@
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "inner.h"
+
+/*
+ * Multi-scalar multiplication with Pippenger's bucket method.
+ *
+ * Each scalar is recoded into signed digits of c bits (digits are in
+ * the -2^(c-1)..+2^(c-1) range). For each window w, the point P_i
+ * (negated if the digit is negative) is added into the bucket for the
+ * absolute value of its digit; the window sum is then:
+ *   W_w = \sum_k k*B_k
+ * which is obtained with a running sum over the buckets. The final
+ * result is the combination of the window sums with c doublings
+ * between consecutive windows.
+ *
+ * The work is split into tasks, each covering one window and one chunk
+ * of the points; threads obtain tasks from a shared counter. Each
+ * thread has its own buckets and scratch memory; task results are
+ * stored separately and combined at the end by the calling thread.
+ *
+ * Additions into the buckets use affine coordinates. Since affine
+ * addition requires an inversion, additions are accumulated into a
+ * batch (with at most one pending addition per bucket) and the
+ * inversions of the whole batch are mutualized with Montgomery's trick
+ * (one inversion and three multiplications per element). Additions
+ * where the bucket is empty, or where both points have the same X
+ * coordinate (doubling or cancellation) are handled directly.
+ */
+
+/*
+ * Number of bits of the scalars (scalars are lower than n < 2^252).
+ */
+#define MSM_SCALAR_BITS   252
+
+/*
+ * Below this number of points, curve9767_inner_mulN_mulgen_add_vartime()
+ * is used.
+ */
+#define MSM_MIN_POINTS    64
+
+/*
+ * Maximum number of pending additions in a batch.
+ */
+#define MSM_BATCH         128
+
+/*
+ * Maximum number of threads.
+ */
+#define MSM_MAX_THREADS   256
+
+/*
+ * Field element with the same layout as the coordinates in
+ * curve9767_point.
+ */
+typedef struct {
+	uint16_t v[20];
+} msm_gf;
+
+typedef struct {
+	const curve9767_point *pts;
+	const int32_t *digits;       /* num * nwin digits, point-major */
+	size_t num, chunk;
+	unsigned c, nwin, nchunks;
+	uint32_t next_task;
+	curve9767_point *results;    /* one per task */
+} msm_ctx;
+
+typedef struct {
+	msm_ctx *ctx;
+	curve9767_point *buckets;
+	uint32_t *stamp;
+	uint32_t batch_id;
+	size_t pnum;
+	uint32_t pidx[MSM_BATCH];
+	curve9767_point padd[MSM_BATCH];
+	msm_gf pacc[MSM_BATCH];
+	int err;
+} msm_worker;
+
+/*
+ * Perform all pending additions into the buckets.
+ */
+static void
+flush_batch(msm_worker *mw)
+{
+	msm_gf d, inv, t, lambda;
+	size_t i, n;
+
+	n = mw->pnum;
+	if (n == 0) {
+		return;
+	}
+
+	/*
+	 * pacc[i] = \prod_{j <= i} (x(P_j) - x(B_j))
+	 */
+	for (i = 0; i < n; i ++) {
+		const curve9767_point *B;
+
+		B = &mw->buckets[mw->pidx[i]];
+		curve9767_inner_gf_sub(d.v, mw->padd[i].x, B->x);
+		if (i == 0) {
+			mw->pacc[0] = d;
+		} else {
+			curve9767_inner_gf_mul(mw->pacc[i].v,
+				mw->pacc[i - 1].v, d.v);
+		}
+	}
+	curve9767_inner_gf_inv(inv.v, mw->pacc[n - 1].v);
+
+	/*
+	 * Process additions in reverse order; inv holds the inverse of
+	 * pacc[i] at the start of each iteration.
+	 */
+	for (i = n; i -- > 0;) {
+		curve9767_point *B;
+		const curve9767_point *P;
+
+		B = &mw->buckets[mw->pidx[i]];
+		P = &mw->padd[i];
+		curve9767_inner_gf_sub(d.v, P->x, B->x);
+		if (i > 0) {
+			curve9767_inner_gf_mul(t.v, inv.v, mw->pacc[i - 1].v);
+			curve9767_inner_gf_mul(inv.v, inv.v, d.v);
+		} else {
+			t = inv;
+		}
+
+		/*
+		 * lambda = (y(P) - y(B)) / (x(P) - x(B))
+		 * x3 = lambda^2 - x(B) - x(P)
+		 * y3 = lambda*(x(B) - x3) - y(B)
+		 */
+		curve9767_inner_gf_sub(d.v, P->y, B->y);
+		curve9767_inner_gf_mul(lambda.v, d.v, t.v);
+		curve9767_inner_gf_sqr(t.v, lambda.v);
+		curve9767_inner_gf_sub(t.v, t.v, B->x);
+		curve9767_inner_gf_sub(t.v, t.v, P->x);
+		curve9767_inner_gf_sub(d.v, B->x, t.v);
+		curve9767_inner_gf_mul(d.v, lambda.v, d.v);
+		curve9767_inner_gf_sub(B->y, d.v, B->y);
+		memcpy(B->x, t.v, sizeof B->x);
+	}
+	mw->pnum = 0;
+	mw->batch_id ++;
+}
+
+/*
+ * Add point P (negated if neg != 0) into bucket k.
+ */
+static void
+bucket_add(msm_worker *mw, uint32_t k, const curve9767_point *P, int neg)
+{
+	curve9767_point *B;
+	curve9767_point T;
+
+	B = &mw->buckets[k];
+	if (mw->stamp[k] == mw->batch_id) {
+		flush_batch(mw);
+	}
+	T = *P;
+	if (neg) {
+		curve9767_point_neg(&T, &T);
+	}
+	if (B->neutral) {
+		*B = T;
+		return;
+	}
+	if (T.neutral) {
+		return;
+	}
+	if (curve9767_inner_gf_eq(B->x, T.x)) {
+		curve9767_point_add(B, B, &T);
+		return;
+	}
+	mw->stamp[k] = mw->batch_id;
+	mw->pidx[mw->pnum] = k;
+	mw->padd[mw->pnum] = T;
+	if (++ mw->pnum == MSM_BATCH) {
+		flush_batch(mw);
+	}
+}
+
+/*
+ * Run one task (window w, chunk j) and return its window sum into R.
+ */
+static void
+run_task(msm_worker *mw, unsigned w, unsigned j, curve9767_point *R)
+{
+	msm_ctx *ctx;
+	curve9767_point S;
+	size_t u, lo, hi, nb;
+
+	ctx = mw->ctx;
+	nb = (size_t)1 << (ctx->c - 1);
+	for (u = 1; u <= nb; u ++) {
+		curve9767_point_set_neutral(&mw->buckets[u]);
+	}
+	lo = (size_t)j * ctx->chunk;
+	hi = lo + ctx->chunk;
+	if (hi > ctx->num) {
+		hi = ctx->num;
+	}
+	for (u = lo; u < hi; u ++) {
+		int32_t d;
+
+		d = ctx->digits[u * ctx->nwin + w];
+		if (d > 0) {
+			bucket_add(mw, (uint32_t)d, &ctx->pts[u], 0);
+		} else if (d < 0) {
+			bucket_add(mw, (uint32_t)-d, &ctx->pts[u], 1);
+		}
+	}
+	flush_batch(mw);
+
+	/*
+	 * R = \sum_k k*B_k, computed as the sum of the running sums
+	 * S_k = B_nb + B_(nb-1) + ... + B_k.
+	 */
+	curve9767_point_set_neutral(&S);
+	curve9767_point_set_neutral(R);
+	for (u = nb; u >= 1; u --) {
+		curve9767_point_add(&S, &S, &mw->buckets[u]);
+		curve9767_point_add(R, R, &S);
+	}
+}
+
+static void *
+msm_thread(void *arg)
+{
+	msm_worker *mw;
+	msm_ctx *ctx;
+	uint32_t num_tasks;
+
+	mw = arg;
+	ctx = mw->ctx;
+	num_tasks = (uint32_t)ctx->nwin * ctx->nchunks;
+	for (;;) {
+		uint32_t t;
+
+		t = __atomic_fetch_add(&ctx->next_task, 1, __ATOMIC_RELAXED);
+		if (t >= num_tasks) {
+			break;
+		}
+		run_task(mw, t / ctx->nchunks, t % ctx->nchunks,
+			&ctx->results[t]);
+	}
+	return NULL;
+}
+
+/*
+ * Recode scalar s into nwin signed digits of c bits each.
+ */
+static void
+recode_signed(int32_t *dd, const curve9767_scalar *s, unsigned c,
+	unsigned nwin)
+{
+	uint8_t buf[36];
+	unsigned w;
+	int32_t carry, half, full;
+
+	curve9767_scalar_encode(buf, s);
+	memset(buf + 32, 0, 4);
+	half = (int32_t)1 << (c - 1);
+	full = (int32_t)1 << c;
+	carry = 0;
+	for (w = 0; w < nwin; w ++) {
+		unsigned off;
+		uint32_t x;
+		int32_t d;
+
+		off = w * c;
+		x = (uint32_t)buf[off >> 3]
+			| ((uint32_t)buf[(off >> 3) + 1] << 8)
+			| ((uint32_t)buf[(off >> 3) + 2] << 16);
+		d = (int32_t)((x >> (off & 7)) & (uint32_t)(full - 1)) + carry;
+		if (d > half) {
+			d -= full;
+			carry = 1;
+		} else {
+			carry = 0;
+		}
+		dd[w] = d;
+	}
+}
+
+/*
+ * Fallback for small inputs (and memory allocation failures).
+ */
+static void
+msm_straus(curve9767_point *Q3, const curve9767_point *pts,
+	const curve9767_scalar *s, size_t num)
+{
+	uint8_t c[MSM_MIN_POINTS * 32];
+	curve9767_point T;
+	size_t u, v, n;
+
+	curve9767_point_set_neutral(Q3);
+	for (v = 0; v < num; v += n) {
+		n = num - v;
+		if (n > MSM_MIN_POINTS) {
+			n = MSM_MIN_POINTS;
+		}
+		for (u = 0; u < n; u ++) {
+			curve9767_scalar_encode(c + (u << 5), &s[v + u]);
+		}
+		curve9767_inner_mulN_mulgen_add_vartime(&T,
+			pts + v, c, n, NULL);
+		curve9767_point_add(Q3, Q3, &T);
+	}
+}
+
+/* see curve9767.h */
+void
+curve9767_point_mulN_vartime(curve9767_point *Q3,
+	const curve9767_point *pts, const curve9767_scalar *s, size_t num,
+	unsigned num_threads)
+{
+	msm_ctx ctx;
+	msm_worker *mw;
+	pthread_t *th;
+	int32_t *digits;
+	unsigned c, nwin, nchunks, t, w;
+	size_t u, nb;
+	int ok;
+
+	if (num < MSM_MIN_POINTS) {
+		msm_straus(Q3, pts, s, num);
+		return;
+	}
+	if (num_threads == 0) {
+		num_threads = 1;
+	}
+	if (num_threads > MSM_MAX_THREADS) {
+		num_threads = MSM_MAX_THREADS;
+	}
+
+	/*
+	 * Window size: about log2(num) - 3 bits, clamped to 4..16.
+	 */
+	c = 0;
+	for (u = num; u > 1; u >>= 1) {
+		c ++;
+	}
+	c = c < 7 ? 4 : c - 3;
+	if (c > 16) {
+		c = 16;
+	}
+	nwin = MSM_SCALAR_BITS / c + 1;
+
+	/*
+	 * Split points into chunks so that there are at least about four
+	 * tasks per thread (when there are enough points).
+	 */
+	nchunks = (4 * num_threads + nwin - 1) / nwin;
+	if ((size_t)nchunks > num / MSM_MIN_POINTS) {
+		nchunks = (unsigned)(num / MSM_MIN_POINTS);
+	}
+	if (nchunks == 0 || num_threads == 1) {
+		nchunks = 1;
+	}
+
+	nb = (size_t)1 << (c - 1);
+	digits = malloc(num * nwin * sizeof *digits);
+	ctx.results = malloc((size_t)nwin * nchunks * sizeof *ctx.results);
+	mw = calloc(num_threads, sizeof *mw);
+	th = malloc(num_threads * sizeof *th);
+	ok = digits != NULL && ctx.results != NULL
+		&& mw != NULL && th != NULL;
+	for (t = 0; ok && t < num_threads; t ++) {
+		mw[t].buckets = malloc((nb + 1) * sizeof *mw[t].buckets);
+		mw[t].stamp = calloc(nb + 1, sizeof *mw[t].stamp);
+		if (mw[t].buckets == NULL || mw[t].stamp == NULL) {
+			ok = 0;
+		}
+	}
+	if (!ok) {
+		msm_straus(Q3, pts, s, num);
+		goto cleanup;
+	}
+
+	for (u = 0; u < num; u ++) {
+		recode_signed(digits + u * nwin, &s[u], c, nwin);
+	}
+	ctx.pts = pts;
+	ctx.digits = digits;
+	ctx.num = num;
+	ctx.chunk = (num + nchunks - 1) / nchunks;
+	ctx.c = c;
+	ctx.nwin = nwin;
+	ctx.nchunks = nchunks;
+	ctx.next_task = 0;
+
+	/*
+	 * The calling thread is worker 0. If a thread cannot be
+	 * started, the remaining tasks are processed by the other
+	 * threads.
+	 */
+	for (t = 0; t < num_threads; t ++) {
+		mw[t].ctx = &ctx;
+		mw[t].batch_id = 1;
+		if (t > 0) {
+			if (pthread_create(&th[t], NULL,
+				msm_thread, &mw[t]) != 0)
+			{
+				mw[t].err = 1;
+			}
+		}
+	}
+	msm_thread(&mw[0]);
+	for (t = 1; t < num_threads; t ++) {
+		if (!mw[t].err) {
+			pthread_join(th[t], NULL);
+		}
+	}
+
+	/*
+	 * Combine the window sums (Horner's rule, from the top window).
+	 */
+	curve9767_point_set_neutral(Q3);
+	for (w = nwin; w -- > 0;) {
+		unsigned j;
+
+		if (!Q3->neutral) {
+			curve9767_point_mul2k(Q3, Q3, c);
+		}
+		for (j = 0; j < nchunks; j ++) {
+			curve9767_point_add(Q3, Q3,
+				&ctx.results[w * nchunks + j]);
+		}
+	}
+
+cleanup:
+	if (mw != NULL) {
+		for (t = 0; t < num_threads; t ++) {
+			free(mw[t].buckets);
+			free(mw[t].stamp);
+		}
+	}
+	free(mw);
+	free(th);
+	free(digits);
+	free(ctx.results);
+}
@@ -216,7 +216,82 @@ mp_tomonty(uint32_t x)
 
 /*
  * Helper macros to get local short names for functions.
+ *
+ * With CURVE9767_STATS, calls from this file go through small wrappers
+ * that increment the operation counters. The assembly routines do not
+ * update the counters themselves, so calls made from assembly code
+ * (e.g. within curve9767_point_add() or curve9767_point_mul2k(), which
+ * are implemented in ops_cm0.s and ops_cm4.s) are not counted.
  */
+#if CURVE9767_STATS
+
+static inline void
+stats_gf_add(uint16_t *c, const uint16_t *a, const uint16_t *b)
+{
+	CURVE9767_STATS_INC(gf_add);
+	curve9767_inner_gf_add(c, a, b);
+}
+
+static inline void
+stats_gf_sub(uint16_t *c, const uint16_t *a, const uint16_t *b)
+{
+	CURVE9767_STATS_INC(gf_sub);
+	curve9767_inner_gf_sub(c, a, b);
+}
+
+static inline void
+stats_gf_neg(uint16_t *c, const uint16_t *a)
+{
+	CURVE9767_STATS_INC(gf_neg);
+	curve9767_inner_gf_neg(c, a);
+}
+
+static inline void
+stats_gf_mul(uint16_t *c, const uint16_t *a, const uint16_t *b)
+{
+	CURVE9767_STATS_INC(gf_mul);
+	curve9767_inner_gf_mul(c, a, b);
+}
+
+static inline void
+stats_gf_sqr(uint16_t *c, const uint16_t *a)
+{
+	CURVE9767_STATS_INC(gf_sqr);
+	curve9767_inner_gf_sqr(c, a);
+}
+
+static inline void
+stats_gf_inv(uint16_t *c, const uint16_t *a)
+{
+	CURVE9767_STATS_INC(gf_inv);
+	curve9767_inner_gf_inv(c, a);
+}
+
+static inline uint32_t
+stats_gf_sqrt(uint16_t *c, const uint16_t *a)
+{
+	CURVE9767_STATS_INC(gf_sqrt);
+	return curve9767_inner_gf_sqrt(c, a);
+}
+
+static inline void
+stats_gf_cubert(uint16_t *c, const uint16_t *a)
+{
+	CURVE9767_STATS_INC(gf_cubert);
+	curve9767_inner_gf_cubert(c, a);
+}
+
+#define gf_add        stats_gf_add
+#define gf_sub        stats_gf_sub
+#define gf_neg        stats_gf_neg
+#define gf_mul        stats_gf_mul
+#define gf_sqr        stats_gf_sqr
+#define gf_inv        stats_gf_inv
+#define gf_sqrt       stats_gf_sqrt
+#define gf_cubert     stats_gf_cubert
+
+#else
+
 #define gf_add        curve9767_inner_gf_add
 #define gf_sub        curve9767_inner_gf_sub
 #define gf_neg        curve9767_inner_gf_neg
@@ -225,6 +300,8 @@ mp_tomonty(uint32_t x)
 #define gf_inv        curve9767_inner_gf_inv
 #define gf_sqrt       curve9767_inner_gf_sqrt
 #define gf_cubert     curve9767_inner_gf_cubert
+
+#endif
 #define gf_eq         curve9767_inner_gf_eq
 #define gf_is_neg     curve9767_inner_gf_is_neg
 
@@ -268,6 +345,41 @@ curve9767_inner_gf_is_neg(const uint16_t *a)
 	return (((P - 1) >> 1) - t) >> 31;
 }
 
+/* see inner.h */
+uint32_t
+curve9767_inner_gf_isqrt(uint16_t *c, const uint16_t *a)
+{
+	/*
+	 * The inversion and square root are implemented in assembly and
+	 * do not expose the intermediate values of their exponentiation
+	 * chains, so we cannot share a single chain here. We compute
+	 * 1/sqrt(a) as sqrt(1/a): this saves the final multiplication,
+	 * and 1/a is a QR if and only if a is a QR.
+	 */
+	field_element t;
+
+	gf_inv(t.v, a);
+	return gf_sqrt(c, t.v);
+}
+
+/* see inner.h */
+uint32_t
+curve9767_inner_gf_sqrt_ratio(uint16_t *c,
+	const uint16_t *u, const uint16_t *v)
+{
+	/*
+	 * sqrt(u/v) = u/sqrt(u*v); moreover, u/v is a QR if and only
+	 * if u*v is a QR.
+	 */
+	field_element t;
+	uint32_t r;
+
+	gf_mul(t.v, u, v);
+	r = curve9767_inner_gf_isqrt(t.v, t.v);
+	gf_mul(c, t.v, u);
+	return r;
+}
+
 /* see inner.h */
 void
 curve9767_inner_gf_encode(void *dst, const uint16_t *a)
@@ -583,6 +695,26 @@ curve9767_inner_make_y(uint16_t *y, const uint16_t *x, uint32_t neg)
 	return r;
 }
 
+/* see inner.h */
+uint32_t
+curve9767_inner_check_y(const uint16_t *x, const uint16_t *y)
+{
+	field_element t1, t2;
+	int i;
+
+	/*
+	 * Compute X^3 - 3*X + B (in t1) and Y^2 (in t2).
+	 */
+	gf_sqr(t1.v, x);
+	gf_mul(t1.v, t1.v, x);
+	for (i = 0; i < 19; i ++) {
+		t1.v[i] = (uint16_t)mp_add(t1.v[i], mp_montymul(x[i], Am));
+	}
+	t1.v[Bi] = mp_add(t1.v[Bi], Bm);
+	gf_sqr(t2.v, y);
+	return gf_eq(t1.v, t2.v);
+}
+
 /* see inner.h */
 void
 curve9767_inner_window_put(window_point8 *window,
@@ -719,58 +851,188 @@ do_lookup(curve9767_point *T, const window_point8 *win, uint32_t e)
 	curve9767_inner_gf_condneg(T->y, r);
 }
 
+#if CURVE9767_LOWRAM
+
+/*
+ * Low-RAM profile (see CURVE9767_LOWRAM in inner.h): point_mul() and
+ * point_mul_mulgen_add() use 3-bit chunks, with a window that contains
+ * only 1*Q1 to 4*Q1. The constant offset is then 0x924...924 (4 in each
+ * 3-bit chunk).
+ */
+static const uint8_t scalar_win3_off[] = {
+	0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49,
+	0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24,
+	0x49, 0x92, 0x24, 0x49, 0x92, 0x24, 0x49, 0x92,
+	0x24, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24, 0x09
+};
+
+/*
+ * Window with four points (non-interleaved coordinates).
+ */
+typedef struct {
+	field_element x[4], y[4];
+} window_point4;
+
+/*
+ * Perform a lookup in a four-point window, based on the value of three
+ * bits, with the conditional negation. The value 'e' MUST be in the 0..7
+ * range. T is set to (e-4)*B, where B is the base point of the window
+ * (the window contains the coordinates of i*B for i in 1..4). As in
+ * do_lookup(), the neutral flag of T is set under the assumption that
+ * B is not the point-at-infinity.
+ */
+static void
+do_lookup3(curve9767_point *T, const window_point4 *win, uint32_t e)
+{
+	uint32_t e4, index, r;
+	int i, k;
+
+	/*
+	 * Set e4 to 1 if e == 4, to 0 otherwise.
+	 */
+	e4 = (e & -e) >> 2;
+
+	/*
+	 * If e >= 5, lookup index must be e - 5.
+	 * If e <= 3, lookup index must be 3 - e.
+	 * If e == 4, lookup index is set to 0.
+	 */
+	index = e - 5;
+	r = index >> 31;
+	index = (index ^ -r) - r;
+	index &= (e4 - 1);
+
+	memset(T->x, 0, sizeof T->x);
+	memset(T->y, 0, sizeof T->y);
+	for (k = 0; k < 4; k ++) {
+		uint32_t m;
+
+		m = index ^ (uint32_t)k;
+		m = ((m | -m) >> 31) - 1;
+		for (i = 0; i < 19; i ++) {
+			T->x[i] |= (uint16_t)(m & win->x[k].v[i]);
+			T->y[i] |= (uint16_t)(m & win->y[k].v[i]);
+		}
+	}
+	T->neutral = e4;
+	curve9767_inner_gf_condneg(T->y, r);
+}
+
+/*
+ * Fill a four-point window with j*Q1 (for j = 1..4).
+ */
+static void
+make_window3(window_point4 *win, const curve9767_point *Q1)
+{
+	curve9767_point T;
+	int i;
+
+	T = *Q1;
+	for (i = 0; i < 4; i ++) {
+		if (i != 0) {
+			curve9767_point_add(&T, &T, Q1);
+		}
+		memcpy(win->x[i].v, T.x, sizeof T.x);
+		memcpy(win->y[i].v, T.y, sizeof T.y);
+	}
+}
+
+/*
+ * Get the 3-bit chunk of index i (0 to 83) from an encoded scalar.
+ */
+static inline uint32_t
+get_chunk3(const uint8_t *sb, int i)
+{
+	uint32_t x;
+	int j;
+
+	j = 3 * i;
+	x = sb[j >> 3];
+	if ((j >> 3) < 31) {
+		x |= (uint32_t)sb[(j >> 3) + 1] << 8;
+	}
+	return (x >> (j & 7)) & 0x07;
+}
+
+/*
+ * Point multiplication core, with the scalar recoded into num 3-bit
+ * chunks in sb[] (offset already applied).
+ */
+static void
+point_mul_chunks3(curve9767_point *Q3, const curve9767_point *Q1,
+	const uint8_t *sb, int num)
+{
+	curve9767_point T;
+	window_point4 window;
+	int i;
+	uint32_t qz;
+
+	make_window3(&window, Q1);
+
+	qz = Q1->neutral;
+	for (i = 0; i < num; i ++) {
+		do_lookup3(&T, &window, get_chunk3(sb, num - 1 - i));
+		T.neutral |= qz;
+		if (i == 0) {
+			*Q3 = T;
+		} else {
+			curve9767_point_mul2k(Q3, Q3, 3);
+			curve9767_point_add(Q3, Q3, &T);
+		}
+	}
+}
+
 /* see curve9767.h */
 void
 curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	const curve9767_scalar *s)
 {
 	/*
-	 * Algorithm:
-	 *
-	 *  - We use a window optimization: we precompute small multiples
-	 *    of Q1, and add one such small multiple every four doublings.
-	 *
-	 *  - We store only 1*Q1, 2*Q1,... 8*Q1. The point to add will
-	 *    be either one of these points, or the opposite of one of
-	 *    these points. This "shifts" the window, and must be
-	 *    counterbalanced by a constant offset applied to the scalar.
-	 *
-	 * Therefore:
-	 *
-	 *  1. Add 0x8888...888 to the scalar s, and normalize it to 0..n-1
-	 *     (we do this by encoding the scalar to bytes).
-	 *  2. Compute the window: j*Q1 (for j = 1..8).
-	 *  3. Start with point Q3 = 0.
-	 *  4. For i in 0..62:
-	 *      - Compute Q3 <- 16*Q3
-	 *      - Let e = bits[(248-4*i)..(251-4*i)] of s
-	 *      - Let: T = -(8-e)*Q1  if 0 <= e <= 7
-	 *             T = 0          if e == 8
-	 *             T = (e-8)*Q1   if 9 <= e <= 15
-	 *      - Compute Q3 <- Q3 + T
-	 *
-	 * All lookups should be done in constant-time, as well as additions
-	 * and conditional negation of T.
-	 *
-	 * For the first iteration (i == 0), since Q3 is still 0 at that
-	 * point, we can omit the multiplication by 16 and the addition,
-	 * and simply set Q3 to T.
+	 * Same algorithm as in the default profile, with 3-bit chunks:
+	 * 84 iterations, each with 3 doublings and one addition of
+	 * T = (e-4)*Q1.
 	 */
 	curve9767_scalar ss;
 	uint8_t sb[32];
-	curve9767_point T;
-	window_point8 window;
-	int i;
-	uint32_t qz;
 
-	/*
-	 * Apply offset on the scalar and encode it into bytes. This
-	 * involves normalization to 0..n-1.
-	 */
 	curve9767_scalar_decode_strict(&ss,
-		scalar_win4_off, sizeof scalar_win4_off);
+		scalar_win3_off, sizeof scalar_win3_off);
 	curve9767_scalar_add(&ss, &ss, s);
 	curve9767_scalar_encode(sb, &ss);
+	point_mul_chunks3(Q3, Q1, sb, 84);
+}
+
+/* see curve9767.h */
+void
+curve9767_point_mul_short(curve9767_point *Q3,
+	const curve9767_point *Q1, const curve9767_scalar *s, unsigned bitlen)
+{
+	uint8_t sb[32];
+	int num;
+
+	num = curve9767_inner_scalar_recode_short(sb, s, bitlen, 3);
+	if (num >= 84) {
+		curve9767_point_mul(Q3, Q1, s);
+	} else {
+		point_mul_chunks3(Q3, Q1, sb, num);
+	}
+}
+
+#else
+
+/*
+ * Point multiplication core: the scalar has been recoded into num
+ * 4-bit chunks in sb[] (little-endian), with the window offset (8 in
+ * each chunk) already applied. See curve9767_point_mul() for details.
+ */
+static void
+point_mul_chunks(curve9767_point *Q3, const curve9767_point *Q1,
+	const uint8_t *sb, int num)
+{
+	curve9767_point T;
+	window_point8 window;
+	int i;
+	uint32_t qz;
 
 	/*
 	 * Create window contents.
@@ -787,13 +1049,15 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	 * Perform the chunk-by-chunk computation.
 	 */
 	qz = Q1->neutral;
-	for (i = 0; i < 63; i ++) {
+	for (i = 0; i < num; i ++) {
 		uint32_t e;
+		int j;
 
 		/*
 		 * Extract exponent bits.
 		 */
-		e = (sb[(62 - i) >> 1] >> (((62 - i) & 1) << 2)) & 0x0F;
+		j = num - 1 - i;
+		e = (sb[j >> 1] >> ((j & 1) << 2)) & 0x0F;
 
 		/*
 		 * Window lookup. Don't forget to adjust the neutral flag
@@ -817,6 +1081,80 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	}
 }
 
+/* see curve9767.h */
+void
+curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
+	const curve9767_scalar *s)
+{
+	/*
+	 * Algorithm:
+	 *
+	 *  - We use a window optimization: we precompute small multiples
+	 *    of Q1, and add one such small multiple every four doublings.
+	 *
+	 *  - We store only 1*Q1, 2*Q1,... 8*Q1. The point to add will
+	 *    be either one of these points, or the opposite of one of
+	 *    these points. This "shifts" the window, and must be
+	 *    counterbalanced by a constant offset applied to the scalar.
+	 *
+	 * Therefore:
+	 *
+	 *  1. Add 0x8888...888 to the scalar s, and normalize it to 0..n-1
+	 *     (we do this by encoding the scalar to bytes).
+	 *  2. Compute the window: j*Q1 (for j = 1..8).
+	 *  3. Start with point Q3 = 0.
+	 *  4. For i in 0..62:
+	 *      - Compute Q3 <- 16*Q3
+	 *      - Let e = bits[(248-4*i)..(251-4*i)] of s
+	 *      - Let: T = -(8-e)*Q1  if 0 <= e <= 7
+	 *             T = 0          if e == 8
+	 *             T = (e-8)*Q1   if 9 <= e <= 15
+	 *      - Compute Q3 <- Q3 + T
+	 *
+	 * All lookups should be done in constant-time, as well as additions
+	 * and conditional negation of T.
+	 *
+	 * For the first iteration (i == 0), since Q3 is still 0 at that
+	 * point, we can omit the multiplication by 16 and the addition,
+	 * and simply set Q3 to T.
+	 */
+	curve9767_scalar ss;
+	uint8_t sb[32];
+
+	/*
+	 * Apply offset on the scalar and encode it into bytes. This
+	 * involves normalization to 0..n-1.
+	 */
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win4_off, sizeof scalar_win4_off);
+	curve9767_scalar_add(&ss, &ss, s);
+	curve9767_scalar_encode(sb, &ss);
+	point_mul_chunks(Q3, Q1, sb, 63);
+}
+
+/* see curve9767.h */
+void
+curve9767_point_mul_short(curve9767_point *Q3,
+	const curve9767_point *Q1, const curve9767_scalar *s, unsigned bitlen)
+{
+	uint8_t sb[32];
+	int num;
+
+	/*
+	 * Same algorithm as curve9767_point_mul(), with fewer chunks.
+	 * The recoded scalar is not reduced modulo n, hence a full-size
+	 * scalar must go through the generic function.
+	 */
+	num = curve9767_inner_scalar_recode_short(sb, s, bitlen, 4);
+	if (num >= 63) {
+		curve9767_point_mul(Q3, Q1, s);
+	} else {
+		point_mul_chunks(Q3, Q1, sb, num);
+	}
+}
+
+#endif
+
 /* see curve9767.h */
 void
 curve9767_point_mulgen(curve9767_point *Q3, const curve9767_scalar *s)
@@ -887,6 +1225,54 @@ curve9767_point_mulgen(curve9767_point *Q3, const curve9767_scalar *s)
 	}
 }
 
+#if CURVE9767_LOWRAM
+
+/* see curve9767.h */
+void
+curve9767_point_mul_mulgen_add(curve9767_point *Q3,
+	const curve9767_point *Q1, const curve9767_scalar *s1,
+	const curve9767_scalar *s2)
+{
+	/*
+	 * Both scalars use 3-bit chunks. For G, the 4-bit precomputed
+	 * window (in ROM) is used: do_lookup() with e+4 yields (e-4)*G.
+	 */
+	curve9767_scalar ss;
+	uint8_t sb1[32], sb2[32];
+	curve9767_point T;
+	window_point4 window;
+	int i;
+	uint32_t qz;
+
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win3_off, sizeof scalar_win3_off);
+	curve9767_scalar_add(&ss, &ss, s1);
+	curve9767_scalar_encode(sb1, &ss);
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win3_off, sizeof scalar_win3_off);
+	curve9767_scalar_add(&ss, &ss, s2);
+	curve9767_scalar_encode(sb2, &ss);
+
+	make_window3(&window, Q1);
+
+	qz = Q1->neutral;
+	for (i = 0; i < 84; i ++) {
+		do_lookup3(&T, &window, get_chunk3(sb1, 83 - i));
+		T.neutral |= qz;
+		if (i == 0) {
+			*Q3 = T;
+		} else {
+			curve9767_point_mul2k(Q3, Q3, 3);
+			curve9767_point_add(Q3, Q3, &T);
+		}
+		do_lookup(&T, &curve9767_inner_window_G,
+			get_chunk3(sb2, 83 - i) + 4);
+		curve9767_point_add(Q3, Q3, &T);
+	}
+}
+
+#else
+
 /* see curve9767.h */
 void
 curve9767_point_mul_mulgen_add(curve9767_point *Q3,
@@ -954,6 +1340,142 @@ curve9767_point_mul_mulgen_add(curve9767_point *Q3,
 	}
 }
 
+#endif
+
+#if CURVE9767_LOWRAM
+
+/* see curve9767.h */
+void
+curve9767_point_mul2_add(curve9767_point *Q3,
+	const curve9767_point *P1, const curve9767_scalar *s1,
+	const curve9767_point *P2, const curve9767_scalar *s2)
+{
+	/*
+	 * Same as curve9767_point_mul_mulgen_add(), with a computed
+	 * window for P2 instead of the precomputed window for G.
+	 */
+	curve9767_scalar ss;
+	uint8_t sb1[32], sb2[32];
+	curve9767_point T;
+	window_point4 win1, win2;
+	int i;
+	uint32_t qz1, qz2;
+
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win3_off, sizeof scalar_win3_off);
+	curve9767_scalar_add(&ss, &ss, s1);
+	curve9767_scalar_encode(sb1, &ss);
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win3_off, sizeof scalar_win3_off);
+	curve9767_scalar_add(&ss, &ss, s2);
+	curve9767_scalar_encode(sb2, &ss);
+
+	make_window3(&win1, P1);
+	make_window3(&win2, P2);
+
+	qz1 = P1->neutral;
+	qz2 = P2->neutral;
+	for (i = 0; i < 84; i ++) {
+		do_lookup3(&T, &win1, get_chunk3(sb1, 83 - i));
+		T.neutral |= qz1;
+		if (i == 0) {
+			*Q3 = T;
+		} else {
+			curve9767_point_mul2k(Q3, Q3, 3);
+			curve9767_point_add(Q3, Q3, &T);
+		}
+		do_lookup3(&T, &win2, get_chunk3(sb2, 83 - i));
+		T.neutral |= qz2;
+		curve9767_point_add(Q3, Q3, &T);
+	}
+}
+
+#else
+
+/*
+ * Fill a window with j*Q (for j = 1..8).
+ */
+static void
+make_window4(window_point8 *win, const curve9767_point *Q)
+{
+	curve9767_point T;
+	int i;
+
+	T = *Q;
+	for (i = 1; i <= 8; i ++) {
+		if (i != 1) {
+			curve9767_point_add(&T, &T, Q);
+		}
+		curve9767_inner_window_put(win, &T, i - 1);
+	}
+}
+
+/* see curve9767.h */
+void
+curve9767_point_mul2_add(curve9767_point *Q3,
+	const curve9767_point *P1, const curve9767_scalar *s1,
+	const curve9767_point *P2, const curve9767_scalar *s2)
+{
+	/*
+	 * Same as curve9767_point_mul_mulgen_add(), with a computed
+	 * window for P2 instead of the precomputed window for G: the
+	 * doublings are shared, and each 4-bit chunk entails two
+	 * window lookups and point additions.
+	 */
+	curve9767_scalar ss;
+	uint8_t sb1[32], sb2[32];
+	curve9767_point T;
+	window_point8 win1, win2;
+	int i;
+	uint32_t qz1, qz2;
+
+	/*
+	 * Apply offset on both scalars and encode them into bytes. This
+	 * involves normalization to 0..n-1.
+	 */
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win4_off, sizeof scalar_win4_off);
+	curve9767_scalar_add(&ss, &ss, s1);
+	curve9767_scalar_encode(sb1, &ss);
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win4_off, sizeof scalar_win4_off);
+	curve9767_scalar_add(&ss, &ss, s2);
+	curve9767_scalar_encode(sb2, &ss);
+
+	/*
+	 * Create window contents. The neutral flags are read before
+	 * the loop, since Q3 may be the same structure as P1 or P2.
+	 */
+	make_window4(&win1, P1);
+	make_window4(&win2, P2);
+	qz1 = P1->neutral;
+	qz2 = P2->neutral;
+
+	/*
+	 * Perform the chunk-by-chunk computation.
+	 */
+	for (i = 0; i < 63; i ++) {
+		uint32_t e;
+
+		e = (sb1[(62 - i) >> 1] >> (((62 - i) & 1) << 2)) & 0x0F;
+		do_lookup(&T, &win1, e);
+		T.neutral |= qz1;
+		if (i == 0) {
+			*Q3 = T;
+		} else {
+			curve9767_point_mul2k(Q3, Q3, 4);
+			curve9767_point_add(Q3, Q3, &T);
+		}
+
+		e = (sb2[(62 - i) >> 1] >> (((62 - i) & 1) << 2)) & 0x0F;
+		do_lookup(&T, &win2, e);
+		T.neutral |= qz2;
+		curve9767_point_add(Q3, Q3, &T);
+	}
+}
+
+#endif
+
 /*
  * Input: c is a 128-bit signed integer, in signed little-endian encoding
  * (16 bytes).
@@ -1016,6 +1538,20 @@ prepare_recode_NAF(uint8_t *rcbf, const uint8_t *c, size_t len, int w)
 	}
 }
 
+/*
+ * NAF_w width for the two 128-bit multipliers in
+ * curve9767_inner_mul2_mulgen_add_vartime(); the window for each point
+ * contains MUL2_WIN points (odd multiples 1, 3,... of the point).
+ */
+#if CURVE9767_LOWRAM
+#define MUL2_NAF_W   3
+#else
+#define MUL2_NAF_W   4
+#endif
+#define MUL2_WIN     (1 << (MUL2_NAF_W - 2))
+#define MUL2_MASK    ((1u << MUL2_NAF_W) - 1u)
+#define MUL2_NEG     (1u << (MUL2_NAF_W - 1))
+
 static const field_element window_odd5_G[] = {
 	/* 1 */
 	{ { 9767, 9767, 9767, 9767, 9767, 9767, 9767, 9767, 9767, 9767,
@@ -1118,15 +1654,15 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 	const uint8_t *c2)
 {
 	uint8_t rcbf0[16], rcbf1[16], rcbf2[32];
-	curve9767_point T, W0[4], W1[4];
+	curve9767_point T, W0[MUL2_WIN], W1[MUL2_WIN];
 	int i, dbl;
 	unsigned acc0, acc1, acc2, acc3;
 
 	/*
 	 * Prepare NAF_w recoding of multipliers.
 	 */
-	prepare_recode_NAF(rcbf0, c0, 16, 4);
-	prepare_recode_NAF(rcbf1, c1, 16, 4);
+	prepare_recode_NAF(rcbf0, c0, 16, MUL2_NAF_W);
+	prepare_recode_NAF(rcbf1, c1, 16, MUL2_NAF_W);
 	prepare_recode_NAF(rcbf2, c2, 32, 5);
 
 	/*
@@ -1140,7 +1676,7 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 		curve9767_point_neg(&W0[0], &W0[0]);
 	}
 	curve9767_point_add(&T, &W0[0], &W0[0]);
-	for (i = 1; i < 4; i ++) {
+	for (i = 1; i < MUL2_WIN; i ++) {
 		curve9767_point_add(&W0[i], &W0[i - 1], &T);
 	}
 
@@ -1152,7 +1688,7 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 		curve9767_point_neg(&W1[0], &W1[0]);
 	}
 	curve9767_point_add(&T, &W1[0], &W1[0]);
-	for (i = 1; i < 4; i ++) {
+	for (i = 1; i < MUL2_WIN; i ++) {
 		curve9767_point_add(&W1[i], &W1[i - 1], &T);
 	}
 
@@ -1175,12 +1711,12 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 		dbl ++;
 		s = (i & 7);
 		if (((rcbf0[i >> 3] >> s) & 1) != 0) {
-			m0 = (1u | (acc0 >> s)) & 0x0F;
+			m0 = (1u | (acc0 >> s)) & MUL2_MASK;
 		} else {
 			m0 = 0;
 		}
 		if (((rcbf1[i >> 3] >> s) & 1) != 0) {
-			m1 = (1u | (acc1 >> s)) & 0x0F;
+			m1 = (1u | (acc1 >> s)) & MUL2_MASK;
 		} else {
 			m1 = 0;
 		}
@@ -1210,19 +1746,21 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 		dbl = 0;
 
 		if (m0 != 0) {
-			if (m0 < 0x08) {
+			if ((unsigned)m0 < MUL2_NEG) {
 				curve9767_point_add(Q3, Q3, &W0[m0 >> 1]);
 			} else {
-				curve9767_point_neg(&T, &W0[(16 - m0) >> 1]);
+				curve9767_point_neg(&T,
+					&W0[((int)MUL2_MASK + 1 - m0) >> 1]);
 				curve9767_point_add(Q3, Q3, &T);
 			}
 		}
 
 		if (m1 != 0) {
-			if (m1 < 0x08) {
+			if ((unsigned)m1 < MUL2_NEG) {
 				curve9767_point_add(Q3, Q3, &W1[m1 >> 1]);
 			} else {
-				curve9767_point_neg(&T, &W1[(16 - m1) >> 1]);
+				curve9767_point_neg(&T,
+					&W1[((int)MUL2_MASK + 1 - m1) >> 1]);
 				curve9767_point_add(Q3, Q3, &T);
 			}
 		}
@@ -1265,6 +1803,150 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 	}
 }
 
+/*
+ * Get the non-zero NAF_w digit at position i for the multiplier c[]
+ * (of length len bytes); the position must have been flagged in the
+ * bit field computed by prepare_recode_NAF(). Returned value is the
+ * digit as an unsigned w-bit value: values greater than 2^(w-1) stand
+ * for negative digits (the digit is then the returned value minus 2^w).
+ */
+static inline unsigned
+get_NAF_digit(const uint8_t *c, size_t len, int i, int w)
+{
+	unsigned x;
+	size_t u;
+
+	u = (size_t)i >> 3;
+	x = c[u];
+	if ((u + 1) < len) {
+		x |= (unsigned)c[u + 1] << 8;
+	}
+	return (1u | (x >> (i & 7))) & ((1u << w) - 1u);
+}
+
+/*
+ * Apply the pending doublings (counted in *dbl) to point Q, and reset
+ * the counter.
+ */
+static inline void
+apply_dbl(curve9767_point *Q, int *dbl)
+{
+	if (*dbl > 0) {
+		if (!Q->neutral) {
+			curve9767_point_mul2k(Q, Q, *dbl);
+		}
+		*dbl = 0;
+	}
+}
+
+/*
+ * Number of points that share a doubling chain in
+ * curve9767_inner_mulN_mulgen_add_vartime(). Each point uses a 4-point
+ * window and a 32-byte recoding bit field.
+ */
+#define MULN_BATCH   4
+
+/* see inner.h */
+void
+curve9767_inner_mulN_mulgen_add_vartime(curve9767_point *Q3,
+	const curve9767_point *pts, const uint8_t *c, size_t num,
+	const uint8_t *c2)
+{
+	uint8_t rcbf[MULN_BATCH][32], rcbf2[32];
+	curve9767_point U, T, W[MULN_BATCH][4];
+	size_t u, v, n;
+	int i, j, dbl;
+
+	/*
+	 * The points P_i use NAF_4 multipliers, with windows computed
+	 * on the fly, as in curve9767_inner_mul2_mulgen_add_vartime().
+	 * c2*G uses NAF_5 and the precomputed windows for G and
+	 * (2^128)*G; it is processed along with the first batch.
+	 */
+	if (c2 != NULL) {
+		prepare_recode_NAF(rcbf2, c2, 32, 5);
+	}
+	curve9767_point_set_neutral(Q3);
+	v = 0;
+	do {
+		n = num - v;
+		if (n > MULN_BATCH) {
+			n = MULN_BATCH;
+		}
+
+		/*
+		 * Recode the multipliers of this batch, and make the
+		 * windows: W[u][k] = (2*k+1)*P_{v+u}.
+		 */
+		for (u = 0; u < n; u ++) {
+			prepare_recode_NAF(rcbf[u], c + ((v + u) << 5), 32, 4);
+			W[u][0] = pts[v + u];
+			curve9767_point_add(&T, &W[u][0], &W[u][0]);
+			for (j = 1; j < 4; j ++) {
+				curve9767_point_add(&W[u][j],
+					&W[u][j - 1], &T);
+			}
+		}
+
+		curve9767_point_set_neutral(&U);
+		dbl = 0;
+		for (i = 255; i >= 0; i --) {
+			int s;
+
+			dbl ++;
+			s = i & 7;
+			for (u = 0; u < n; u ++) {
+				unsigned m;
+
+				if (((rcbf[u][i >> 3] >> s) & 1) == 0) {
+					continue;
+				}
+				apply_dbl(&U, &dbl);
+				m = get_NAF_digit(c + ((v + u) << 5), 32, i, 4);
+				if (m < 0x08) {
+					curve9767_point_add(&U, &U,
+						&W[u][m >> 1]);
+				} else {
+					curve9767_point_neg(&T,
+						&W[u][(16 - m) >> 1]);
+					curve9767_point_add(&U, &U, &T);
+				}
+			}
+			if (c2 == NULL || i >= 128) {
+				continue;
+			}
+			for (j = 0; j < 2; j ++) {
+				const field_element *win;
+				unsigned m;
+				int k;
+
+				k = i + (j << 7);
+				if (((rcbf2[k >> 3] >> s) & 1) == 0) {
+					continue;
+				}
+				apply_dbl(&U, &dbl);
+				win = (j == 0) ? window_odd5_G : window_odd5_G128;
+				m = get_NAF_digit(c2, 32, k, 5);
+				if (m < 0x10) {
+					memcpy(T.x, win + (m - 1), sizeof T.x);
+					memcpy(T.y, win + m, sizeof T.y);
+				} else {
+					memcpy(T.x, win + (31 - m), sizeof T.x);
+					curve9767_inner_gf_neg(T.y,
+						(win + (32 - m))->v);
+				}
+				T.neutral = 0;
+				curve9767_point_add(&U, &U, &T);
+			}
+		}
+		apply_dbl(&U, &dbl);
+
+		curve9767_point_add(Q3, Q3, &U);
+		c2 = NULL;
+		v += n;
+	} while (v < num);
+}
+
 /* see curve9767.h */
 int
 curve9767_point_verify_mul_mulgen_add_vartime(
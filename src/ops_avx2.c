@@ -335,6 +335,8 @@ vgf_add(vgf *d, const vgf *a, const vgf *b)
 	__m256i p16, t0;
 	__m128i p8, t1;
 
+	CURVE9767_STATS_INC(gf_add);
+
 	p16 = _mm256_set1_epi16(9767);
 	p8 = _mm_set1_epi16(9767);
 	t0 = _mm256_add_epi16(a->u0, b->u0);
@@ -350,6 +352,8 @@ vgf_sub(vgf *d, const vgf *a, const vgf *b)
 	__m256i p16, t0;
 	__m128i t1;
 
+	CURVE9767_STATS_INC(gf_sub);
+
 	p16 = _mm256_set1_epi16(9767);
 	t0 = _mm256_sub_epi16(a->u0, b->u0);
 	t1 = _mm_sub_epi16(a->u1, b->u1);
@@ -366,6 +370,8 @@ vgf_neg(vgf *d, const vgf *a)
 	__m256i p16, t0;
 	__m128i p8, t1;
 
+	CURVE9767_STATS_INC(gf_neg);
+
 	p16 = _mm256_set1_epi16(9767);
 	p8 = _mm_set1_epi16(9767);
 	t0 = _mm256_sub_epi16(p16, a->u0);
@@ -407,6 +413,69 @@ vgf_condneg(vgf *d, const vgf *a, uint32_t ctl)
 #define BCAST32_6   _mm256_set1_epi32(-2139091700)  /* 0x80800D0C */
 #define BCAST32_7   _mm256_set1_epi32(-2139091186)  /* 0x80800F0E */
 
+/*
+ * Apply Montgomery reduction on the a[] words (unreduced coefficients,
+ * 32 bits each, in the layout produced by vgf_mul_noreduce(),
+ * vgf_mul_const_noreduce() and vgf_mulacc_const_noreduce()). Each
+ * coefficient must be in the 1..3654952486 range (see mp_frommonty()).
+ */
+static inline void
+vgf_montyred(vgf *d, const __m256i *a)
+{
+	__m256i d0, d1, d2, p1i_rev, p1i_low, p, one;
+
+	d0 = a[0];
+	d1 = a[1];
+	d2 = a[2];
+
+	/*
+	 * Apply Montgomery reduction.
+	 *
+	 * If p1i = p0:p1, then 32-bit value x0:x1 must first be replaced
+	 * with 16-bit value (((x0*p0) >> 16) + x0*p1 + x1*p0) % 2^16.
+	 */
+	p1i_rev = _mm256_set1_epi32(0x1669D8AF);
+	p1i_low = _mm256_set1_epi32(0x00001669);
+
+	d0 = _mm256_add_epi16(
+		_mm256_mullo_epi16(d0, p1i_rev),
+		_mm256_mulhi_epu16(d0, p1i_low));
+	d1 = _mm256_add_epi16(
+		_mm256_mullo_epi16(d1, p1i_rev),
+		_mm256_mulhi_epu16(d1, p1i_low));
+	d2 = _mm256_add_epi16(
+		_mm256_mullo_epi16(d2, p1i_rev),
+		_mm256_mulhi_epu16(d2, p1i_low));
+
+	/*
+	 * We do the additions in the upper halves of each 32-bit word,
+	 * followed by a right shift, because we want to zero-extend the
+	 * values so that we may use _mm256_packus_epi32().
+	 */
+	d0 = _mm256_add_epi16(d0, _mm256_bslli_epi128(d0, 2));
+	d1 = _mm256_add_epi16(d1, _mm256_bslli_epi128(d1, 2));
+	d2 = _mm256_add_epi16(d2, _mm256_bslli_epi128(d2, 2));
+	d0 = _mm256_srli_epi32(d0, 16);
+	d1 = _mm256_srli_epi32(d1, 16);
+	d2 = _mm256_srli_epi32(d2, 16);
+
+	/*
+	 * Pack the 16-bit values according to our convention.
+	 */
+	d0 = _mm256_packus_epi32(d0, d1);
+	d1 = _mm256_packus_epi32(d2, d2);
+
+	/*
+	 * Finish Montgomery reduction.
+	 */
+	p = _mm256_set1_epi16(9767);
+	one = _mm256_set1_epi16(1);
+
+	d->u0 = _mm256_add_epi16(one, _mm256_mulhi_epu16(d0, p));
+	d->u1 = _mm256_castsi256_si128(
+		_mm256_add_epi16(one, _mm256_mulhi_epu16(d1, p)));
+}
+
 /*
  * There are several possible implementations. The one below represents
  * values in epi32 format (32 bits per element) and uses
@@ -423,12 +492,17 @@ vgf_condneg(vgf *d, const vgf *a, uint32_t ctl)
  * registers), requiring unpacking opcodes (_mm256_unpacklo_epi16() and
  * _mm256_unpackhi_epi16()) whose cost cancel the benfits of the higher
  * multiplication bandwidth.
+ *
+ * vgf_mul_noreduce() computes the product modulo z^19-2 but does not
+ * apply the Montgomery reduction on the coefficients; the unreduced
+ * coefficients (up to 37*p^2 each) are written in d[], in the format
+ * expected by vgf_montyred().
  */
-static void
-vgf_mul(vgf *d, const vgf *a, const vgf *b)
+static inline void
+vgf_mul_noreduce(__m256i *d, const vgf *a, const vgf *b)
 {
 	__m256i c0, c1, c2, d0, d1, d2, d3, d4;
-	__m256i zt3, x, y, p1i_rev, p1i_low, p, one;
+	__m256i zt3, x, y;
 	__m256i t0_8, t4_12, t8_16, t12_20, t16_24, t20_28, t24_32;
 	__m256i t28, t32, t36;
 	__m256i t19_27, t23_31, t35;
@@ -687,52 +761,66 @@ vgf_mul(vgf *d, const vgf *a, const vgf *b)
 	t16_24 = _mm256_add_epi32(t16_24, t35);
 
 	/*
-	 * Result is in t0_8, t4_12 and t16_24; we still need to apply
-	 * Montgomery reduction to the coefficients.
-	 *
-	 * If p1i = p0:p1, then 32-bit value x0:x1 must first be replaced
-	 * with 16-bit value (((x0*p0) >> 16) + x0*p1 + x1*p0) % 2^16.
+	 * Result is in t0_8, t4_12 and t16_24; Montgomery reduction of
+	 * the coefficients is left to the caller.
 	 */
-	p1i_rev = _mm256_set1_epi32(0x1669D8AF);
-	p1i_low = _mm256_set1_epi32(0x00001669);
+	d[0] = t0_8;
+	d[1] = t4_12;
+	d[2] = t16_24;
+}
 
-	t0_8 = _mm256_add_epi16(
-		_mm256_mullo_epi16(t0_8, p1i_rev),
-		_mm256_mulhi_epu16(t0_8, p1i_low));
-	t4_12 = _mm256_add_epi16(
-		_mm256_mullo_epi16(t4_12, p1i_rev),
-		_mm256_mulhi_epu16(t4_12, p1i_low));
-	t16_24 = _mm256_add_epi16(
-		_mm256_mullo_epi16(t16_24, p1i_rev),
-		_mm256_mulhi_epu16(t16_24, p1i_low));
+static void
+vgf_mul(vgf *d, const vgf *a, const vgf *b)
+{
+	__m256i t[3];
 
-	/*
-	 * We do the additions in the upper halves of each 32-bit word,
-	 * followed by a right shift, because we want to zero-extend the
-	 * values so that we may use _mm256_packus_epi32().
-	 */
-	t0_8 = _mm256_add_epi16(t0_8, _mm256_bslli_epi128(t0_8, 2));
-	t4_12 = _mm256_add_epi16(t4_12, _mm256_bslli_epi128(t4_12, 2));
-	t16_24 = _mm256_add_epi16(t16_24, _mm256_bslli_epi128(t16_24, 2));
-	t0_8 = _mm256_srli_epi32(t0_8, 16);
-	t4_12 = _mm256_srli_epi32(t4_12, 16);
-	t16_24 = _mm256_srli_epi32(t16_24, 16);
+	CURVE9767_STATS_INC(gf_mul);
 
-	/*
-	 * Pack the 16-bit values according to our convention.
-	 */
-	t0_8 = _mm256_packus_epi32(t0_8, t4_12);
-	t16_24 = _mm256_packus_epi32(t16_24, t16_24);
+	vgf_mul_noreduce(t, a, b);
+	vgf_montyred(d, t);
+}
 
-	/*
-	 * Finish Montgomery reduction.
-	 */
-	p = _mm256_set1_epi16(9767);
-	one = _mm256_set1_epi16(1);
+/*
+ * Lazy reduction for differences of products: vgf_mul_sub() computes
+ * a*b-c*e with a single Montgomery reduction.
+ *
+ * Unreduced coefficients of each product are up to 37*p^2, so the sum
+ * of two would not fit in the range of mp_frommonty(). We first
+ * partially reduce each unreduced coefficient x by subtracting
+ * K = 175000*p if x >= K; this is done with a subtraction and an
+ * unsigned minimum (if x < K, then x - K wraps around to a value
+ * greater than x). The result is then at most M = 37*p^2 - K =
+ * 186379*p = 1820363693. We then compute x1 + (M+p) - x2, which is in
+ * the p..(2*M+p) range, and thus fits in the range supported by
+ * vgf_montyred().
+ *
+ * This saves one Montgomery reduction and one field subtraction, at
+ * the cost of five cheap operations per word.
+ */
+#define LAZY_K   ((int)175000 * P)
+#define LAZY_M   ((int)186379 * P)
 
-	d->u0 = _mm256_add_epi16(one, _mm256_mulhi_epu16(t0_8, p));
-	d->u1 = _mm256_castsi256_si128(
-		_mm256_add_epi16(one, _mm256_mulhi_epu16(t16_24, p)));
+static void
+vgf_mul_sub(vgf *d, const vgf *a, const vgf *b, const vgf *c, const vgf *e)
+{
+	__m256i t[3], u[3], k, mp;
+	int i;
+
+	CURVE9767_STATS_ADD(gf_mul, 2);
+	CURVE9767_STATS_INC(gf_sub);
+
+	vgf_mul_noreduce(t, a, b);
+	vgf_mul_noreduce(u, c, e);
+	k = _mm256_set1_epi32(LAZY_K);
+	mp = _mm256_set1_epi32(LAZY_M + P);
+	for (i = 0; i < 3; i ++) {
+		__m256i x, y;
+
+		x = _mm256_min_epu32(t[i], _mm256_sub_epi32(t[i], k));
+		y = _mm256_min_epu32(u[i], _mm256_sub_epi32(u[i], k));
+		t[i] = _mm256_sub_epi32(_mm256_add_epi32(x, mp), y);
+	}
+	vgf_montyred(d, t);
 }
 
 /*
@@ -741,12 +829,18 @@ vgf_mul(vgf *d, const vgf *a, const vgf *b)
  * 16x16->32 multiplications, but at the cost of more data movement,
  * especially cross-lane data moves, which are expensive). Best
  * implementation of squaring was less than 5% faster than
- * multiplications. Therefore, we simply use vgf_mul() for squarings.
+ * multiplications. Therefore, we simply use the multiplication code
+ * for squarings.
  */
 static inline void
 vgf_sqr(vgf *d, const vgf *a)
 {
-	vgf_mul(d, a, a);
+	__m256i t[3];
+
+	CURVE9767_STATS_INC(gf_sqr);
+
+	vgf_mul_noreduce(t, a, a);
+	vgf_montyred(d, t);
 }
 
 /*
@@ -810,6 +904,8 @@ vgf_frob(vgf *d, const vgf *a, const frobcoeffs *kf)
 	__m256i a0, p, one;
 	__m128i a1;
 
+	CURVE9767_STATS_INC(gf_frob);
+
 	a0 = a->u0;
 	a1 = a->u1;
 	a0 = _mm256_add_epi16(
@@ -837,6 +933,8 @@ vgf_mul_to_low(const vgf *a, const vgf *b)
 	__m256i a0, b0, c0, d00, d01, e;
 	__m128i a1, b1, c1, zt3, d10, d11, f;
 
+	CURVE9767_STATS_INC(gf_mul);
+
 	/*
 	 * Read values and mask them appropriately to ensure the ignored
 	 * elements are zeros.
@@ -909,6 +1007,8 @@ vgf_mul_const(vgf *d, const vgf *a, uint32_t c)
 	__m128i a1;
 	int16_t c0, c1;
 
+	CURVE9767_STATS_INC(gf_mul_const);
+
 	a0 = a->u0;
 	a1 = a->u1;
 	c *= (uint32_t)P1I;
@@ -942,6 +1042,8 @@ vgf_mul_const_noreduce(__m256i *d, const vgf *a, uint32_t c)
 	int16_t s;
 	__m256i a0, a1, b, t00, t01, t10, t11;
 
+	CURVE9767_STATS_INC(gf_mul_const);
+
 	*(uint16_t *)&s = (uint16_t)c;
 	a0 = a->u0;
 	a1 = _mm256_castsi128_si256(a->u1);
@@ -965,6 +1067,8 @@ vgf_mulacc_const_noreduce(__m256i *d, const vgf *a, uint32_t c)
 	int16_t s;
 	__m256i a0, a1, b, t00, t01, t10, t11;
 
+	CURVE9767_STATS_INC(gf_mul_const);
+
 	*(uint16_t *)&s = (uint16_t)c;
 	a0 = a->u0;
 	a1 = _mm256_castsi128_si256(a->u1);
@@ -978,67 +1082,6 @@ vgf_mulacc_const_noreduce(__m256i *d, const vgf *a, uint32_t c)
 	d[2] = _mm256_add_epi32(d[2], _mm256_unpacklo_epi16(t10, t11));
 }
 
-/*
- * Applying Montgomery reduction on the a[] words (as produced by
- * vgf_mul_const_noreduce() and vgf_mulacc_const_noreduce()).
- */
-static inline void
-vgf_montyred(vgf *d, const __m256i *a)
-{
-	__m256i d0, d1, d2, p1i_rev, p1i_low, p, one;
-
-	d0 = a[0];
-	d1 = a[1];
-	d2 = a[2];
-
-	/*
-	 * Apply Montgomery reduction.
-	 *
-	 * If p1i = p0:p1, then 32-bit value x0:x1 must first be replaced
-	 * with 16-bit value (((x0*p0) >> 16) + x0*p1 + x1*p0) % 2^16.
-	 */
-	p1i_rev = _mm256_set1_epi32(0x1669D8AF);
-	p1i_low = _mm256_set1_epi32(0x00001669);
-
-	d0 = _mm256_add_epi16(
-		_mm256_mullo_epi16(d0, p1i_rev),
-		_mm256_mulhi_epu16(d0, p1i_low));
-	d1 = _mm256_add_epi16(
-		_mm256_mullo_epi16(d1, p1i_rev),
-		_mm256_mulhi_epu16(d1, p1i_low));
-	d2 = _mm256_add_epi16(
-		_mm256_mullo_epi16(d2, p1i_rev),
-		_mm256_mulhi_epu16(d2, p1i_low));
-
-	/*
-	 * We do the additions in the upper halves of each 32-bit word,
-	 * followed by a right shift, because we want to zero-extend the
-	 * values so that we may use _mm256_packus_epi32().
-	 */
-	d0 = _mm256_add_epi16(d0, _mm256_bslli_epi128(d0, 2));
-	d1 = _mm256_add_epi16(d1, _mm256_bslli_epi128(d1, 2));
-	d2 = _mm256_add_epi16(d2, _mm256_bslli_epi128(d2, 2));
-	d0 = _mm256_srli_epi32(d0, 16);
-	d1 = _mm256_srli_epi32(d1, 16);
-	d2 = _mm256_srli_epi32(d2, 16);
-
-	/*
-	 * Pack the 16-bit values according to our convention.
-	 */
-	d0 = _mm256_packus_epi32(d0, d1);
-	d1 = _mm256_packus_epi32(d2, d2);
-
-	/*
-	 * Finish Montgomery reduction.
-	 */
-	p = _mm256_set1_epi16(9767);
-	one = _mm256_set1_epi16(1);
-
-	d->u0 = _mm256_add_epi16(one, _mm256_mulhi_epu16(d0, p));
-	d->u1 = _mm256_castsi256_si128(
-		_mm256_add_epi16(one, _mm256_mulhi_epu16(d1, p)));
-}
-
 /*
  * Multiply input by z^9, with reduction modulo z^19-2, but without
  * modular reduction of coefficients (i.e. coefficients 0..8 in the
@@ -1082,6 +1125,8 @@ vgf_inv(vgf *d, vgf *a)
 	vgf t1, t2;
 	uint32_t y, yi;
 
+	CURVE9767_STATS_INC(gf_inv);
+
 	/* a^(1+p) -> t1 */
 	vgf_frob(&t2, a, &vfrob1);
 	vgf_mul(&t1, &t2, a);
@@ -1128,6 +1173,8 @@ vgf_sqrt(vgf *d, const vgf *a)
 	vgf t1, t2, t3;
 	uint32_t y, yi, r;
 
+	CURVE9767_STATS_INC(gf_sqrt);
+
 	/* a^(1+p^2) -> t1 */
 	vgf_frob(&t2, a, &vfrob2);
 	vgf_mul(&t1, &t2, a);
@@ -1222,11 +1269,106 @@ vgf_sqrt(vgf *d, const vgf *a)
 	return r;
 }
 
+static uint32_t
+vgf_isqrt(vgf *d, const vgf *a)
+{
+	/*
+	 * See curve9767_inner_gf_isqrt() in ops_ref.c for details:
+	 *
+	 *    1/sqrt(a) = ((((a^e)^2)/(a^r))^((p+1)/4))*(a^(r-1))/(a^r)
+	 */
+	vgf t1, t2, t3, t4;
+	uint32_t y, yi, r;
+
+	CURVE9767_STATS_INC(gf_sqrt);
+
+	/* a^(1+p^2) -> t1 */
+	vgf_frob(&t2, a, &vfrob2);
+	vgf_mul(&t1, &t2, a);
+
+	/* a^(1+p^2+p^4+p^6) -> t1 */
+	vgf_frob(&t2, &t1, &vfrob4);
+	vgf_mul(&t1, &t2, &t1);
+
+	/* a^(1+p^2+p^4+p^6+p^8+p^10+p^12+p^14) -> t1 */
+	vgf_frob(&t2, &t1, &vfrob8);
+	vgf_mul(&t1, &t2, &t1);
+
+	/* a^(1+p^2+p^4+p^6+p^8+p^10+p^12+p^14+p^16) = a^d -> t1 */
+	vgf_frob(&t2, &t1, &vfrob2);
+	vgf_mul(&t1, &t2, a);
+
+	/* (a^d)^p = a^f -> t2 */
+	vgf_frob(&t2, &t1, &vfrob1);
+
+	/* (a^f)^p = a^(e-1) -> t1 */
+	vgf_frob(&t1, &t2, &vfrob1);
+
+	/* a^(r-1) = (a^(e-1))*(a^f) -> t4 */
+	vgf_mul(&t4, &t1, &t2);
+
+	/* a^e -> t1 */
+	vgf_mul(&t1, &t1, a);
+
+	/*
+	 * Compute a^r = (a^e)*(a^f) (low coefficient only), its QR
+	 * status, and its inverse.
+	 */
+	y = vgf_mul_to_low(&t1, &t2);
+	r = mp_is_qr(y);
+	yi = mp_inv(y);
+
+	/* x = ((a^e)^2)/(a^r) -> t2 */
+	vgf_sqr(&t1, &t1);
+	vgf_mul_const(&t2, &t1, yi);
+
+	/* x^4 -> t1 */
+	vgf_sqr(&t1, &t2);
+	vgf_sqr(&t1, &t1);
+
+	/* x^5 -> t3 */
+	vgf_mul(&t3, &t1, &t2);
+
+	/* x^9 -> t1 */
+	vgf_mul(&t1, &t1, &t3);
+
+	/* x^18 -> t1 */
+	vgf_sqr(&t1, &t1);
+
+	/* x^19 -> t1 */
+	vgf_mul(&t1, &t1, &t2);
+
+	/* x^(19*64) = x^1216 -> t1 */
+	vgf_sqr(&t1, &t1);
+	vgf_sqr(&t1, &t1);
+	vgf_sqr(&t1, &t1);
+	vgf_sqr(&t1, &t1);
+	vgf_sqr(&t1, &t1);
+	vgf_sqr(&t1, &t1);
+
+	/* x^1221 -> t1 */
+	vgf_mul(&t1, &t1, &t3);
+
+	/* x^2442 = sqrt(a) -> t1 */
+	vgf_sqr(&t1, &t1);
+
+	/* sqrt(a)*(a^(r-1))/(a^r) -> out */
+	vgf_mul(&t1, &t1, &t4);
+	vgf_mul_const(d, &t1, yi);
+
+	/*
+	 * Return the quadratic residue status.
+	 */
+	return r;
+}
+
 static inline void
 vgf_cubert(vgf *d, const vgf *a)
 {
 	vgf t1, t2, t3, t4;
 
+	CURVE9767_STATS_INC(gf_cubert);
+
 	/* a^(1+p^2) -> t1 */
 	vgf_frob(&t2, a, &vfrob2);
 	vgf_mul(&t1, &t2, a);
@@ -1419,13 +1561,47 @@ curve9767_inner_gf_sqrt(uint16_t *c, const uint16_t *a)
 }
 
 /* see inner.h */
-void
-curve9767_inner_gf_cubert(uint16_t *c, const uint16_t *a)
+uint32_t
+curve9767_inner_gf_isqrt(uint16_t *c, const uint16_t *a)
 {
-	vgf vc, va;
+	vgf va, vc;
+	uint32_t r;
 
 	vgf_decode(&va, a);
-	vgf_cubert(&vc, &va);
+	r = vgf_isqrt(&vc, &va);
+	vgf_encode(c, &vc);
+	return r;
+}
+
+/* see inner.h */
+uint32_t
+curve9767_inner_gf_sqrt_ratio(uint16_t *c,
+	const uint16_t *u, const uint16_t *v)
+{
+	/*
+	 * sqrt(u/v) = u/sqrt(u*v); moreover, u/v is a QR if and only
+	 * if u*v is a QR.
+	 */
+	vgf vu, vv, vt;
+	uint32_t r;
+
+	vgf_decode(&vu, u);
+	vgf_decode(&vv, v);
+	vgf_mul(&vt, &vu, &vv);
+	r = vgf_isqrt(&vt, &vt);
+	vgf_mul(&vt, &vt, &vu);
+	vgf_encode(c, &vt);
+	return r;
+}
+
+/* see inner.h */
+void
+curve9767_inner_gf_cubert(uint16_t *c, const uint16_t *a)
+{
+	vgf vc, va;
+
+	vgf_decode(&va, a);
+	vgf_cubert(&vc, &va);
 	vgf_encode(c, &vc);
 }
 
@@ -1801,6 +1977,26 @@ curve9767_inner_make_y(uint16_t *y, const uint16_t *x, uint32_t neg)
 	return r;
 }
 
+/* see inner.h */
+uint32_t
+curve9767_inner_check_y(const uint16_t *x, const uint16_t *y)
+{
+	field_element t1, t2;
+	int i;
+
+	/*
+	 * Compute X^3 - 3*X + B (in t1) and Y^2 (in t2).
+	 */
+	gf_sqr(t1.v, x);
+	gf_mul(t1.v, t1.v, x);
+	for (i = 0; i < 19; i ++) {
+		t1.v[i] = (uint16_t)mp_add(t1.v[i], mp_montymul(x[i], Am));
+	}
+	t1.v[Bi] = mp_add(t1.v[Bi], Bm);
+	gf_sqr(t2.v, y);
+	return gf_eq(t1.v, t2.v);
+}
+
 /*
  * Internal representation of a curve point, using the 'vgf' format for
  * coordinates.
@@ -2118,12 +2314,9 @@ vpoint_mul2k(vpoint *Q3, const vpoint *Q1, unsigned k)
 		vgf_mul(&Z, &Y, &Z);
 
 		/* Y = Y^2
-		   S = Y*X
-		   Y = (Y^2)/2 */
+		   S = Y*X */
 		vgf_sqr(&Y, &Y);
 		vgf_mul(&S, &Y, &X);
-		vgf_sqr(&Y, &Y);
-		vgf_mul_const(&Y, &Y, HALFm);
 
 		/* X = M^2 */
 		vgf_sqr(&X, &M);
@@ -2134,11 +2327,11 @@ vpoint_mul2k(vpoint *Q3, const vpoint *Q1, unsigned k)
 		vgf_sub(&X, &X, &ZZ);
 
 		/* ZZ = S-X
-		   ZZ = ZZ*M
-		   Y = ZZ-Y */
+		   S = Y/2
+		   Y = ZZ*M-Y*S  (i.e. ZZ*M-(Y^2)/2) */
 		vgf_sub(&ZZ, &S, &X);
-		vgf_mul(&ZZ, &ZZ, &M);
-		vgf_sub(&Y, &ZZ, &Y);
+		vgf_mul_const(&S, &Y, HALFm);
+		vgf_mul_sub(&Y, &ZZ, &M, &Y, &S);
 	}
 
 	/*
@@ -3240,79 +3433,16 @@ vpoint_lookup(vpoint *T, const vgf *win, uint32_t e)
 	vgf_condneg(&T->y, &y, r);
 }
 
-/* see curve9767.h */
-void
-curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
-	const curve9767_scalar *s)
+/*
+ * Point multiplication core: the scalar has been recoded into num
+ * 5-bit chunks in sb[] (little-endian), with the window offset (16 in
+ * each chunk) already applied; num must be at least 2, and the recoded
+ * scalar must be lower than n. See curve9767_point_mul() for details.
+ */
+static void
+vpoint_mul_chunks(curve9767_point *Q3, const curve9767_point *Q1,
+	const uint8_t *sb, int num)
 {
-	/*
-	 * Algorithm:
-	 *
-	 *  - We use a window optimization: we precompute small multiples
-	 *    of Q1, and add one such small multiple every four doublings.
-	 *
-	 *  - We store only 1*Q1, 2*Q1,... 16*Q1. The point to add will
-	 *    be either one of these points, or the opposite of one of
-	 *    these points. This "shifts" the window, and must be
-	 *    counterbalanced by a constant offset applied to the scalar.
-	 *
-	 * Therefore:
-	 *
-	 *  1. Add 0x4210842108...210 to the scalar s, and normalize it to
-	 *     0..n-1 (we do this by encoding the scalar to bytes).
-	 *  2. Compute the window: j*Q1 (for j = 1..8).
-	 *  3. Start with point Q3 = 0.
-	 *  4. For i in 0..50:
-	 *      - Compute Q3 <- 32*Q3
-	 *      - Let e = bits[(250-5*i)..(254-5*i)] of s
-	 *      - Let: T = -(16-e)*Q1  if 0 <= e <= 15
-	 *             T = 0           if e == 16
-	 *             T = (e-16)*Q1   if 17 <= e <= 31
-	 *      - Compute Q3 <- Q3 + T
-	 *
-	 * All lookups should be done in constant-time, as well as additions
-	 * and conditional negation of T.
-	 *
-	 * For the first iteration (i == 0), since Q3 is still 0 at that
-	 * point, we can omit the multiplication by 32 and the addition,
-	 * and simply set Q3 to T.
-	 *
-	 * To further speed up processing, we use Jabcobian coordinates
-	 * for the temporary result (Q3). Formulas for point addition
-	 * in Jacobian coordinates are not complete. However, the skewed
-	 * scalar s is normalized (reduced modulo the curve order n), and
-	 * the curve order is prime, which gives us some guarantees:
-	 *
-	 *  - A result of 0 is possible only if the source point is 0
-	 *    and/or the scalar is 0.
-	 *
-	 *  - Suppose that the source point Q is not 0. After j iterations,
-	 *    the current sum is:
-	 *       A = \sum_{i=0}^{j-1} m_i*(2^(5*(j-1-i))*Q
-	 *    where m_0 is the multiplier at the first iteration, and so
-	 *    on. Each m_i is in the -16..+15 range. Therefore, the current
-	 *    sum is k_j*Q for some integer k_j such that:
-	 *       -16*m <= k_j <= +15*m
-	 *    with m = (2^(5*j)-1)/31. The next iteration will compute:
-	 *       32*A + m_j*Q
-	 *    If j <= 49, then |32*k_j| is less than n/6.84, which implies
-	 *    that 32*A cannot be equal to either m_j*Q or -m_j*Q (the
-	 *    current discrete logarithm of A relatively to Q is too low
-	 *    to have reached the "wrap-around" state). Thus, the j+1-th
-	 *    iteration, with m_j != 0, will involve a "true" addition
-	 *    which will not be a doubling or the addition of A with -A.
-	 *
-	 * Therefore, all iterations except the last one can be done without
-	 * hitting a problematic case for the point addition formulas,
-	 * provided that we handle (with conditional copies) the cases of
-	 * A = 0 and m_j = 0.
-	 *
-	 * To handle the possible special cases at the last iteration, we
-	 * simply convert back to affine coordinates and use the generic
-	 * point addition routine for the last addition.
-	 */
-	curve9767_scalar ss;
-	uint8_t sb[32];
 	vpoint T, U;
 	vgf win[32];
 	vgf jX, jY, jZ, one;
@@ -3321,15 +3451,6 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	unsigned eb;
 	int eb_len;
 
-	/*
-	 * Apply offset on the scalar and encode it into bytes. This
-	 * involves normalization to 0..n-1.
-	 */
-	curve9767_scalar_decode_strict(&ss,
-		scalar_win5_off, sizeof scalar_win5_off);
-	curve9767_scalar_add(&ss, &ss, s);
-	curve9767_scalar_encode(sb, &ss);
-
 	/*
 	 * Create window contents.
 	 */
@@ -3362,10 +3483,10 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	 * Perform the chunk-by-chunk computation.
 	 */
 	qz = Q1->neutral;
-	j = 31;
+	j = (5 * num - 1) >> 3;
 	eb = sb[j];
-	eb_len = 7;
-	for (i = 0; i < 51; i ++) {
+	eb_len = 5 * num - (j << 3);
+	for (i = 0; i < num; i ++) {
 		uint32_t e;
 		vgf T1, T2, T3, T4, X3, Y3, Z3;
 		__m256i md0, md1, md2;
@@ -3430,12 +3551,9 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 			vgf_mul(&jZ, &jY, &jZ);
 
 			/* Y = Y^2
-			   S = Y*X
-			   Y = (Y^2)/2 */
+			   S = Y*X */
 			vgf_sqr(&jY, &jY);
 			vgf_mul(&S, &jY, &jX);
-			vgf_sqr(&jY, &jY);
-			vgf_mul_const(&jY, &jY, HALFm);
 
 			/* X = M^2 */
 			vgf_sqr(&jX, &M);
@@ -3446,11 +3564,11 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 			vgf_sub(&jX, &jX, &ZZ);
 
 			/* ZZ = S-X
-			   ZZ = ZZ*M
-			   Y = ZZ-Y */
+			   S = Y/2
+			   Y = ZZ*M-Y*S  (i.e. ZZ*M-(Y^2)/2) */
 			vgf_sub(&ZZ, &S, &jX);
-			vgf_mul(&ZZ, &ZZ, &M);
-			vgf_sub(&jY, &ZZ, &jY);
+			vgf_mul_const(&S, &jY, HALFm);
+			vgf_mul_sub(&jY, &ZZ, &M, &jY, &S);
 		}
 
 		/*
@@ -3459,7 +3577,7 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 		 * and use the generic point addition routine, which
 		 * handles the possible edge cases cleanly.
 		 */
-		if (i == 50) {
+		if (i == num - 1) {
 			vgf_inv(&T1, &jZ);
 			vgf_sqr(&T2, &T1);
 			vgf_mul(&T3, &T1, &T2);
@@ -3520,15 +3638,11 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 		vgf_sub(&X3, &X3, &T1);
 		vgf_sub(&X3, &X3, &T4);
 
-		/* T3 = T3-X3
-		   T3 = T3*T2 */
+		/* T3 = T3-X3 */
 		vgf_sub(&T3, &T3, &X3);
-		vgf_mul(&T3, &T3, &T2);
 
-		/* T4 = T4*Y1
-		   Y3 = T3-T4 */
-		vgf_mul(&T4, &T4, &jY);
-		vgf_sub(&Y3, &T3, &T4);
+		/* Y3 = T3*T2-T4*Y1 */
+		vgf_mul_sub(&Y3, &T3, &T2, &T4, &jY);
 
 		/*
 		 * If rz == 0 and T.neutral == 0: keep (X3:Y3:Z3)
@@ -3582,6 +3696,114 @@ curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
 	}
 }
 
+/* see curve9767.h */
+void
+curve9767_point_mul(curve9767_point *Q3, const curve9767_point *Q1,
+	const curve9767_scalar *s)
+{
+	/*
+	 * Algorithm:
+	 *
+	 *  - We use a window optimization: we precompute small multiples
+	 *    of Q1, and add one such small multiple every four doublings.
+	 *
+	 *  - We store only 1*Q1, 2*Q1,... 16*Q1. The point to add will
+	 *    be either one of these points, or the opposite of one of
+	 *    these points. This "shifts" the window, and must be
+	 *    counterbalanced by a constant offset applied to the scalar.
+	 *
+	 * Therefore:
+	 *
+	 *  1. Add 0x4210842108...210 to the scalar s, and normalize it to
+	 *     0..n-1 (we do this by encoding the scalar to bytes).
+	 *  2. Compute the window: j*Q1 (for j = 1..8).
+	 *  3. Start with point Q3 = 0.
+	 *  4. For i in 0..50:
+	 *      - Compute Q3 <- 32*Q3
+	 *      - Let e = bits[(250-5*i)..(254-5*i)] of s
+	 *      - Let: T = -(16-e)*Q1  if 0 <= e <= 15
+	 *             T = 0           if e == 16
+	 *             T = (e-16)*Q1   if 17 <= e <= 31
+	 *      - Compute Q3 <- Q3 + T
+	 *
+	 * All lookups should be done in constant-time, as well as additions
+	 * and conditional negation of T.
+	 *
+	 * For the first iteration (i == 0), since Q3 is still 0 at that
+	 * point, we can omit the multiplication by 32 and the addition,
+	 * and simply set Q3 to T.
+	 *
+	 * To further speed up processing, we use Jabcobian coordinates
+	 * for the temporary result (Q3). Formulas for point addition
+	 * in Jacobian coordinates are not complete. However, the skewed
+	 * scalar s is normalized (reduced modulo the curve order n), and
+	 * the curve order is prime, which gives us some guarantees:
+	 *
+	 *  - A result of 0 is possible only if the source point is 0
+	 *    and/or the scalar is 0.
+	 *
+	 *  - Suppose that the source point Q is not 0. After j iterations,
+	 *    the current sum is:
+	 *       A = \sum_{i=0}^{j-1} m_i*(2^(5*(j-1-i))*Q
+	 *    where m_0 is the multiplier at the first iteration, and so
+	 *    on. Each m_i is in the -16..+15 range. Therefore, the current
+	 *    sum is k_j*Q for some integer k_j such that:
+	 *       -16*m <= k_j <= +15*m
+	 *    with m = (2^(5*j)-1)/31. The next iteration will compute:
+	 *       32*A + m_j*Q
+	 *    If j <= 49, then |32*k_j| is less than n/6.84, which implies
+	 *    that 32*A cannot be equal to either m_j*Q or -m_j*Q (the
+	 *    current discrete logarithm of A relatively to Q is too low
+	 *    to have reached the "wrap-around" state). Thus, the j+1-th
+	 *    iteration, with m_j != 0, will involve a "true" addition
+	 *    which will not be a doubling or the addition of A with -A.
+	 *
+	 * Therefore, all iterations except the last one can be done without
+	 * hitting a problematic case for the point addition formulas,
+	 * provided that we handle (with conditional copies) the cases of
+	 * A = 0 and m_j = 0.
+	 *
+	 * To handle the possible special cases at the last iteration, we
+	 * simply convert back to affine coordinates and use the generic
+	 * point addition routine for the last addition.
+	 */
+	curve9767_scalar ss;
+	uint8_t sb[32];
+
+	/*
+	 * Apply offset on the scalar and encode it into bytes. This
+	 * involves normalization to 0..n-1.
+	 */
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win5_off, sizeof scalar_win5_off);
+	curve9767_scalar_add(&ss, &ss, s);
+	curve9767_scalar_encode(sb, &ss);
+	vpoint_mul_chunks(Q3, Q1, sb, 51);
+}
+
+/* see curve9767.h */
+void
+curve9767_point_mul_short(curve9767_point *Q3,
+	const curve9767_point *Q1, const curve9767_scalar *s, unsigned bitlen)
+{
+	uint8_t sb[32];
+	int num;
+
+	/*
+	 * Same algorithm as curve9767_point_mul(), with fewer chunks.
+	 * The recoded scalar is not reduced modulo n, hence a full-size
+	 * scalar must go through the generic function. For shorter
+	 * scalars, the intermediate values are even smaller than in the
+	 * generic case, so the Jacobian additions remain safe.
+	 */
+	num = curve9767_inner_scalar_recode_short(sb, s, bitlen, 5);
+	if (num >= 51) {
+		curve9767_point_mul(Q3, Q1, s);
+	} else {
+		vpoint_mul_chunks(Q3, Q1, sb, num);
+	}
+}
+
 /* see curve9767.h */
 void
 curve9767_point_mulgen(curve9767_point *Q3, const curve9767_scalar *s)
@@ -3755,6 +3977,110 @@ curve9767_point_mul_mulgen_add(curve9767_point *Q3,
 	vpoint_encode(Q3, &U);
 }
 
+/*
+ * Fill a window (32 vgf: x and y of j*U for j = 1..16).
+ */
+static void
+vpoint_make_window(vgf *win, const vpoint *U)
+{
+	vpoint T;
+	int i;
+
+	T = *U;
+	win[0] = T.x;
+	win[1] = T.y;
+	for (i = 2; i < 32; i += 2) {
+		vpoint_add(&T, &T, U);
+		win[i + 0] = T.x;
+		win[i + 1] = T.y;
+	}
+}
+
+/* see curve9767.h */
+void
+curve9767_point_mul2_add(curve9767_point *Q3,
+	const curve9767_point *P1, const curve9767_scalar *s1,
+	const curve9767_point *P2, const curve9767_scalar *s2)
+{
+	/*
+	 * Same as curve9767_point_mul_mulgen_add(), with a computed
+	 * window for P2 instead of the precomputed window for G. The
+	 * accumulator uses the complete (affine) addition: with two
+	 * unrelated bases, the intermediate sums cannot be proven to
+	 * avoid the special cases of the Jacobian formulas used in
+	 * curve9767_point_mul().
+	 */
+	curve9767_scalar ss;
+	uint8_t sb1[32], sb2[32];
+	vpoint T, U;
+	vgf win1[32], win2[32];
+	int i, j, eb_len;
+	uint32_t qz1, qz2, eb1, eb2;
+
+	/*
+	 * Apply offset on both scalars and encode them into bytes. This
+	 * involves normalization to 0..n-1.
+	 */
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win5_off, sizeof scalar_win5_off);
+	curve9767_scalar_add(&ss, &ss, s1);
+	curve9767_scalar_encode(sb1, &ss);
+	curve9767_scalar_decode_strict(&ss,
+		scalar_win5_off, sizeof scalar_win5_off);
+	curve9767_scalar_add(&ss, &ss, s2);
+	curve9767_scalar_encode(sb2, &ss);
+
+	/*
+	 * Create window contents.
+	 */
+	vpoint_decode(&U, P1);
+	vpoint_make_window(win1, &U);
+	vpoint_decode(&U, P2);
+	vpoint_make_window(win2, &U);
+	qz1 = P1->neutral;
+	qz2 = P2->neutral;
+
+	/*
+	 * Perform the chunk-by-chunk computation.
+	 */
+	j = 31;
+	eb1 = sb1[j];
+	eb2 = sb2[j];
+	eb_len = 7;
+	for (i = 0; i < 51; i ++) {
+		uint32_t e1, e2;
+
+		/*
+		 * Extract exponent bits.
+		 */
+		if (eb_len < 5) {
+			j --;
+			eb1 = (eb1 << 8) | sb1[j];
+			eb2 = (eb2 << 8) | sb2[j];
+			eb_len += 8;
+		}
+		eb_len -= 5;
+		e1 = (eb1 >> eb_len) & 0x1F;
+		e2 = (eb2 >> eb_len) & 0x1F;
+
+		/*
+		 * U <- 32*U + e1*P1 + e2*P2 (signed digits).
+		 */
+		vpoint_lookup(&T, win1, e1);
+		T.neutral |= qz1;
+		if (i == 0) {
+			U = T;
+		} else {
+			vpoint_mul2k(&U, &U, 5);
+			vpoint_add(&U, &U, &T);
+		}
+		vpoint_lookup(&T, win2, e2);
+		T.neutral |= qz2;
+		vpoint_add(&U, &U, &T);
+	}
+	vpoint_encode(Q3, &U);
+}
+
 /*
  * Input: c is a 128-bit signed integer, in signed little-endian encoding
  * (16 bytes).
@@ -3986,6 +4312,120 @@ curve9767_inner_mul2_mulgen_add_vartime(curve9767_point *Q3,
 	vpoint_encode(Q3, &vQ3);
 }
 
+/*
+ * Number of points that share a doubling chain in
+ * curve9767_inner_mulN_mulgen_add_vartime(). Each point uses an
+ * 8-point window and 256 recoded digits.
+ */
+#define MULN_BATCH   8
+
+/* see inner.h */
+void
+curve9767_inner_mulN_mulgen_add_vartime(curve9767_point *Q3,
+	const curve9767_point *pts, const uint8_t *c, size_t num,
+	const uint8_t *c2)
+{
+	/*
+	 * The points P_i use NAF_5 multipliers, with windows computed
+	 * on the fly, as in mul2_mulgen_add_vartime(). c2*G uses NAF_7
+	 * and the precomputed windows for G and (2^128)*G; it is
+	 * processed along with the first batch.
+	 */
+	int8_t rc[MULN_BATCH][256], rc2[256];
+	vpoint W[MULN_BATCH][8], S, T, U;
+	size_t u, v, n;
+	int i, j, dbl;
+
+	if (c2 != NULL) {
+		recode_NAFw(rc2, c2, 32, 7);
+	}
+	vpoint_set_neutral(&U);
+	v = 0;
+	do {
+		n = num - v;
+		if (n > MULN_BATCH) {
+			n = MULN_BATCH;
+		}
+
+		/*
+		 * Recode the multipliers of this batch, and make the
+		 * windows: W[u][k] = (2*k+1)*P_{v+u}.
+		 */
+		for (u = 0; u < n; u ++) {
+			recode_NAFw(rc[u], c + ((v + u) << 5), 32, 5);
+			vpoint_decode(&W[u][0], &pts[v + u]);
+			vpoint_add(&T, &W[u][0], &W[u][0]);
+			for (j = 1; j < 8; j ++) {
+				vpoint_add(&W[u][j], &W[u][j - 1], &T);
+			}
+		}
+
+		vpoint_set_neutral(&S);
+		dbl = 0;
+		for (i = 255; i >= 0; i --) {
+			dbl ++;
+			for (u = 0; u < n; u ++) {
+				int m;
+
+				m = rc[u][i];
+				if (m == 0) {
+					continue;
+				}
+				if (dbl > 0) {
+					if (!S.neutral) {
+						vpoint_mul2k(&S, &S, dbl);
+					}
+					dbl = 0;
+				}
+				if (m > 0) {
+					vpoint_add(&S, &S, &W[u][m >> 1]);
+				} else {
+					vpoint_neg(&T, &W[u][(-m) >> 1]);
+					vpoint_add(&S, &S, &T);
+				}
+			}
+			if (c2 == NULL || i >= 128) {
+				continue;
+			}
+			for (j = 0; j < 2; j ++) {
+				const vgf *win;
+				int m;
+
+				m = rc2[i + (j << 7)];
+				if (m == 0) {
+					continue;
+				}
+				if (dbl > 0) {
+					if (!S.neutral) {
+						vpoint_mul2k(&S, &S, dbl);
+					}
+					dbl = 0;
+				}
+				win = (j == 0)
+					? (const vgf *)window_odd7_G
+					: (const vgf *)window_odd7_G128;
+				if (m > 0) {
+					T.x = win[m - 1];
+					T.y = win[m];
+				} else {
+					T.x = win[-m - 1];
+					vgf_neg(&T.y, &win[-m]);
+				}
+				T.neutral = 0;
+				vpoint_add(&S, &S, &T);
+			}
+		}
+		if (dbl > 0 && !S.neutral) {
+			vpoint_mul2k(&S, &S, dbl);
+		}
+
+		vpoint_add(&U, &U, &S);
+		c2 = NULL;
+		v += n;
+	} while (v < num);
+	vpoint_encode(Q3, &U);
+}
+
 /* see curve9767.h */
 int
 curve9767_point_verify_mul_mulgen_add_vartime(
@@ -4077,3 +4517,21 @@ curve9767_inner_gf_dummy_2(uint16_t *c, const uint16_t *a, const uint16_t *b)
 	vc.u1 = _mm_add_epi16(va.u1, vb.u1);
 	vgf_encode(c, &vc);
 }
+
+/*
+ * Fused product difference c = a*b - d*e, exported for benchmarks
+ * (to be compared with two calls to curve9767_inner_gf_mul()).
+ */
+void
+curve9767_inner_gf_mul_sub(uint16_t *c, const uint16_t *a, const uint16_t *b,
+	const uint16_t *d, const uint16_t *e)
+{
+	vgf va, vb, vd, ve, vc;
+
+	vgf_decode(&va, a);
+	vgf_decode(&vb, b);
+	vgf_decode(&vd, d);
+	vgf_decode(&ve, e);
+	vgf_mul_sub(&vc, &va, &vb, &vd, &ve);
+	vgf_encode(c, &vc);
+}
@@ -0,0 +1,455 @@
+/*
+ * ParallelHash implementation (NIST SP 800-185).
+ *
+ * This file uses only the public SHAKE/cSHAKE API from sha3.h, so that
+ * it works with all SHAKE implementations. When compiled for a target
+ * with AVX2 support, blocks are hashed four at a time with a 4-lane
+ * Keccak-f implementation. Multi-threaded processing uses POSIX threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+
+#if defined __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "sha3.h"
+
+/*
+ * Function name for the outer cSHAKE.
+ */
+#define PH_NAME   "ParallelHash"
+
+/*
+ * Inject right_encode(x) (or left_encode(x) if 'left' is non-zero) into
+ * the provided context.
+ */
+static void
+inject_encode(shake_context *sc, uint64_t x, int left)
+{
+	uint8_t tmp[9];
+	size_t n, u;
+
+	n = 1;
+	while (n < 8 && (x >> (n << 3)) != 0) {
+		n ++;
+	}
+	for (u = 0; u < n; u ++) {
+		tmp[left + u] = (uint8_t)(x >> ((n - 1 - u) << 3));
+	}
+	tmp[left ? 0 : n] = (uint8_t)n;
+	shake_inject(sc, tmp, n + 1);
+}
+
+#if defined __AVX2__
+
+static const uint64_t RC[] = {
+	0x0000000000000001, 0x0000000000008082,
+	0x800000000000808A, 0x8000000080008000,
+	0x000000000000808B, 0x0000000080000001,
+	0x8000000080008081, 0x8000000000008009,
+	0x000000000000008A, 0x0000000000000088,
+	0x0000000080008009, 0x000000008000000A,
+	0x000000008000808B, 0x800000000000008B,
+	0x8000000000008089, 0x8000000000008003,
+	0x8000000000008002, 0x8000000000000080,
+	0x000000000000800A, 0x800000008000000A,
+	0x8000000080008081, 0x8000000000008080,
+	0x0000000080000001, 0x8000000080008008
+};
+
+/*
+ * Rotation counts (rho step), indexed by lane (x + 5*y).
+ */
+static const int RHO[] = {
+	 0,  1, 62, 28, 27,
+	36, 44,  6, 55, 20,
+	 3, 10, 43, 25, 39,
+	41, 45, 15, 21,  8,
+	18,  2, 61, 56, 14
+};
+
+static inline __m256i
+rol64x4(__m256i x, int n)
+{
+	return _mm256_or_si256(
+		_mm256_sll_epi64(x, _mm_cvtsi32_si128(n)),
+		_mm256_srl_epi64(x, _mm_cvtsi32_si128(64 - n)));
+}
+
+/*
+ * Apply Keccak-f[1600] on four interleaved states: A[i] contains lane
+ * i of the four states.
+ */
+static void
+process_block_x4(__m256i *A)
+{
+	__m256i B[25], C[5], D[5];
+	int r, x, y;
+
+	for (r = 0; r < 24; r ++) {
+		for (x = 0; x < 5; x ++) {
+			C[x] = _mm256_xor_si256(
+				_mm256_xor_si256(A[x], A[x + 5]),
+				_mm256_xor_si256(A[x + 10],
+				_mm256_xor_si256(A[x + 15], A[x + 20])));
+		}
+		for (x = 0; x < 5; x ++) {
+			D[x] = _mm256_xor_si256(C[(x + 4) % 5],
+				rol64x4(C[(x + 1) % 5], 1));
+		}
+		for (y = 0; y < 25; y += 5) {
+			for (x = 0; x < 5; x ++) {
+				__m256i t;
+				int j;
+
+				/*
+				 * pi: lane (x,y) goes to (y, 2*x+3*y).
+				 */
+				t = _mm256_xor_si256(A[x + y], D[x]);
+				j = (y / 5) + 5 * ((2 * x + 3 * (y / 5)) % 5);
+				B[j] = RHO[x + y] == 0
+					? t : rol64x4(t, RHO[x + y]);
+			}
+		}
+		for (y = 0; y < 25; y += 5) {
+			for (x = 0; x < 5; x ++) {
+				A[x + y] = _mm256_xor_si256(B[x + y],
+					_mm256_andnot_si256(
+						B[((x + 1) % 5) + y],
+						B[((x + 2) % 5) + y]));
+			}
+		}
+		A[0] = _mm256_xor_si256(A[0],
+			_mm256_set1_epi64x((long long)RC[r]));
+	}
+}
+
+static inline uint64_t
+dec64le(const uint8_t *buf)
+{
+	uint64_t x;
+
+	memcpy(&x, buf, sizeof x);
+	return x;
+}
+
+/*
+ * Hash four complete blocks (of len bytes each, starting at data and
+ * spaced by len bytes) with SHAKE, writing the four digests (dlen bytes
+ * each, dlen <= rate) into out[].
+ */
+static void
+leaves_x4(uint8_t *out, size_t dlen,
+	const uint8_t *data, size_t len, size_t rate)
+{
+	__m256i A[25];
+	uint64_t tmp[4][25];
+	size_t u, v, w;
+	int i;
+
+	for (i = 0; i < 25; i ++) {
+		A[i] = _mm256_setzero_si256();
+	}
+
+	/*
+	 * Absorb all full rate-sized chunks.
+	 */
+	for (u = 0; u + rate <= len; u += rate) {
+		for (v = 0; v < (rate >> 3); v ++) {
+			const uint8_t *p;
+
+			p = data + u + (v << 3);
+			A[v] = _mm256_xor_si256(A[v], _mm256_set_epi64x(
+				(long long)dec64le(p + 3 * len),
+				(long long)dec64le(p + 2 * len),
+				(long long)dec64le(p + len),
+				(long long)dec64le(p)));
+		}
+		process_block_x4(A);
+	}
+
+	/*
+	 * Last (partial) chunk, with SHAKE padding.
+	 */
+	for (i = 0; i < 4; i ++) {
+		uint8_t *buf;
+
+		buf = (uint8_t *)tmp[i];
+		memset(buf, 0, rate);
+		memcpy(buf, data + i * len + u, len - u);
+		buf[len - u] ^= 0x1F;
+		buf[rate - 1] ^= 0x80;
+	}
+	for (v = 0; v < (rate >> 3); v ++) {
+		A[v] = _mm256_xor_si256(A[v], _mm256_set_epi64x(
+			(long long)tmp[3][v], (long long)tmp[2][v],
+			(long long)tmp[1][v], (long long)tmp[0][v]));
+	}
+	process_block_x4(A);
+
+	/*
+	 * Extract the digests.
+	 */
+	for (v = 0; v < ((dlen + 7) >> 3); v ++) {
+		_mm256_storeu_si256((__m256i *)tmp[0] + 0, A[v]);
+		for (i = 0; i < 4; i ++) {
+			w = dlen - (v << 3);
+			if (w > 8) {
+				w = 8;
+			}
+			memcpy(out + i * dlen + (v << 3),
+				(const uint8_t *)tmp[0] + (i << 3), w);
+		}
+	}
+}
+
+#endif
+
+/*
+ * Hash num complete blocks (of len bytes each) with SHAKE, writing the
+ * digests (dlen bytes each) into out[].
+ */
+static void
+leaves(uint8_t *out, size_t dlen, const uint8_t *data, size_t len,
+	size_t num, unsigned size)
+{
+	size_t u;
+
+	u = 0;
+#if defined __AVX2__
+	for (; u + 4 <= num; u += 4) {
+		leaves_x4(out + u * dlen, dlen, data + u * len, len,
+			200 - (size_t)(size >> 2));
+	}
+#endif
+	for (; u < num; u ++) {
+		shake_context sc;
+
+		shake_init(&sc, size);
+		shake_inject(&sc, data + u * len, len);
+		shake_flip(&sc);
+		shake_extract(&sc, out + u * dlen, dlen);
+	}
+}
+
+/*
+ * Finish the current leaf and inject its digest into the outer context.
+ */
+static void
+flush_leaf(parallelhash_context *pc)
+{
+	uint8_t tmp[64];
+	size_t dlen;
+
+	dlen = pc->size >> 2;
+	shake_flip(&pc->leaf);
+	shake_extract(&pc->leaf, tmp, dlen);
+	shake_inject(&pc->outer, tmp, dlen);
+	pc->num_leaves ++;
+	shake_init(&pc->leaf, pc->size);
+	pc->leaf_len = 0;
+}
+
+/*
+ * Process data until the next block boundary. Returned value is the
+ * number of consumed bytes.
+ */
+static size_t
+fill_leaf(parallelhash_context *pc, const uint8_t *buf, size_t len)
+{
+	size_t clen;
+
+	clen = pc->block_size - pc->leaf_len;
+	if (clen > len) {
+		clen = len;
+	}
+	shake_inject(&pc->leaf, buf, clen);
+	pc->leaf_len += clen;
+	if (pc->leaf_len == pc->block_size) {
+		flush_leaf(pc);
+	}
+	return clen;
+}
+
+/* see sha3.h */
+void
+parallelhash_init(parallelhash_context *pc, unsigned size,
+	size_t block_size, const void *custom, size_t custom_len)
+{
+	cshake_init(&pc->outer, size,
+		PH_NAME, strlen(PH_NAME), custom, custom_len);
+	inject_encode(&pc->outer, (uint64_t)block_size, 1);
+	shake_init(&pc->leaf, size);
+	pc->num_leaves = 0;
+	pc->block_size = block_size;
+	pc->leaf_len = 0;
+	pc->size = size;
+}
+
+/* see sha3.h */
+void
+parallelhash_update(parallelhash_context *pc, const void *data, size_t len)
+{
+	const uint8_t *buf;
+	uint8_t tmp[4 * 64];
+	size_t dlen, blen;
+
+	buf = data;
+	dlen = pc->size >> 2;
+	blen = pc->block_size;
+	if (pc->leaf_len != 0) {
+		size_t clen;
+
+		clen = fill_leaf(pc, buf, len);
+		buf += clen;
+		len -= clen;
+	}
+	while (len >= blen) {
+		size_t num;
+
+		num = len / blen;
+		if (num > 4) {
+			num = 4;
+		}
+		leaves(tmp, dlen, buf, blen, num, pc->size);
+		shake_inject(&pc->outer, tmp, num * dlen);
+		pc->num_leaves += num;
+		buf += num * blen;
+		len -= num * blen;
+	}
+	if (len > 0) {
+		fill_leaf(pc, buf, len);
+	}
+}
+
+/*
+ * Number of blocks processed by each thread in one round of
+ * parallelhash_update_mt().
+ */
+#define MT_CHUNK   256
+
+/*
+ * Maximum number of threads.
+ */
+#define MT_MAX     64
+
+typedef struct {
+	uint8_t *out;
+	const uint8_t *data;
+	size_t num, dlen, blen;
+	unsigned size;
+} mt_job;
+
+static void *
+mt_worker(void *arg)
+{
+	mt_job *job;
+
+	job = arg;
+	leaves(job->out, job->dlen, job->data, job->blen,
+		job->num, job->size);
+	return NULL;
+}
+
+/* see sha3.h */
+void
+parallelhash_update_mt(parallelhash_context *pc,
+	const void *data, size_t len, unsigned num_threads)
+{
+	const uint8_t *buf;
+	uint8_t *dig;
+	size_t dlen, blen;
+	pthread_t th[MT_MAX];
+	mt_job jobs[MT_MAX];
+
+	if (num_threads > MT_MAX) {
+		num_threads = MT_MAX;
+	}
+	buf = data;
+	dlen = pc->size >> 2;
+	blen = pc->block_size;
+	if (pc->leaf_len != 0) {
+		size_t clen;
+
+		clen = fill_leaf(pc, buf, len);
+		buf += clen;
+		len -= clen;
+	}
+	if (num_threads <= 1 || len / blen < 2) {
+		parallelhash_update(pc, buf, len);
+		return;
+	}
+	dig = malloc((size_t)num_threads * MT_CHUNK * dlen);
+	if (dig == NULL) {
+		parallelhash_update(pc, buf, len);
+		return;
+	}
+
+	/*
+	 * Each round splits up to num_threads*MT_CHUNK blocks between
+	 * the threads; the calling thread processes the first share.
+	 * Digests are then injected in order.
+	 */
+	while (len >= blen) {
+		size_t num, share, off;
+		unsigned t, nt;
+
+		num = len / blen;
+		if (num > (size_t)num_threads * MT_CHUNK) {
+			num = (size_t)num_threads * MT_CHUNK;
+		}
+		share = (num + num_threads - 1) / num_threads;
+		nt = 0;
+		for (off = 0; off < num; off += share) {
+			mt_job *job;
+
+			job = &jobs[nt];
+			job->out = dig + off * dlen;
+			job->data = buf + off * blen;
+			job->num = (num - off) < share ? (num - off) : share;
+			job->dlen = dlen;
+			job->blen = blen;
+			job->size = pc->size;
+			if (nt > 0 && pthread_create(&th[nt], NULL,
+				mt_worker, job) != 0)
+			{
+				mt_worker(job);
+				job->size = 0;
+			}
+			nt ++;
+		}
+		mt_worker(&jobs[0]);
+		for (t = 1; t < nt; t ++) {
+			if (jobs[t].size != 0) {
+				pthread_join(th[t], NULL);
+			}
+		}
+		shake_inject(&pc->outer, dig, num * dlen);
+		pc->num_leaves += num;
+		buf += num * blen;
+		len -= num * blen;
+	}
+	free(dig);
+	if (len > 0) {
+		fill_leaf(pc, buf, len);
+	}
+}
+
+/* see sha3.h */
+void
+parallelhash_close(parallelhash_context *pc, void *out, size_t out_len)
+{
+	if (pc->leaf_len != 0) {
+		flush_leaf(pc);
+	}
+	inject_encode(&pc->outer, pc->num_leaves, 0);
+	inject_encode(&pc->outer, (uint64_t)out_len << 3, 0);
+	cshake_flip(&pc->outer);
+	shake_extract(&pc->outer, out, out_len);
+}
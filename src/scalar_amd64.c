@@ -374,6 +374,8 @@ curve9767_scalar_decode_strict(curve9767_scalar *s, const void *src, size_t len)
 void
 curve9767_scalar_decode_reduce(curve9767_scalar *s, const void *src, size_t len)
 {
+	CURVE9767_STATS_INC(scalar_reduce);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -478,6 +480,8 @@ void
 curve9767_scalar_add(curve9767_scalar *c,
 	const curve9767_scalar *a, const curve9767_scalar *b)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -491,6 +495,8 @@ void
 curve9767_scalar_sub(curve9767_scalar *c,
 	const curve9767_scalar *a, const curve9767_scalar *b)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -503,6 +509,8 @@ curve9767_scalar_sub(curve9767_scalar *c,
 void
 curve9767_scalar_neg(curve9767_scalar *c, const curve9767_scalar *a)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -518,6 +526,8 @@ curve9767_scalar_mul(curve9767_scalar *c,
 {
 	uint16_t t[17];
 
+	CURVE9767_STATS_INC(scalar_mul);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -681,6 +691,8 @@ curve9767_inner_reduce_basis_vartime(
 	uint16_t bw[17];
 	unsigned char cc;
 
+	CURVE9767_STATS_INC(scalar_reduce_basis);
+
 	static const uint64_t order_u64[] = {
 		18100514074342678129ull,  3698157286099510427ull,
 		11496333115051504685ull,  1017895979937685331ull
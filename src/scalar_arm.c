@@ -44,16 +44,6 @@ static const uint16_t sD[] = {
 	12054, 20731,  3487, 26407,  9107, 22337,  7191,  1284
 };
 
-/*
- * n mod 2^15
- */
-#define N0    24177
-
-/*
- * -1/n mod 2^15
- */
-#define N0I   23919
-
 /* see curve9767.h */
 const curve9767_scalar curve9767_scalar_zero = {
 	{ { 0, 0, 0, 0, 0, 0, 0, 0, 0 } }
@@ -73,108 +63,22 @@ const curve9767_scalar curve9767_scalar_two128 = {
  * Addition.
  * Input operands must be less than 1.56*n each.
  * Output is lower than 2^252, hence lower than 1.14*n.
+ * Implemented in assembly.
  */
-static void
-scalar_add(uint16_t *c, const uint16_t *a, const uint16_t *b)
-{
-	/*
-	 * Since a < 1.56*n and b < 1.56*n, we have a+b < 3.12*n.
-	 * We subtract n repeatedly as long as the value is not
-	 * lower than 2^252. Since 3.12*n < 2^252 + 2*n, two
-	 * conditional subtractions are enough. Moreover, since
-	 * 2^252 < 1.14*n, the result is in the appropriate range.
-	 */
-	uint16_t d[17];
-	int i, j;
-	uint32_t cc;
-
-	cc = 0;
-	for (i = 0; i < 17; i ++) {
-		uint32_t w;
-
-		w = a[i] + b[i] + cc;
-		d[i] = (uint16_t)(w & 0x7FFF);
-		cc = w >> 15;
-	}
-
-	/*
-	 * No possible carry at this point (cc = 0). We now subtract n
-	 * conditionally on d >= 2^252 (and we do it twice).
-	 */
-	for (j = 0; j < 2; j ++) {
-		uint32_t m;
-
-		/*
-		 * d / (2^252) is equal to 0, 1 or 2 at this point. We
-		 * set m to 0xFFFFFFFF is the value is 1 or 2, to
-		 * 0x00000000 otherwise.
-		 */
-		m = (uint32_t)d[16] >> 12;
-		m = -(-m >> 31);
-
-		cc = 0;
-		for (i = 0; i < 17; i ++) {
-			uint32_t wd, wn;
-
-			wd = d[i];
-			wn = m & order[i];
-			wd = wd - wn - cc;
-			d[i] = (uint16_t)(wd & 0x7FFF);
-			cc = wd >> 31;
-		}
-	}
-
-	memcpy(c, d, sizeof d);
-}
+void curve9767_inner_scalar_add(uint16_t *c,
+	const uint16_t *a, const uint16_t *b);
+#define scalar_add   curve9767_inner_scalar_add
 
 /*
  * Subtraction.
  * Input operand 'a' must be less than 2*n.
  * Input operand 'b' must be less than 2*n.
  * Output is lower than 'a'.
+ * Implemented in assembly.
  */
-static void
-scalar_sub(uint16_t *c, const uint16_t *a, const uint16_t *b)
-{
-	/*
-	 * We compute a-b, then add n repeatedly until the result is
-	 * nonnegative. Since b < 2*n, two additions are sufficient.
-	 */
-	uint16_t d[17];
-	int i, j;
-	uint32_t cc;
-
-	cc = 0;
-	for (i = 0; i < 17; i ++) {
-		uint32_t w;
-
-		w = (uint32_t)a[i] - (uint32_t)b[i] - cc;
-		d[i] = (uint16_t)(w & 0x7FFF);
-		cc = w >> 31;
-	}
-
-	/*
-	 * Condition on adding n is that the value is negative. This shows
-	 * up as the top bit of the top word being 1.
-	 */
-	for (j = 0; j < 2; j ++) {
-		uint32_t m;
-
-		m = -((uint32_t)d[16] >> 14);
-		cc = 0;
-		for (i = 0; i < 17; i ++) {
-			uint32_t wd, wn;
-
-			wd = d[i];
-			wn = m & order[i];
-			wd = wd + wn + cc;
-			d[i] = (uint16_t)(wd & 0x7FFF);
-			cc = wd >> 15;
-		}
-	}
-
-	memcpy(c, d, sizeof d);
-}
+void curve9767_inner_scalar_sub(uint16_t *c,
+	const uint16_t *a, const uint16_t *b);
+#define scalar_sub   curve9767_inner_scalar_sub
 
 /*
  * Normalize a scalar into the 0..n-1 range.
@@ -273,63 +177,11 @@ scalar_decode_trunc(uint16_t *c, const void *src, size_t len)
  *
  * Input values must be lower than 1.27*n.
  * Output value is lower than 1.18*n.
+ * Implemented in assembly.
  */
-static void
-scalar_mmul(uint16_t *c, const uint16_t *a, const uint16_t *b)
-{
-	int i, j;
-	uint16_t d[17];
-	uint32_t dh;
-
-	memset(d, 0, sizeof d);
-	dh = 0;
-	for (i = 0; i < 17; i ++) {
-		uint32_t f, g, t, cc;
-
-		f = a[i];
-		t = d[0] + f * b[0];
-		g = (t * N0I) & 0x7FFF;
-		cc = (t + g * N0) >> 15;
-		for (j = 1; j < 17; j ++) {
-			uint32_t h;
-
-			/*
-			 * If cc <= 2^16, then:
-			 *   h <= 2^15-1 + 2*(2^15-1)^2 + 2^16
-			 * Thus:
-			 *   h < ((2^15)+1)*(2^16)
-			 * Therefore, cc will be at most 2^16 on output.
-			 */
-			h = d[j] + f * b[j] + g * order[j] + cc;
-			d[j - 1] = (uint16_t)(h & 0x7FFF);
-			cc = h >> 15;
-		}
-
-		/*
-		 * If dh <= 1, then dh+cc <= 1+2^16 < 2^17, and the new
-		 * dh value can be only 0 or 1.
-		 */
-		dh += cc;
-		d[16] = dh & 0x7FFF;
-		dh >>= 15;
-	}
-
-	/*
-	 * The loop above computed:
-	 *   d = (a*b + k*n) / (2^255)
-	 * with k < 2^255 (the successive values 'g' in the loop were the
-	 * representation of 'k' in base 2^15). Since we assumed that,
-	 * on input:
-	 *   a < 1.27*n
-	 *   b < 1.27*n
-	 * it follows that:
-	 *   d < (1.27*n)^2 + (2^255)*n) / (2^255)
-	 * This latter bound is about 1.178*n, hence d < 1.18*n. This
-	 * means that d is already in the proper range, and, in
-	 * particular, that dh = 0.
-	 */
-	memcpy(c, d, sizeof d);
-}
+void curve9767_inner_scalar_mmul(uint16_t *c,
+	const uint16_t *a, const uint16_t *b);
+#define scalar_mmul   curve9767_inner_scalar_mmul
 
 /* see curve9767.h */
 uint32_t
@@ -373,6 +225,8 @@ curve9767_scalar_decode_strict(curve9767_scalar *s, const void *src, size_t len)
 void
 curve9767_scalar_decode_reduce(curve9767_scalar *s, const void *src, size_t len)
 {
+	CURVE9767_STATS_INC(scalar_reduce);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -477,6 +331,8 @@ void
 curve9767_scalar_add(curve9767_scalar *c,
 	const curve9767_scalar *a, const curve9767_scalar *b)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -490,6 +346,8 @@ void
 curve9767_scalar_sub(curve9767_scalar *c,
 	const curve9767_scalar *a, const curve9767_scalar *b)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -502,6 +360,8 @@ curve9767_scalar_sub(curve9767_scalar *c,
 void
 curve9767_scalar_neg(curve9767_scalar *c, const curve9767_scalar *a)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -517,6 +377,8 @@ curve9767_scalar_mul(curve9767_scalar *c,
 {
 	uint16_t t[17];
 
+	CURVE9767_STATS_INC(scalar_mul);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -704,6 +566,8 @@ curve9767_inner_reduce_basis_vartime(
 	uint32_t tab[4 * 4 + 3 * 16];
 	int i;
 
+	CURVE9767_STATS_INC(scalar_reduce_basis);
+
 	/*
 	 * n mod 2^128, followed by: 0 mod 2^128.
 	 */
@@ -452,3 +452,440 @@ L_reduce_core__exit_2:
 	.size	curve9767_inner_reduce_basis_vartime_core, .-curve9767_inner_reduce_basis_vartime_core
 
 @ =======================================================================
+@ Scalar arithmetic modulo n (the curve order): scalars use 17 limbs of
+@ 15 bits each, one limb per 16-bit word (see scalar_arm.c). The
+@ functions below have the same input and output ranges as their C
+@ counterparts in scalar_arm.c.
+@ =======================================================================
+
+	.align	2
+L_scalar_order:
+	.hword	24177, 19022, 18073, 22927, 18879, 12156,  7504, 10559, 11571
+	.hword	26856, 15192, 22896, 14840, 31722,  2974,  9600,  3616,     0
+	@ -1/n mod 2^15
+	.word	23919
+
+@ Addition, first pass, one limb (i > 0):
+@   w = a[i] + b[i] + cc
+@   c[i] = w mod 2^15
+@   cc = w >> 15
+@ r0 = c, r1 = a, r2 = b, r5 = cc, r7 = 0x7FFF
+@ Cost: 10
+.macro SCADD_STEP  i
+	ldrh	r3, [r1, #(2 * (\i))]
+	ldrh	r4, [r2, #(2 * (\i))]
+	adds	r3, r4
+	adds	r3, r5
+	lsrs	r5, r3, #15
+	ands	r3, r7
+	strh	r3, [r0, #(2 * (\i))]
+.endm
+
+@ Subtraction, first pass, one limb (i > 0):
+@   w = a[i] - b[i] - cc
+@   c[i] = w mod 2^15
+@   cc = w >> 31
+@ r0 = c, r1 = a, r2 = b, r5 = cc, r7 = 0x7FFF
+@ Cost: 10
+.macro SCSUB_STEP  i
+	ldrh	r3, [r1, #(2 * (\i))]
+	ldrh	r4, [r2, #(2 * (\i))]
+	subs	r3, r4
+	subs	r3, r5
+	lsrs	r5, r3, #31
+	ands	r3, r7
+	strh	r3, [r0, #(2 * (\i))]
+.endm
+
+@ Conditional subtraction of n, one limb (i > 0):
+@   w = c[i] - (n[i] & m) - cc
+@   c[i] = w mod 2^15
+@   cc = w >> 31
+@ r0 = c, r1 = n, r5 = cc, r6 = m, r7 = 0x7FFF
+@ Cost: 11
+.macro SCCSUB_STEP  i
+	ldrh	r3, [r0, #(2 * (\i))]
+	ldrh	r4, [r1, #(2 * (\i))]
+	ands	r4, r6
+	subs	r3, r4
+	subs	r3, r5
+	lsrs	r5, r3, #31
+	ands	r3, r7
+	strh	r3, [r0, #(2 * (\i))]
+.endm
+
+@ Conditional addition of n, one limb (i > 0):
+@   w = c[i] + (n[i] & m) + cc
+@   c[i] = w mod 2^15
+@   cc = w >> 15
+@ r0 = c, r1 = n, r5 = cc, r6 = m, r7 = 0x7FFF
+@ Cost: 11
+.macro SCCADD_STEP  i
+	ldrh	r3, [r0, #(2 * (\i))]
+	ldrh	r4, [r1, #(2 * (\i))]
+	ands	r4, r6
+	adds	r3, r4
+	adds	r3, r5
+	lsrs	r5, r3, #15
+	ands	r3, r7
+	strh	r3, [r0, #(2 * (\i))]
+.endm
+
+@ Conditional subtraction of n from c, if c >= 2^252 (r0 = c, r7 = 0x7FFF).
+@ Cost: 191
+.macro SCCSUB_N
+	ldrh	r6, [r0, #32]
+	lsrs	r6, #12
+	rsbs	r6, r6, #0
+	asrs	r6, #31
+	ldrh	r3, [r0, #0]
+	ldrh	r4, [r1, #0]
+	ands	r4, r6
+	subs	r3, r4
+	lsrs	r5, r3, #31
+	ands	r3, r7
+	strh	r3, [r0, #0]
+	SCCSUB_STEP   1
+	SCCSUB_STEP   2
+	SCCSUB_STEP   3
+	SCCSUB_STEP   4
+	SCCSUB_STEP   5
+	SCCSUB_STEP   6
+	SCCSUB_STEP   7
+	SCCSUB_STEP   8
+	SCCSUB_STEP   9
+	SCCSUB_STEP  10
+	SCCSUB_STEP  11
+	SCCSUB_STEP  12
+	SCCSUB_STEP  13
+	SCCSUB_STEP  14
+	SCCSUB_STEP  15
+	SCCSUB_STEP  16
+.endm
+
+@ Conditional addition of n to c, if c is negative, i.e. its bit 254 is
+@ set (r0 = c, r7 = 0x7FFF).
+@ Cost: 190
+.macro SCCADD_N
+	ldrh	r6, [r0, #32]
+	lsrs	r6, #14
+	rsbs	r6, r6, #0
+	ldrh	r3, [r0, #0]
+	ldrh	r4, [r1, #0]
+	ands	r4, r6
+	adds	r3, r4
+	lsrs	r5, r3, #15
+	ands	r3, r7
+	strh	r3, [r0, #0]
+	SCCADD_STEP   1
+	SCCADD_STEP   2
+	SCCADD_STEP   3
+	SCCADD_STEP   4
+	SCCADD_STEP   5
+	SCCADD_STEP   6
+	SCCADD_STEP   7
+	SCCADD_STEP   8
+	SCCADD_STEP   9
+	SCCADD_STEP  10
+	SCCADD_STEP  11
+	SCCADD_STEP  12
+	SCCADD_STEP  13
+	SCCADD_STEP  14
+	SCCADD_STEP  15
+	SCCADD_STEP  16
+.endm
+
+@ =======================================================================
+@ void curve9767_inner_scalar_add(uint16_t *c,
+@                                 const uint16_t *a, const uint16_t *b)
+@
+@ Addition modulo n. Inputs must be lower than 1.56*n; output is lower
+@ than 2^252. The output buffer may be the same as either input.
+@
+@ Cost: 571
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_scalar_add
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_scalar_add, %function
+curve9767_inner_scalar_add:
+	push	{ r4, r5, r6, r7, lr }
+	movs	r7, #1
+	lsls	r7, #15
+	subs	r7, #1
+
+	@ c <- a + b (no carry out since a + b < 2^255).
+	ldrh	r3, [r1, #0]
+	ldrh	r4, [r2, #0]
+	adds	r3, r4
+	lsrs	r5, r3, #15
+	ands	r3, r7
+	strh	r3, [r0, #0]
+	SCADD_STEP   1
+	SCADD_STEP   2
+	SCADD_STEP   3
+	SCADD_STEP   4
+	SCADD_STEP   5
+	SCADD_STEP   6
+	SCADD_STEP   7
+	SCADD_STEP   8
+	SCADD_STEP   9
+	SCADD_STEP  10
+	SCADD_STEP  11
+	SCADD_STEP  12
+	SCADD_STEP  13
+	SCADD_STEP  14
+	SCADD_STEP  15
+	SCADD_STEP  16
+
+	@ a + b < 3.12*n < 2^252 + 2*n: two conditional subtractions
+	@ are enough.
+	ldr	r1, L_scalar_add__order
+L_scalar_add__pc:
+	add	r1, pc
+	SCCSUB_N
+	SCCSUB_N
+
+	pop	{ r4, r5, r6, r7, pc }
+	.align	2
+L_scalar_add__order:
+	.word	L_scalar_order - (L_scalar_add__pc + 4)
+	.size	curve9767_inner_scalar_add, .-curve9767_inner_scalar_add
+
+@ =======================================================================
+@ void curve9767_inner_scalar_sub(uint16_t *c,
+@                                 const uint16_t *a, const uint16_t *b)
+@
+@ Subtraction modulo n. Inputs must be lower than 2*n; output is lower
+@ than a. The output buffer may be the same as either input.
+@
+@ Cost: 569
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_scalar_sub
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_scalar_sub, %function
+curve9767_inner_scalar_sub:
+	push	{ r4, r5, r6, r7, lr }
+	movs	r7, #1
+	lsls	r7, #15
+	subs	r7, #1
+
+	@ c <- a - b (modulo 2^255).
+	ldrh	r3, [r1, #0]
+	ldrh	r4, [r2, #0]
+	subs	r3, r4
+	lsrs	r5, r3, #31
+	ands	r3, r7
+	strh	r3, [r0, #0]
+	SCSUB_STEP   1
+	SCSUB_STEP   2
+	SCSUB_STEP   3
+	SCSUB_STEP   4
+	SCSUB_STEP   5
+	SCSUB_STEP   6
+	SCSUB_STEP   7
+	SCSUB_STEP   8
+	SCSUB_STEP   9
+	SCSUB_STEP  10
+	SCSUB_STEP  11
+	SCSUB_STEP  12
+	SCSUB_STEP  13
+	SCSUB_STEP  14
+	SCSUB_STEP  15
+	SCSUB_STEP  16
+
+	@ b < 2*n: two conditional additions are enough.
+	ldr	r1, L_scalar_sub__order
+L_scalar_sub__pc:
+	add	r1, pc
+	SCCADD_N
+	SCCADD_N
+
+	pop	{ r4, r5, r6, r7, pc }
+	.align	2
+L_scalar_sub__order:
+	.word	L_scalar_order - (L_scalar_sub__pc + 4)
+	.size	curve9767_inner_scalar_sub, .-curve9767_inner_scalar_sub
+
+@ Montgomery multiplication, inner step (j = 1 to 16):
+@   h = d[j] + f*b[j] + g*n[j] + cc
+@   d[j-1] = h mod 2^15
+@   cc = h >> 15
+@ d[] is on the stack, one limb per 32-bit word.
+@ r1 = b, r2 = n, r3 = f, r4 = g, r5 = cc
+@ Cost: 16
+.macro SCMMUL_STEP  j
+	ldrh	r6, [r1, #(2 * (\j))]
+	muls	r6, r3
+	ldrh	r7, [r2, #(2 * (\j))]
+	muls	r7, r4
+	adds	r6, r7
+	ldr	r7, [sp, #(4 * (\j))]
+	adds	r6, r7
+	adds	r6, r5
+	lsrs	r5, r6, #15
+	lsls	r6, #17
+	lsrs	r6, #17
+	str	r6, [sp, #(4 * (\j) - 4)]
+.endm
+
+@ =======================================================================
+@ void curve9767_inner_scalar_mmul(uint16_t *c,
+@                                  const uint16_t *a, const uint16_t *b)
+@
+@ Montgomery multiplication: c = (a*b)/(2^255) mod n. Inputs must be
+@ lower than 1.27*n; output is lower than 1.18*n. The output buffer may
+@ be the same as either input.
+@
+@ Cost: 4979
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_scalar_mmul
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_scalar_mmul, %function
+curve9767_inner_scalar_mmul:
+	push	{ r4, r5, r6, r7, lr }
+	mov	r4, r8
+	mov	r5, r9
+	mov	r6, r10
+	mov	r7, r11
+	push	{ r4, r5, r6, r7 }
+
+	@ Stack frame:
+	@    sp+0    d[] (17 words)
+	@    sp+68   pointer to output
+	sub	sp, #72
+	str	r0, [sp, #68]
+
+	@ d <- 0
+	movs	r4, #0
+	movs	r5, #0
+	movs	r6, #0
+	movs	r7, #0
+	mov	r3, sp
+	stm	r3!, { r4, r5, r6, r7 }
+	stm	r3!, { r4, r5, r6, r7 }
+	stm	r3!, { r4, r5, r6, r7 }
+	stm	r3!, { r4, r5, r6, r7 }
+	str	r4, [r3]
+
+	@ Registers:
+	@    r0    pointer to a[i]
+	@    r1    pointer to b
+	@    r2    pointer to n
+	@    r8    end of a (loop exit)
+	@    r9    dh (extra top bit of d)
+	@    r10   -1/n mod 2^15
+	@    r11   n[0]
+	movs	r0, r1
+	movs	r1, r2
+	ldr	r2, L_scalar_mmul__order
+L_scalar_mmul__pc:
+	add	r2, pc
+	movs	r3, r0
+	adds	r3, #34
+	mov	r8, r3
+	mov	r9, r4
+	ldr	r3, [r2, #36]
+	mov	r10, r3
+	ldrh	r3, [r2, #0]
+	mov	r11, r3
+
+L_scalar_mmul__loop:
+	@ f = a[i]
+	ldrh	r3, [r0]
+	adds	r0, #2
+
+	@ t = d[0] + f*b[0]
+	@ g = (t * (-1/n)) mod 2^15
+	@ cc = (t + g*n[0]) >> 15
+	ldrh	r6, [r1]
+	muls	r6, r3
+	ldr	r7, [sp]
+	adds	r6, r7
+	mov	r4, r10
+	muls	r4, r6
+	lsls	r4, #17
+	lsrs	r4, #17
+	mov	r7, r11
+	muls	r7, r4
+	adds	r7, r6
+	lsrs	r5, r7, #15
+
+	SCMMUL_STEP   1
+	SCMMUL_STEP   2
+	SCMMUL_STEP   3
+	SCMMUL_STEP   4
+	SCMMUL_STEP   5
+	SCMMUL_STEP   6
+	SCMMUL_STEP   7
+	SCMMUL_STEP   8
+	SCMMUL_STEP   9
+	SCMMUL_STEP  10
+	SCMMUL_STEP  11
+	SCMMUL_STEP  12
+	SCMMUL_STEP  13
+	SCMMUL_STEP  14
+	SCMMUL_STEP  15
+	SCMMUL_STEP  16
+
+	@ dh <- dh + cc
+	@ d[16] <- dh mod 2^15
+	@ dh <- dh >> 15
+	mov	r6, r9
+	adds	r6, r5
+	lsls	r7, r6, #17
+	lsrs	r7, #17
+	str	r7, [sp, #64]
+	lsrs	r6, #15
+	mov	r9, r6
+
+	cmp	r0, r8
+	beq	L_scalar_mmul__exit
+	b	L_scalar_mmul__loop
+
+L_scalar_mmul__exit:
+	@ Copy d[] to the output (dh is zero at this point).
+	ldr	r0, [sp, #68]
+	mov	r1, sp
+	ldm	r1!, { r2, r3, r4, r5, r6, r7 }
+	strh	r2, [r0, #0]
+	strh	r3, [r0, #2]
+	strh	r4, [r0, #4]
+	strh	r5, [r0, #6]
+	strh	r6, [r0, #8]
+	strh	r7, [r0, #10]
+	ldm	r1!, { r2, r3, r4, r5, r6, r7 }
+	strh	r2, [r0, #12]
+	strh	r3, [r0, #14]
+	strh	r4, [r0, #16]
+	strh	r5, [r0, #18]
+	strh	r6, [r0, #20]
+	strh	r7, [r0, #22]
+	ldm	r1!, { r2, r3, r4, r5, r6 }
+	strh	r2, [r0, #24]
+	strh	r3, [r0, #26]
+	strh	r4, [r0, #28]
+	strh	r5, [r0, #30]
+	strh	r6, [r0, #32]
+
+	add	sp, #72
+	pop	{ r4, r5, r6, r7 }
+	mov	r8, r4
+	mov	r9, r5
+	mov	r10, r6
+	mov	r11, r7
+	pop	{ r4, r5, r6, r7, pc }
+	.align	2
+L_scalar_mmul__order:
+	.word	L_scalar_order - (L_scalar_mmul__pc + 4)
+	.size	curve9767_inner_scalar_mmul, .-curve9767_inner_scalar_mmul
+
+@ =======================================================================
@@ -382,3 +382,504 @@ L_reduce_core__exit_2:
 	.size	curve9767_inner_reduce_basis_vartime_core, .-curve9767_inner_reduce_basis_vartime_core
 
 @ =======================================================================
+@ Scalar arithmetic modulo n (the curve order): scalars use 17 limbs of
+@ 15 bits each, one limb per 16-bit word (see scalar_arm.c). The
+@ functions below convert their operands to eight 32-bit words, compute
+@ on these words, and convert the result back. They have the same input
+@ and output ranges as their C counterparts in scalar_arm.c.
+@ =======================================================================
+
+	.align	2
+L_scalar_order32:
+	.word	0x65275E71, 0xFB31F1A6, 0x417BE49B, 0x33527E75
+	.word	0xD634742D, 0x9F8B2E0E, 0x2E7BDF53, 0x0E204B00
+
+@ Load a scalar (17 limbs of 15 bits, from address rp) into r3:r10 (eight
+@ 32-bit words, little-endian order). r11 and r12 are scratch.
+@ Cost: 58
+.macro SC_LOAD  rp
+	ldrh	r11, [\rp, #0]
+	mov	r3, r11
+	ldrh	r12, [\rp, #2]
+	orr	r3, r3, r12, lsl #15
+	ldrh	r11, [\rp, #4]
+	orr	r3, r3, r11, lsl #30
+	lsr	r4, r11, #2
+	ldrh	r12, [\rp, #6]
+	orr	r4, r4, r12, lsl #13
+	ldrh	r11, [\rp, #8]
+	orr	r4, r4, r11, lsl #28
+	lsr	r5, r11, #4
+	ldrh	r12, [\rp, #10]
+	orr	r5, r5, r12, lsl #11
+	ldrh	r11, [\rp, #12]
+	orr	r5, r5, r11, lsl #26
+	lsr	r6, r11, #6
+	ldrh	r12, [\rp, #14]
+	orr	r6, r6, r12, lsl #9
+	ldrh	r11, [\rp, #16]
+	orr	r6, r6, r11, lsl #24
+	lsr	r7, r11, #8
+	ldrh	r12, [\rp, #18]
+	orr	r7, r7, r12, lsl #7
+	ldrh	r11, [\rp, #20]
+	orr	r7, r7, r11, lsl #22
+	lsr	r8, r11, #10
+	ldrh	r12, [\rp, #22]
+	orr	r8, r8, r12, lsl #5
+	ldrh	r11, [\rp, #24]
+	orr	r8, r8, r11, lsl #20
+	lsr	r9, r11, #12
+	ldrh	r12, [\rp, #26]
+	orr	r9, r9, r12, lsl #3
+	ldrh	r11, [\rp, #28]
+	orr	r9, r9, r11, lsl #18
+	lsr	r10, r11, #14
+	ldrh	r12, [\rp, #30]
+	orr	r10, r10, r12, lsl #1
+	ldrh	r11, [\rp, #32]
+	orr	r10, r10, r11, lsl #16
+.endm
+
+@ Same as SC_LOAD, but the value is doubled (the scalar must be lower
+@ than 2^255).
+@ Cost: 58
+.macro SC_LOAD2  rp
+	ldrh	r11, [\rp, #0]
+	lsl	r3, r11, #1
+	ldrh	r12, [\rp, #2]
+	orr	r3, r3, r12, lsl #16
+	ldrh	r11, [\rp, #4]
+	orr	r3, r3, r11, lsl #31
+	lsr	r4, r11, #1
+	ldrh	r12, [\rp, #6]
+	orr	r4, r4, r12, lsl #14
+	ldrh	r11, [\rp, #8]
+	orr	r4, r4, r11, lsl #29
+	lsr	r5, r11, #3
+	ldrh	r12, [\rp, #10]
+	orr	r5, r5, r12, lsl #12
+	ldrh	r11, [\rp, #12]
+	orr	r5, r5, r11, lsl #27
+	lsr	r6, r11, #5
+	ldrh	r12, [\rp, #14]
+	orr	r6, r6, r12, lsl #10
+	ldrh	r11, [\rp, #16]
+	orr	r6, r6, r11, lsl #25
+	lsr	r7, r11, #7
+	ldrh	r12, [\rp, #18]
+	orr	r7, r7, r12, lsl #8
+	ldrh	r11, [\rp, #20]
+	orr	r7, r7, r11, lsl #23
+	lsr	r8, r11, #9
+	ldrh	r12, [\rp, #22]
+	orr	r8, r8, r12, lsl #6
+	ldrh	r11, [\rp, #24]
+	orr	r8, r8, r11, lsl #21
+	lsr	r9, r11, #11
+	ldrh	r12, [\rp, #26]
+	orr	r9, r9, r12, lsl #4
+	ldrh	r11, [\rp, #28]
+	orr	r9, r9, r11, lsl #19
+	lsr	r10, r11, #13
+	ldrh	r12, [\rp, #30]
+	orr	r10, r10, r12, lsl #2
+	ldrh	r11, [\rp, #32]
+	orr	r10, r10, r11, lsl #17
+.endm
+
+@ Add a scalar (17 limbs of 15 bits, from address rp) to r3:r10. The
+@ carry flag is set to the output carry. r11 and r12 are scratch.
+@ Cost: 65
+.macro SC_ADD  rp
+	ldrh	r11, [\rp, #0]
+	ldrh	r12, [\rp, #2]
+	orr	r11, r11, r12, lsl #15
+	ldrh	r12, [\rp, #4]
+	orr	r11, r11, r12, lsl #30
+	adds	r3, r3, r11
+	lsr	r11, r12, #2
+	ldrh	r12, [\rp, #6]
+	orr	r11, r11, r12, lsl #13
+	ldrh	r12, [\rp, #8]
+	orr	r11, r11, r12, lsl #28
+	adcs	r4, r4, r11
+	lsr	r11, r12, #4
+	ldrh	r12, [\rp, #10]
+	orr	r11, r11, r12, lsl #11
+	ldrh	r12, [\rp, #12]
+	orr	r11, r11, r12, lsl #26
+	adcs	r5, r5, r11
+	lsr	r11, r12, #6
+	ldrh	r12, [\rp, #14]
+	orr	r11, r11, r12, lsl #9
+	ldrh	r12, [\rp, #16]
+	orr	r11, r11, r12, lsl #24
+	adcs	r6, r6, r11
+	lsr	r11, r12, #8
+	ldrh	r12, [\rp, #18]
+	orr	r11, r11, r12, lsl #7
+	ldrh	r12, [\rp, #20]
+	orr	r11, r11, r12, lsl #22
+	adcs	r7, r7, r11
+	lsr	r11, r12, #10
+	ldrh	r12, [\rp, #22]
+	orr	r11, r11, r12, lsl #5
+	ldrh	r12, [\rp, #24]
+	orr	r11, r11, r12, lsl #20
+	adcs	r8, r8, r11
+	lsr	r11, r12, #12
+	ldrh	r12, [\rp, #26]
+	orr	r11, r11, r12, lsl #3
+	ldrh	r12, [\rp, #28]
+	orr	r11, r11, r12, lsl #18
+	adcs	r9, r9, r11
+	lsr	r11, r12, #14
+	ldrh	r12, [\rp, #30]
+	orr	r11, r11, r12, lsl #1
+	ldrh	r12, [\rp, #32]
+	orr	r11, r11, r12, lsl #16
+	adcs	r10, r10, r11
+.endm
+
+@ Subtract a scalar (17 limbs of 15 bits, from address rp) from r3:r10.
+@ The carry flag is cleared on borrow. r11 and r12 are scratch.
+@ Cost: 65
+.macro SC_SUB  rp
+	ldrh	r11, [\rp, #0]
+	ldrh	r12, [\rp, #2]
+	orr	r11, r11, r12, lsl #15
+	ldrh	r12, [\rp, #4]
+	orr	r11, r11, r12, lsl #30
+	subs	r3, r3, r11
+	lsr	r11, r12, #2
+	ldrh	r12, [\rp, #6]
+	orr	r11, r11, r12, lsl #13
+	ldrh	r12, [\rp, #8]
+	orr	r11, r11, r12, lsl #28
+	sbcs	r4, r4, r11
+	lsr	r11, r12, #4
+	ldrh	r12, [\rp, #10]
+	orr	r11, r11, r12, lsl #11
+	ldrh	r12, [\rp, #12]
+	orr	r11, r11, r12, lsl #26
+	sbcs	r5, r5, r11
+	lsr	r11, r12, #6
+	ldrh	r12, [\rp, #14]
+	orr	r11, r11, r12, lsl #9
+	ldrh	r12, [\rp, #16]
+	orr	r11, r11, r12, lsl #24
+	sbcs	r6, r6, r11
+	lsr	r11, r12, #8
+	ldrh	r12, [\rp, #18]
+	orr	r11, r11, r12, lsl #7
+	ldrh	r12, [\rp, #20]
+	orr	r11, r11, r12, lsl #22
+	sbcs	r7, r7, r11
+	lsr	r11, r12, #10
+	ldrh	r12, [\rp, #22]
+	orr	r11, r11, r12, lsl #5
+	ldrh	r12, [\rp, #24]
+	orr	r11, r11, r12, lsl #20
+	sbcs	r8, r8, r11
+	lsr	r11, r12, #12
+	ldrh	r12, [\rp, #26]
+	orr	r11, r11, r12, lsl #3
+	ldrh	r12, [\rp, #28]
+	orr	r11, r11, r12, lsl #18
+	sbcs	r9, r9, r11
+	lsr	r11, r12, #14
+	ldrh	r12, [\rp, #30]
+	orr	r11, r11, r12, lsl #1
+	ldrh	r12, [\rp, #32]
+	orr	r11, r11, r12, lsl #16
+	sbcs	r10, r10, r11
+.endm
+
+@ Store the value in r3:r10 (lower than 2^255) as a scalar (17 limbs of
+@ 15 bits, at address rp). r12 is scratch.
+@ Cost: 58
+.macro SC_STORE  rp
+	ubfx	r12, r3, #0, #15
+	strh	r12, [\rp, #0]
+	ubfx	r12, r3, #15, #15
+	strh	r12, [\rp, #2]
+	lsr	r12, r3, #30
+	bfi	r12, r4, #2, #13
+	strh	r12, [\rp, #4]
+	ubfx	r12, r4, #13, #15
+	strh	r12, [\rp, #6]
+	lsr	r12, r4, #28
+	bfi	r12, r5, #4, #11
+	strh	r12, [\rp, #8]
+	ubfx	r12, r5, #11, #15
+	strh	r12, [\rp, #10]
+	lsr	r12, r5, #26
+	bfi	r12, r6, #6, #9
+	strh	r12, [\rp, #12]
+	ubfx	r12, r6, #9, #15
+	strh	r12, [\rp, #14]
+	lsr	r12, r6, #24
+	bfi	r12, r7, #8, #7
+	strh	r12, [\rp, #16]
+	ubfx	r12, r7, #7, #15
+	strh	r12, [\rp, #18]
+	lsr	r12, r7, #22
+	bfi	r12, r8, #10, #5
+	strh	r12, [\rp, #20]
+	ubfx	r12, r8, #5, #15
+	strh	r12, [\rp, #22]
+	lsr	r12, r8, #20
+	bfi	r12, r9, #12, #3
+	strh	r12, [\rp, #24]
+	ubfx	r12, r9, #3, #15
+	strh	r12, [\rp, #26]
+	lsr	r12, r9, #18
+	bfi	r12, r10, #14, #1
+	strh	r12, [\rp, #28]
+	ubfx	r12, r10, #1, #15
+	strh	r12, [\rp, #30]
+	ubfx	r12, r10, #16, #15
+	strh	r12, [\rp, #32]
+.endm
+
+@ Conditional subtraction of n from r3:r10, if the value is at least
+@ 2^252. lr must point to L_scalar_order32. r11 and r12 are scratch.
+@ Cost: 35
+.macro SC_CSUB_N
+	lsr	r11, r10, #28
+	rsbs	r11, r11, #0
+	sbc	r11, r11, r11
+	ldr	r12, [lr, #0]
+	and	r12, r12, r11
+	subs	r3, r3, r12
+	ldr	r12, [lr, #4]
+	and	r12, r12, r11
+	sbcs	r4, r4, r12
+	ldr	r12, [lr, #8]
+	and	r12, r12, r11
+	sbcs	r5, r5, r12
+	ldr	r12, [lr, #12]
+	and	r12, r12, r11
+	sbcs	r6, r6, r12
+	ldr	r12, [lr, #16]
+	and	r12, r12, r11
+	sbcs	r7, r7, r12
+	ldr	r12, [lr, #20]
+	and	r12, r12, r11
+	sbcs	r8, r8, r12
+	ldr	r12, [lr, #24]
+	and	r12, r12, r11
+	sbcs	r9, r9, r12
+	ldr	r12, [lr, #28]
+	and	r12, r12, r11
+	sbcs	r10, r10, r12
+.endm
+
+@ Conditional addition of n to r3:r10, if the value is negative (top bit
+@ of r10 is set). lr must point to L_scalar_order32. r11 and r12 are
+@ scratch.
+@ Cost: 33
+.macro SC_CADD_N
+	asr	r11, r10, #31
+	ldr	r12, [lr, #0]
+	and	r12, r12, r11
+	adds	r3, r3, r12
+	ldr	r12, [lr, #4]
+	and	r12, r12, r11
+	adcs	r4, r4, r12
+	ldr	r12, [lr, #8]
+	and	r12, r12, r11
+	adcs	r5, r5, r12
+	ldr	r12, [lr, #12]
+	and	r12, r12, r11
+	adcs	r6, r6, r12
+	ldr	r12, [lr, #16]
+	and	r12, r12, r11
+	adcs	r7, r7, r12
+	ldr	r12, [lr, #20]
+	and	r12, r12, r11
+	adcs	r8, r8, r12
+	ldr	r12, [lr, #24]
+	and	r12, r12, r11
+	adcs	r9, r9, r12
+	ldr	r12, [lr, #28]
+	and	r12, r12, r11
+	adcs	r10, r10, r12
+.endm
+
+@ =======================================================================
+@ void curve9767_inner_scalar_add(uint16_t *c,
+@                                 const uint16_t *a, const uint16_t *b)
+@
+@ Addition modulo n. Inputs must be lower than 1.56*n; output is lower
+@ than 2^252. The output buffer may be the same as either input.
+@
+@ Cost: 275
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_scalar_add
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_scalar_add, %function
+curve9767_inner_scalar_add:
+	push	{ r4, r5, r6, r7, r8, r9, r10, r11, lr }
+	SC_LOAD	r1
+	SC_ADD	r2
+
+	@ a + b < 3.12*n < 2^252 + 2*n: two conditional subtractions
+	@ are enough.
+	adr	lr, L_scalar_order32
+	SC_CSUB_N
+	SC_CSUB_N
+
+	SC_STORE	r0
+	pop	{ r4, r5, r6, r7, r8, r9, r10, r11, pc }
+	.size	curve9767_inner_scalar_add, .-curve9767_inner_scalar_add
+
+@ =======================================================================
+@ void curve9767_inner_scalar_sub(uint16_t *c,
+@                                 const uint16_t *a, const uint16_t *b)
+@
+@ Subtraction modulo n. Inputs must be lower than 2*n; output is lower
+@ than a. The output buffer may be the same as either input.
+@
+@ Cost: 271
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_scalar_sub
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_scalar_sub, %function
+curve9767_inner_scalar_sub:
+	push	{ r4, r5, r6, r7, r8, r9, r10, r11, lr }
+	SC_LOAD	r1
+	SC_SUB	r2
+
+	@ b < 2*n: two conditional additions are enough.
+	adr	lr, L_scalar_order32
+	SC_CADD_N
+	SC_CADD_N
+
+	SC_STORE	r0
+	pop	{ r4, r5, r6, r7, r8, r9, r10, r11, pc }
+	.size	curve9767_inner_scalar_sub, .-curve9767_inner_scalar_sub
+
+@ Montgomery multiplication, inner step (j = 1 to 7):
+@   (tj, r10) <- tj + ai*b[j] + r10
+@   (tj, r11) <- tj + m*n[j] + r11
+@ ai is in r8, m in r9; b[j] and n[j] are read from the stack.
+@ Cost: 6
+.macro SCMMUL_STEP  tj, j
+	ldr	r12, [sp, #(4 * (\j))]
+	umaal	\tj, r10, r8, r12
+	ldr	r12, [sp, #(32 + 4 * (\j))]
+	umaal	\tj, r11, r9, r12
+.endm
+
+@ Montgomery multiplication, one outer iteration (i = 0 to 7):
+@   t <- (t + a[i]*b + m*n) / 2^32
+@ with m = -t0*(1/n) mod 2^32, so that the division is exact. The
+@ accumulator t is in t0:t7; on output, the words are in t1:t7:t0 (the
+@ low word, which is zero after the reduction, becomes the top word).
+@ lr contains -1/n mod 2^32.
+@ Cost: 54
+.macro SCMMUL_ROUND  i, t0, t1, t2, t3, t4, t5, t6, t7
+	ldr	r8, [sp, #(64 + 4 * (\i))]
+	ldr	r12, [sp, #0]
+	mov	r10, #0
+	umaal	\t0, r10, r8, r12
+	mul	r9, \t0, lr
+	ldr	r12, [sp, #32]
+	mov	r11, #0
+	umaal	\t0, r11, r9, r12
+	SCMMUL_STEP  \t1, 1
+	SCMMUL_STEP  \t2, 2
+	SCMMUL_STEP  \t3, 3
+	SCMMUL_STEP  \t4, 4
+	SCMMUL_STEP  \t5, 5
+	SCMMUL_STEP  \t6, 6
+	SCMMUL_STEP  \t7, 7
+	add	\t0, r10, r11
+.endm
+
+@ =======================================================================
+@ void curve9767_inner_scalar_mmul(uint16_t *c,
+@                                  const uint16_t *a, const uint16_t *b)
+@
+@ Montgomery multiplication: c = (a*b)/(2^255) mod n. Inputs must be
+@ lower than 1.27*n; output is lower than 1.18*n. The output buffer may
+@ be the same as either input.
+@
+@ We use 32-bit words: the Montgomery multiplication computes
+@ (a*(2*b))/(2^256), which is the expected result. Since 2*b < 2.54*n,
+@ the output is lower than ((1.27*n)*(2.54*n))/(2^256) + n < 1.18*n.
+@
+@ Cost: 691
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_scalar_mmul
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_scalar_mmul, %function
+curve9767_inner_scalar_mmul:
+	push	{ r0, r4, r5, r6, r7, r8, r9, r10, r11, lr }
+
+	@ Stack frame:
+	@    sp+0    2*b (eight words)
+	@    sp+32   n (eight words)
+	@    sp+64   a (eight words)
+	@    sp+96   pointer to output (saved r0)
+	sub	sp, #96
+	SC_LOAD2	r2
+	stm	sp, { r3, r4, r5, r6, r7, r8, r9, r10 }
+	adr	r12, L_scalar_order32
+	ldm	r12, { r3, r4, r5, r6, r7, r8, r9, r10 }
+	add	r12, sp, #32
+	stm	r12, { r3, r4, r5, r6, r7, r8, r9, r10 }
+	SC_LOAD	r1
+	add	r12, sp, #64
+	stm	r12, { r3, r4, r5, r6, r7, r8, r9, r10 }
+
+	@ t <- 0
+	@ lr <- -1/n mod 2^32
+	movs	r0, #0
+	movs	r1, #0
+	movs	r2, #0
+	movs	r3, #0
+	movs	r4, #0
+	movs	r5, #0
+	movs	r6, #0
+	movs	r7, #0
+	movw	lr, #0x5D6F
+	movt	lr, #0x2E0F
+
+	SCMMUL_ROUND  0, r0, r1, r2, r3, r4, r5, r6, r7
+	SCMMUL_ROUND  1, r1, r2, r3, r4, r5, r6, r7, r0
+	SCMMUL_ROUND  2, r2, r3, r4, r5, r6, r7, r0, r1
+	SCMMUL_ROUND  3, r3, r4, r5, r6, r7, r0, r1, r2
+	SCMMUL_ROUND  4, r4, r5, r6, r7, r0, r1, r2, r3
+	SCMMUL_ROUND  5, r5, r6, r7, r0, r1, r2, r3, r4
+	SCMMUL_ROUND  6, r6, r7, r0, r1, r2, r3, r4, r5
+	SCMMUL_ROUND  7, r7, r0, r1, r2, r3, r4, r5, r6
+
+	@ The result is in r0:r7; move it to r3:r10 and store it.
+	mov	r10, r7
+	mov	r9, r6
+	mov	r8, r5
+	mov	r7, r4
+	mov	r6, r3
+	mov	r5, r2
+	mov	r4, r1
+	mov	r3, r0
+	ldr	r0, [sp, #96]
+	SC_STORE	r0
+
+	add	sp, #100
+	pop	{ r4, r5, r6, r7, r8, r9, r10, r11, pc }
+	.size	curve9767_inner_scalar_mmul, .-curve9767_inner_scalar_mmul
+
+@ =======================================================================
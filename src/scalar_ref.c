@@ -368,6 +368,8 @@ curve9767_scalar_decode_strict(curve9767_scalar *s, const void *src, size_t len)
 void
 curve9767_scalar_decode_reduce(curve9767_scalar *s, const void *src, size_t len)
 {
+	CURVE9767_STATS_INC(scalar_reduce);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -472,6 +474,8 @@ void
 curve9767_scalar_add(curve9767_scalar *c,
 	const curve9767_scalar *a, const curve9767_scalar *b)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -485,6 +489,8 @@ void
 curve9767_scalar_sub(curve9767_scalar *c,
 	const curve9767_scalar *a, const curve9767_scalar *b)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -497,6 +503,8 @@ curve9767_scalar_sub(curve9767_scalar *c,
 void
 curve9767_scalar_neg(curve9767_scalar *c, const curve9767_scalar *a)
 {
+	CURVE9767_STATS_INC(scalar_add);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -512,6 +520,8 @@ curve9767_scalar_mul(curve9767_scalar *c,
 {
 	uint16_t t[17];
 
+	CURVE9767_STATS_INC(scalar_mul);
+
 	/*
 	 * Set dummy alignment word (to appease some sanitizing tools).
 	 */
@@ -744,6 +754,8 @@ curve9767_inner_reduce_basis_vartime(
 	uint32_t nu_tab[17], nv_tab[17], sp[17];
 	uint32_t *u0, *u1, *v0, *v1, *nu, *nv;
 
+	CURVE9767_STATS_INC(scalar_reduce_basis);
+
 	/*
 	 * 1 in "large" format. Also valid as "small" format (by
 	 * using only the 9 first words).
@@ -8,6 +8,23 @@
 
 #include "sha3.h"
 
+/*
+ * If CURVE9767_KECCAK_ASM is non-zero, then the Keccak-f[1600]
+ * permutation is not compiled here; the external function
+ * curve9767_inner_keccak_f1600() is used instead. It is provided by
+ * sha3_cm0.s (ARM Cortex-M0+); that file must then be linked in.
+ */
+#ifndef CURVE9767_KECCAK_ASM
+#define CURVE9767_KECCAK_ASM   0
+#endif
+
+#if CURVE9767_KECCAK_ASM
+
+void curve9767_inner_keccak_f1600(uint64_t *A);
+#define process_block   curve9767_inner_keccak_f1600
+
+#else
+
 /*
  * Round constants.
  */
@@ -457,6 +474,8 @@ process_block(uint64_t *A)
 	A[20] = ~A[20];
 }
 
+#endif
+
 /* see sha3.h */
 void
 shake_init(shake_context *sc, unsigned size)
@@ -548,6 +567,85 @@ shake_extract(shake_context *sc, void *out, size_t len)
 	sc->dptr = dptr;
 }
 
+/*
+ * Inject encode_string(str) (from NIST SP 800-185) into the context.
+ * Returned value is the number of injected bytes.
+ */
+static size_t
+cshake_encode_string(shake_context *sc, const void *str, size_t len)
+{
+	uint8_t tmp[6];
+	uint64_t x;
+	size_t n, u;
+
+	x = (uint64_t)len << 3;
+	n = 1;
+	while (n < 5 && (x >> (n << 3)) != 0) {
+		n ++;
+	}
+	tmp[0] = (uint8_t)n;
+	for (u = 0; u < n; u ++) {
+		tmp[1 + u] = (uint8_t)(x >> ((n - 1 - u) << 3));
+	}
+	shake_inject(sc, tmp, n + 1);
+	shake_inject(sc, str, len);
+	return n + 1 + len;
+}
+
+/* see sha3.h */
+void
+cshake_init(shake_context *sc, unsigned size,
+	const void *name, size_t name_len,
+	const void *custom, size_t custom_len)
+{
+	/*
+	 * Absorb bytepad(encode_string(N) || encode_string(S), rate).
+	 * Lengths of strings are encoded in bits, with left_encode();
+	 * we support lengths up to 2^32-1 bytes.
+	 */
+	uint8_t tmp[6];
+	size_t len, zlen;
+
+	shake_init(sc, size);
+	if (name_len == 0 && custom_len == 0) {
+		return;
+	}
+	tmp[0] = 1;
+	tmp[1] = (uint8_t)sc->rate;
+	shake_inject(sc, tmp, 2);
+	len = 2;
+	len += cshake_encode_string(sc, name, name_len);
+	len += cshake_encode_string(sc, custom, custom_len);
+	zlen = sc->rate - (len % sc->rate);
+	if (zlen != sc->rate) {
+		memset(tmp, 0, sizeof tmp);
+		while (zlen > 0) {
+			size_t clen;
+
+			clen = zlen < sizeof tmp ? zlen : sizeof tmp;
+			shake_inject(sc, tmp, clen);
+			zlen -= clen;
+		}
+	}
+}
+
+/* see sha3.h */
+void
+cshake_flip(shake_context *sc)
+{
+	/*
+	 * Same as shake_flip(), but the padding starts with '00'
+	 * instead of '1111'.
+	 */
+	unsigned v;
+
+	v = sc->dptr;
+	sc->A[v >> 3] ^= (uint64_t)0x04 << ((v & 7) << 3);
+	v = sc->rate - 1;
+	sc->A[v >> 3] ^= (uint64_t)0x80 << ((v & 7) << 3);
+	sc->dptr = sc->rate;
+}
+
 /* see sha3.h */
 void
 sha3_init(sha3_context *sc, unsigned size)
@@ -86,6 +86,83 @@ void sha3_update(sha3_context *sc, const void *in, size_t len);
  */
 void sha3_close(sha3_context *sc, void *out);
 
+/*
+ * cSHAKE (NIST SP 800-185) is a customizable variant of SHAKE. The
+ * context is initialized with cshake_init(), which also absorbs the
+ * encoded function name and customization string; data is then
+ * injected with shake_inject(). When all data has been injected, the
+ * context is flipped to output mode with cshake_flip(), and output is
+ * obtained with shake_extract().
+ *
+ * Parameter "size" is 128 for cSHAKE128, 256 for cSHAKE256. If both
+ * the function name and the customization string are empty, then
+ * cSHAKE is, by definition, identical to SHAKE; in that case, the
+ * context MUST be flipped with shake_flip() instead of cshake_flip().
+ */
+void cshake_init(shake_context *sc, unsigned size,
+	const void *name, size_t name_len,
+	const void *custom, size_t custom_len);
+
+/*
+ * Flip a cSHAKE context to output mode (see cshake_init()).
+ */
+void cshake_flip(shake_context *sc);
+
+/*
+ * Context for a ParallelHash computation (NIST SP 800-185). Contents
+ * are opaque. As with SHAKE contexts, the structure contains no
+ * pointer and can be cloned by a simple copy.
+ *
+ * ParallelHash splits the input into blocks of B bytes; each block is
+ * hashed independently (with SHAKE) and the concatenation of the block
+ * digests is hashed with cSHAKE. Blocks can thus be processed in
+ * parallel; this implementation processes four blocks at a time with
+ * AVX2 opcodes when compiled for a target that supports them, and
+ * parallelhash_update_mt() spreads blocks over several threads.
+ */
+typedef struct {
+	shake_context outer;
+	shake_context leaf;
+	uint64_t num_leaves;
+	size_t block_size, leaf_len;
+	unsigned size;
+} parallelhash_context;
+
+/*
+ * Initialize a ParallelHash context. Parameter "size" is 128 for
+ * ParallelHash128, 256 for ParallelHash256. The block size (in bytes)
+ * MUST NOT be zero; SP 800-185 examples use small block sizes, but
+ * large values (e.g. 8192) make for better performance. The
+ * customization string may be empty (custom_len = 0).
+ */
+void parallelhash_init(parallelhash_context *pc, unsigned size,
+	size_t block_size, const void *custom, size_t custom_len);
+
+/*
+ * Inject some data bytes into the ParallelHash context. This function
+ * can be called several times, with chunks of arbitrary lengths.
+ */
+void parallelhash_update(parallelhash_context *pc,
+	const void *data, size_t len);
+
+/*
+ * Inject some data bytes into the ParallelHash context, using up to
+ * num_threads threads (including the caller) to process blocks. The
+ * result is the same as with parallelhash_update(). This function
+ * requires POSIX threads; if threads cannot be started, then the data
+ * is processed in the calling thread.
+ */
+void parallelhash_update_mt(parallelhash_context *pc,
+	const void *data, size_t len, unsigned num_threads);
+
+/*
+ * Finalize a ParallelHash computation, with an output of out_len bytes
+ * (the output length L, in bits, is 8*out_len and is part of the
+ * hashed data, i.e. this is not the "XOF" variant). The context must
+ * be reinitialized before being used again.
+ */
+void parallelhash_close(parallelhash_context *pc, void *out, size_t out_len);
+
 #ifdef __cplusplus
 }
 #endif
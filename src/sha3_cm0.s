@@ -0,0 +1,407 @@
+@ =======================================================================
+@ Keccak-f[1600] for ARM Cortex-M0+ (ARMv6-M, Thumb-1).
+@
+@ The permutation works on a bit-interleaved representation: each 64-bit
+@ lane is split into two 32-bit words, containing respectively the
+@ even-indexed and the odd-indexed bits of the lane. A 64-bit rotation
+@ then becomes two 32-bit rotations, which Thumb-1 supports (RORS, with
+@ the rotation count in a register).
+@
+@ The state is kept in the normal (non-interleaved) representation by
+@ the SHAKE code (sha3.c); it is converted on entry and on exit. Rounds
+@ go from one stack buffer to another (there are not enough registers for
+@ an in-place computation), two rounds per loop iteration.
+@
+@ Stack frame (offsets from sp, after the prologue):
+@     0   state, buffer 0 (25 lanes, 200 bytes)
+@   200   state, buffer 1
+@   400   theta: column parities C[0..4] (40 bytes)
+@   440   theta: D[0..4] (40 bytes)
+@   480   pointer to the caller's state
+@ Total stack usage is 520 bytes (with the saved registers).
+@ =======================================================================
+
+	.syntax	unified
+	.cpu	cortex-m0
+	.file	"sha3_cm0.s"
+	.text
+
+@ =======================================================================
+
+@ Delta swap (for bit interleaving):
+@   t = (x ^ (x >> s)) & m
+@   x = x ^ t ^ (t << s)
+@ x, t and m must be low registers; t is scratch.
+@ Cost: 6
+.macro DSWAP  x, t, m, s
+	lsrs	\t, \x, #\s
+	eors	\t, \x
+	ands	\t, \m
+	eors	\x, \t
+	lsls	\t, #\s
+	eors	\x, \t
+.endm
+
+@ Swap the high half of r1 with the low half of r2 (r3 is scratch).
+@ Cost: 6
+.macro HSWAP
+	lsrs	r3, r1, #16
+	eors	r3, r2
+	uxth	r3, r3
+	eors	r2, r3
+	lsls	r3, #16
+	eors	r1, r3
+.endm
+
+@ Theta, column parity: [sp + co] <- xor of the five words at sp + so,
+@ sp + so + 40,... sp + so + 160 (i.e. same column and half in the five
+@ planes).
+@ Cost: 16
+.macro KC  so, co
+	ldr	r0, [sp, #(\so)]
+	ldr	r1, [sp, #(\so + 40)]
+	eors	r0, r1
+	ldr	r1, [sp, #(\so + 80)]
+	eors	r0, r1
+	ldr	r1, [sp, #(\so + 120)]
+	eors	r0, r1
+	ldr	r1, [sp, #(\so + 160)]
+	eors	r0, r1
+	str	r0, [sp, #(\co)]
+.endm
+
+@ Theta: D[x] = C[x-1] ^ (C[x+1] <<< 1), with D[x] at sp + dx, C[x-1]
+@ at sp + cm and C[x+1] at sp + cp. In interleaved representation:
+@   D[x].even = C[x-1].even ^ (C[x+1].odd <<< 1)
+@   D[x].odd  = C[x-1].odd ^ C[x+1].even
+@ r7 must contain 31.
+@ Cost: 17
+.macro KD  dx, cm, cp
+	ldr	r0, [sp, #(\cm)]
+	ldr	r1, [sp, #(\cp + 4)]
+	rors	r1, r7
+	eors	r0, r1
+	str	r0, [sp, #(\dx)]
+	ldr	r0, [sp, #(\cm + 4)]
+	ldr	r1, [sp, #(\cp)]
+	eors	r0, r1
+	str	r0, [sp, #(\dx + 4)]
+.endm
+
+@ Theta + rho + pi, for one word: rb <- (word ^ D) <<< rot, with the
+@ state word at sp + so and the D word at sp + dd. r5 is scratch.
+@ Cost: 5 (7 with a non-zero rotation)
+.macro KB  rb, so, dd, rot
+	ldr	\rb, [sp, #(\so)]
+	ldr	r5, [sp, #(\dd)]
+	eors	\rb, r5
+	.if	\rot
+	movs	r5, #(32 - (\rot))
+	rors	\rb, r5
+	.endif
+.endm
+
+@ Chi, for one word: [sp + dst] <- ra ^ (~rb & rc). r6 is scratch.
+@ Cost: 5
+.macro KX  ra, rb, rc, dst
+	movs	r6, \rc
+	bics	r6, \rb
+	eors	r6, \ra
+	str	r6, [sp, #(\dst)]
+.endm
+
+@ Chi + iota, for the first word of a half-plane: same as KX, with an
+@ extra XOR with the round constant word at r8 + rco. r5 is scratch.
+@ Cost: 9
+.macro KXI  ra, rb, rc, dst, rco
+	movs	r6, \rc
+	bics	r6, \rb
+	eors	r6, \ra
+	mov	r5, r8
+	ldr	r5, [r5, #(\rco)]
+	eors	r6, r5
+	str	r6, [sp, #(\dst)]
+.endm
+
+@ One round: state in buffer at sp + src, output in buffer at sp + dst.
+@ r8 points to the round constants (interleaved) for two rounds; this
+@ round uses the constant at r8 + rco.
+@ Cost: 838
+.macro KROUND  src, dst, rco
+	@ Theta: column parities.
+	KC	(\src + 0), 400
+	KC	(\src + 4), 404
+	KC	(\src + 8), 408
+	KC	(\src + 12), 412
+	KC	(\src + 16), 416
+	KC	(\src + 20), 420
+	KC	(\src + 24), 424
+	KC	(\src + 28), 428
+	KC	(\src + 32), 432
+	KC	(\src + 36), 436
+
+	@ Theta: D[x].
+	movs	r7, #31
+	KD	440, 432, 408
+	KD	448, 400, 416
+	KD	456, 408, 424
+	KD	464, 416, 432
+	KD	472, 424, 400
+
+	@ Rho, pi, chi (and iota): plane 0, even words.
+	KB	r0, (\src + 0), 440, 0
+	KB	r1, (\src + 48), 448, 22
+	KB	r2, (\src + 100), 460, 22
+	KB	r3, (\src + 148), 468, 11
+	KB	r4, (\src + 192), 472, 7
+	KXI	r0, r1, r2, (\dst + 0), (\rco + 0)
+	KX	r1, r2, r3, (\dst + 8)
+	KX	r2, r3, r4, (\dst + 16)
+	KX	r3, r4, r0, (\dst + 24)
+	KX	r4, r0, r1, (\dst + 32)
+
+	@ Rho, pi, chi (and iota): plane 0, odd words.
+	KB	r0, (\src + 4), 444, 0
+	KB	r1, (\src + 52), 452, 22
+	KB	r2, (\src + 96), 456, 21
+	KB	r3, (\src + 144), 464, 10
+	KB	r4, (\src + 196), 476, 7
+	KXI	r0, r1, r2, (\dst + 4), (\rco + 4)
+	KX	r1, r2, r3, (\dst + 12)
+	KX	r2, r3, r4, (\dst + 20)
+	KX	r3, r4, r0, (\dst + 28)
+	KX	r4, r0, r1, (\dst + 36)
+
+	@ Rho, pi, chi (and iota): plane 1, even words.
+	KB	r0, (\src + 24), 464, 14
+	KB	r1, (\src + 72), 472, 10
+	KB	r2, (\src + 84), 444, 2
+	KB	r3, (\src + 132), 452, 23
+	KB	r4, (\src + 180), 460, 31
+	KX	r0, r1, r2, (\dst + 40)
+	KX	r1, r2, r3, (\dst + 48)
+	KX	r2, r3, r4, (\dst + 56)
+	KX	r3, r4, r0, (\dst + 64)
+	KX	r4, r0, r1, (\dst + 72)
+
+	@ Rho, pi, chi (and iota): plane 1, odd words.
+	KB	r0, (\src + 28), 468, 14
+	KB	r1, (\src + 76), 476, 10
+	KB	r2, (\src + 80), 440, 1
+	KB	r3, (\src + 128), 448, 22
+	KB	r4, (\src + 176), 456, 30
+	KX	r0, r1, r2, (\dst + 44)
+	KX	r1, r2, r3, (\dst + 52)
+	KX	r2, r3, r4, (\dst + 60)
+	KX	r3, r4, r0, (\dst + 68)
+	KX	r4, r0, r1, (\dst + 76)
+
+	@ Rho, pi, chi (and iota): plane 2, even words.
+	KB	r0, (\src + 12), 452, 1
+	KB	r1, (\src + 56), 456, 3
+	KB	r2, (\src + 108), 468, 13
+	KB	r3, (\src + 152), 472, 4
+	KB	r4, (\src + 160), 440, 9
+	KX	r0, r1, r2, (\dst + 80)
+	KX	r1, r2, r3, (\dst + 88)
+	KX	r2, r3, r4, (\dst + 96)
+	KX	r3, r4, r0, (\dst + 104)
+	KX	r4, r0, r1, (\dst + 112)
+
+	@ Rho, pi, chi (and iota): plane 2, odd words.
+	KB	r0, (\src + 8), 448, 0
+	KB	r1, (\src + 60), 460, 3
+	KB	r2, (\src + 104), 464, 12
+	KB	r3, (\src + 156), 476, 4
+	KB	r4, (\src + 164), 444, 9
+	KX	r0, r1, r2, (\dst + 84)
+	KX	r1, r2, r3, (\dst + 92)
+	KX	r2, r3, r4, (\dst + 100)
+	KX	r3, r4, r0, (\dst + 108)
+	KX	r4, r0, r1, (\dst + 116)
+
+	@ Rho, pi, chi (and iota): plane 3, even words.
+	KB	r0, (\src + 36), 476, 14
+	KB	r1, (\src + 40), 440, 18
+	KB	r2, (\src + 88), 448, 5
+	KB	r3, (\src + 140), 460, 8
+	KB	r4, (\src + 184), 464, 28
+	KX	r0, r1, r2, (\dst + 120)
+	KX	r1, r2, r3, (\dst + 128)
+	KX	r2, r3, r4, (\dst + 136)
+	KX	r3, r4, r0, (\dst + 144)
+	KX	r4, r0, r1, (\dst + 152)
+
+	@ Rho, pi, chi (and iota): plane 3, odd words.
+	KB	r0, (\src + 32), 472, 13
+	KB	r1, (\src + 44), 444, 18
+	KB	r2, (\src + 92), 452, 5
+	KB	r3, (\src + 136), 456, 7
+	KB	r4, (\src + 188), 468, 28
+	KX	r0, r1, r2, (\dst + 124)
+	KX	r1, r2, r3, (\dst + 132)
+	KX	r2, r3, r4, (\dst + 140)
+	KX	r3, r4, r0, (\dst + 148)
+	KX	r4, r0, r1, (\dst + 156)
+
+	@ Rho, pi, chi (and iota): plane 4, even words.
+	KB	r0, (\src + 16), 456, 31
+	KB	r1, (\src + 68), 468, 28
+	KB	r2, (\src + 116), 476, 20
+	KB	r3, (\src + 124), 444, 21
+	KB	r4, (\src + 168), 448, 1
+	KX	r0, r1, r2, (\dst + 160)
+	KX	r1, r2, r3, (\dst + 168)
+	KX	r2, r3, r4, (\dst + 176)
+	KX	r3, r4, r0, (\dst + 184)
+	KX	r4, r0, r1, (\dst + 192)
+
+	@ Rho, pi, chi (and iota): plane 4, odd words.
+	KB	r0, (\src + 20), 460, 31
+	KB	r1, (\src + 64), 464, 27
+	KB	r2, (\src + 112), 472, 19
+	KB	r3, (\src + 120), 440, 20
+	KB	r4, (\src + 172), 452, 1
+	KX	r0, r1, r2, (\dst + 164)
+	KX	r1, r2, r3, (\dst + 172)
+	KX	r2, r3, r4, (\dst + 180)
+	KX	r3, r4, r0, (\dst + 188)
+	KX	r4, r0, r1, (\dst + 196)
+.endm
+
+@ =======================================================================
+@ void curve9767_inner_keccak_f1600(uint64_t *A)
+@
+@ Apply the Keccak-f[1600] permutation on the provided state (25 lanes,
+@ normal representation). Lane A[i] is at index x + 5*y (FIPS 202).
+@
+@ Cost: 23610 cycles (24 rounds; interleaving conversions: 2 x 1650 cycles).
+@ =======================================================================
+
+	.align	1
+	.global	curve9767_inner_keccak_f1600
+	.thumb
+	.thumb_func
+	.type	curve9767_inner_keccak_f1600, %function
+curve9767_inner_keccak_f1600:
+	push	{ r4, r5, r6, r7, lr }
+	mov	r4, r8
+	mov	r5, r9
+	mov	r6, r10
+	push	{ r4, r5, r6 }
+	sub	sp, #488
+	str	r0, [sp, #480]
+
+	@ Convert the state to interleaved representation, into buffer 0.
+	@ r0 = source pointer, r9 = end of source, r10 = destination pointer.
+	adr	r3, L_keccak_masks
+	ldm	r3!, { r4, r5, r6, r7 }
+	movs	r3, #200
+	adds	r3, r0
+	mov	r9, r3
+	mov	r10, sp
+L_keccak__1:
+	ldm	r0!, { r1, r2 }
+	DSWAP	r1, r3, r4, 1
+	DSWAP	r1, r3, r5, 2
+	DSWAP	r1, r3, r6, 4
+	DSWAP	r1, r3, r7, 8
+	DSWAP	r2, r3, r4, 1
+	DSWAP	r2, r3, r5, 2
+	DSWAP	r2, r3, r6, 4
+	DSWAP	r2, r3, r7, 8
+	HSWAP
+	mov	r3, r10
+	stm	r3!, { r1, r2 }
+	mov	r10, r3
+	cmp	r0, r9
+	bne	L_keccak__1
+
+	@ 24 rounds, two per iteration. r8 points to the round constants
+	@ for the current iteration, r9 to the end of the table.
+	adr	r1, L_keccak_RC
+	mov	r8, r1
+	adds	r1, #192
+	mov	r9, r1
+L_keccak__2:
+	bl	L_keccak_round_01
+	bl	L_keccak_round_10
+	mov	r1, r8
+	adds	r1, #16
+	mov	r8, r1
+	cmp	r1, r9
+	bne	L_keccak__2
+
+	@ Convert back the state to normal representation.
+	@ r0 = source pointer, r9 = end of source, r10 = destination pointer.
+	adr	r3, L_keccak_masks
+	ldm	r3!, { r4, r5, r6, r7 }
+	mov	r0, sp
+	movs	r3, #200
+	add	r3, sp
+	mov	r9, r3
+	ldr	r3, [sp, #480]
+	mov	r10, r3
+L_keccak__3:
+	ldm	r0!, { r1, r2 }
+	HSWAP
+	DSWAP	r1, r3, r7, 8
+	DSWAP	r1, r3, r6, 4
+	DSWAP	r1, r3, r5, 2
+	DSWAP	r1, r3, r4, 1
+	DSWAP	r2, r3, r7, 8
+	DSWAP	r2, r3, r6, 4
+	DSWAP	r2, r3, r5, 2
+	DSWAP	r2, r3, r4, 1
+	mov	r3, r10
+	stm	r3!, { r1, r2 }
+	mov	r10, r3
+	cmp	r0, r9
+	bne	L_keccak__3
+
+	add	sp, #488
+	pop	{ r4, r5, r6 }
+	mov	r8, r4
+	mov	r9, r5
+	mov	r10, r6
+	pop	{ r4, r5, r6, r7, pc }
+
+	.align	2
+L_keccak_masks:
+	.long	0x22222222, 0x0C0C0C0C, 0x00F000F0, 0x0000FF00
+
+	@ Round constants, interleaved (even word, odd word).
+L_keccak_RC:
+	.long	0x00000001, 0x00000000
+	.long	0x00000000, 0x00000089
+	.long	0x00000000, 0x8000008B
+	.long	0x00000000, 0x80008080
+	.long	0x00000001, 0x0000008B
+	.long	0x00000001, 0x00008000
+	.long	0x00000001, 0x80008088
+	.long	0x00000001, 0x80000082
+	.long	0x00000000, 0x0000000B
+	.long	0x00000000, 0x0000000A
+	.long	0x00000001, 0x00008082
+	.long	0x00000000, 0x00008003
+	.long	0x00000001, 0x0000808B
+	.long	0x00000001, 0x8000000B
+	.long	0x00000001, 0x8000008A
+	.long	0x00000001, 0x80000081
+	.long	0x00000000, 0x80000081
+	.long	0x00000000, 0x80000008
+	.long	0x00000000, 0x00000083
+	.long	0x00000000, 0x80008003
+	.long	0x00000001, 0x80008088
+	.long	0x00000000, 0x80000088
+	.long	0x00000001, 0x00008000
+	.long	0x00000000, 0x80008082
+
+	@ Rounds: buffer 0 -> buffer 1, and buffer 1 -> buffer 0.
+L_keccak_round_01:
+	KROUND	0, 200, 0
+	bx	lr
+L_keccak_round_10:
+	KROUND	200, 0, 8
+	bx	lr
+	.size	curve9767_inner_keccak_f1600, .-curve9767_inner_keccak_f1600
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "inner.h"
+
+/*
+ * The cache is an array of sets, each with SIGCACHE_WAYS entries. The
+ * set for a key is selected by the low bits of the key (which is a
+ * SHAKE256 output, hence uniformly distributed). Each set has its own
+ * 32-bit clock, incremented on each access to the set; the entry that
+ * was last accessed the longest time ago (largest clock difference,
+ * computed modulo 2^32) is evicted first.
+ *
+ * Sets are protected by SIGCACHE_LOCKS mutexes (or fewer, if there are
+ * fewer sets): set i uses the mutex of index i modulo the number of
+ * mutexes. The lock is not held during the signature verification
+ * itself; thus, two threads may verify the same signature concurrently,
+ * and the second insertion then finds the entry already present.
+ */
+
+#define SIGCACHE_WAYS    4
+#define SIGCACHE_LOCKS   64
+#define SIGCACHE_MAX     ((size_t)1 << 30)
+
+static const char DOM_SIGCACHE[] = "curve9767-sigcache:";
+
+typedef struct {
+	uint8_t key[32];
+	uint32_t stamp;
+	uint32_t used;
+} sigcache_entry;
+
+typedef struct {
+	sigcache_entry e[SIGCACHE_WAYS];
+	uint32_t clock;
+} sigcache_set;
+
+struct curve9767_sigcache_ {
+	sigcache_set *sets;
+	uint32_t set_mask;
+	unsigned num_locks;
+	pthread_mutex_t locks[SIGCACHE_LOCKS];
+	uint64_t hits;
+	uint64_t misses;
+};
+
+/* see curve9767.h */
+curve9767_sigcache *
+curve9767_sigcache_new(size_t capacity)
+{
+	curve9767_sigcache *sc;
+	size_t num_sets;
+	unsigned u;
+
+	if (capacity > SIGCACHE_MAX) {
+		return NULL;
+	}
+	num_sets = 1;
+	while (num_sets * SIGCACHE_WAYS < capacity) {
+		num_sets <<= 1;
+	}
+	sc = malloc(sizeof *sc);
+	if (sc == NULL) {
+		return NULL;
+	}
+	sc->sets = calloc(num_sets, sizeof *sc->sets);
+	if (sc->sets == NULL) {
+		free(sc);
+		return NULL;
+	}
+	sc->set_mask = (uint32_t)(num_sets - 1);
+	sc->num_locks = num_sets < SIGCACHE_LOCKS
+		? (unsigned)num_sets : SIGCACHE_LOCKS;
+	for (u = 0; u < sc->num_locks; u ++) {
+		if (pthread_mutex_init(&sc->locks[u], NULL) != 0) {
+			while (u -- > 0) {
+				pthread_mutex_destroy(&sc->locks[u]);
+			}
+			free(sc->sets);
+			free(sc);
+			return NULL;
+		}
+	}
+	sc->hits = 0;
+	sc->misses = 0;
+	return sc;
+}
+
+/* see curve9767.h */
+void
+curve9767_sigcache_free(curve9767_sigcache *sc)
+{
+	unsigned u;
+
+	if (sc == NULL) {
+		return;
+	}
+	for (u = 0; u < sc->num_locks; u ++) {
+		pthread_mutex_destroy(&sc->locks[u]);
+	}
+	free(sc->sets);
+	free(sc);
+}
+
+/* see curve9767.h */
+void
+curve9767_sigcache_clear(curve9767_sigcache *sc)
+{
+	size_t u;
+
+	for (u = 0; u <= sc->set_mask; u ++) {
+		pthread_mutex_t *lock;
+
+		lock = &sc->locks[u % sc->num_locks];
+		pthread_mutex_lock(lock);
+		memset(&sc->sets[u], 0, sizeof sc->sets[u]);
+		pthread_mutex_unlock(lock);
+	}
+}
+
+/* see curve9767.h */
+void
+curve9767_sigcache_stats(curve9767_sigcache *sc,
+	uint64_t *hits, uint64_t *misses)
+{
+	if (hits != NULL) {
+		*hits = __atomic_load_n(&sc->hits, __ATOMIC_RELAXED);
+	}
+	if (misses != NULL) {
+		*misses = __atomic_load_n(&sc->misses, __ATOMIC_RELAXED);
+	}
+}
+
+/*
+ * Look up a key in a set (the set lock must be held). If found, the
+ * entry is marked as most recently used, and 1 is returned; otherwise,
+ * 0 is returned.
+ */
+static int
+set_lookup(sigcache_set *set, const uint8_t *key)
+{
+	int i;
+
+	for (i = 0; i < SIGCACHE_WAYS; i ++) {
+		sigcache_entry *e;
+
+		e = &set->e[i];
+		if (e->used && memcmp(e->key, key, 32) == 0) {
+			e->stamp = ++ set->clock;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Insert a key in a set (the set lock must be held), unless it is
+ * already present. A free entry is used if there is one; otherwise,
+ * the least recently used entry is replaced.
+ */
+static void
+set_insert(sigcache_set *set, const uint8_t *key)
+{
+	sigcache_entry *victim;
+	uint32_t max_age;
+	int i;
+
+	if (set_lookup(set, key)) {
+		return;
+	}
+	victim = NULL;
+	max_age = 0;
+	for (i = 0; i < SIGCACHE_WAYS; i ++) {
+		sigcache_entry *e;
+		uint32_t age;
+
+		e = &set->e[i];
+		if (!e->used) {
+			victim = e;
+			break;
+		}
+		age = set->clock - e->stamp;
+		if (victim == NULL || age > max_age) {
+			victim = e;
+			max_age = age;
+		}
+	}
+	memcpy(victim->key, key, 32);
+	victim->used = 1;
+	victim->stamp = ++ set->clock;
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_verify_cached(curve9767_sigcache *sc, const void *sig,
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	shake_context shc;
+	uint8_t key[32], tmp[32];
+	uint64_t x;
+	uint32_t idx;
+	sigcache_set *set;
+	pthread_mutex_t *lock;
+	int i, found, r;
+
+	/*
+	 * A neutral public key cannot be encoded (and signatures
+	 * are never valid for it); it bypasses the cache.
+	 */
+	if (!curve9767_point_encode(tmp, Q)) {
+		__atomic_add_fetch(&sc->misses, 1, __ATOMIC_RELAXED);
+		return curve9767_sign_verify_vartime(sig, Q,
+			hash_oid, hv, hv_len);
+	}
+
+	/*
+	 * Compute the key.
+	 */
+	shake_init(&shc, 256);
+	shake_inject(&shc, DOM_SIGCACHE, strlen(DOM_SIGCACHE));
+	shake_inject(&shc, sig, 64);
+	shake_inject(&shc, tmp, 32);
+	shake_inject(&shc, hash_oid, strlen(hash_oid) + 1);
+	x = (uint64_t)hv_len;
+	for (i = 0; i < 8; i ++) {
+		tmp[i] = (uint8_t)(x >> (i << 3));
+	}
+	shake_inject(&shc, tmp, 8);
+	shake_inject(&shc, hv, hv_len);
+	shake_flip(&shc);
+	shake_extract(&shc, key, sizeof key);
+
+	idx = ((uint32_t)key[0] | ((uint32_t)key[1] << 8)
+		| ((uint32_t)key[2] << 16) | ((uint32_t)key[3] << 24))
+		& sc->set_mask;
+	set = &sc->sets[idx];
+	lock = &sc->locks[idx % sc->num_locks];
+
+	pthread_mutex_lock(lock);
+	found = set_lookup(set, key);
+	pthread_mutex_unlock(lock);
+	if (found) {
+		__atomic_add_fetch(&sc->hits, 1, __ATOMIC_RELAXED);
+		return 1;
+	}
+	__atomic_add_fetch(&sc->misses, 1, __ATOMIC_RELAXED);
+
+	r = curve9767_sign_verify_vartime(sig, Q, hash_oid, hv, hv_len);
+	if (r) {
+		pthread_mutex_lock(lock);
+		set_insert(set, key);
+		pthread_mutex_unlock(lock);
+	}
+	return r;
+}
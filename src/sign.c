@@ -2,29 +2,46 @@
 
 #define DOM_SIGN_K   "curve9767-sign-k:"
 #define DOM_SIGN_E   "curve9767-sign-e:"
+#define DOM_SIGN_N   "curve9767-sign-nonce:"
 
+/*
+ * Start the computation of k: inject the domain separation string and
+ * the additional secret t. The resulting context depends only on the
+ * private key, and can be saved (see curve9767_sign_key).
+ */
 static void
-make_k(curve9767_scalar *k, const uint8_t t[32],
+make_k_prefix(shake_context *sc, const uint8_t t[32])
+{
+	shake_init(sc, 256);
+	shake_inject(sc, DOM_SIGN_K, strlen(DOM_SIGN_K));
+	shake_inject(sc, t, 32);
+}
+
+/*
+ * Finish the computation of k, from a context obtained with
+ * make_k_prefix(). The context is consumed.
+ */
+static void
+make_k_finish(curve9767_scalar *k, shake_context *sc,
 	const char *hash_oid, const void *hv, size_t hv_len)
 {
-	shake_context sc;
 	uint8_t tmp[64];
 
-	shake_init(&sc, 256);
-	shake_inject(&sc, DOM_SIGN_K, strlen(DOM_SIGN_K));
-	shake_inject(&sc, t, 32);
-	shake_inject(&sc, hash_oid, strlen(hash_oid));
-	shake_inject(&sc, ":", 1);
-	shake_inject(&sc, hv, hv_len);
-	shake_flip(&sc);
-	shake_extract(&sc, tmp, 64);
+	shake_inject(sc, hash_oid, strlen(hash_oid));
+	shake_inject(sc, ":", 1);
+	shake_inject(sc, hv, hv_len);
+	shake_flip(sc);
+	shake_extract(sc, tmp, 64);
 	curve9767_scalar_decode_reduce(k, tmp, 64);
 	curve9767_scalar_condcopy(k, &curve9767_scalar_one,
 		curve9767_scalar_is_zero(k));
 }
 
+/*
+ * Compute the challenge e, with the public key already encoded (eQ).
+ */
 static void
-make_e(curve9767_scalar *e, const uint8_t c[32], const curve9767_point *Q,
+make_e_enc(curve9767_scalar *e, const uint8_t c[32], const uint8_t eQ[32],
 	const char *hash_oid, const void *hv, size_t hv_len)
 {
 	shake_context sc;
@@ -33,8 +50,7 @@ make_e(curve9767_scalar *e, const uint8_t c[32], const curve9767_point *Q,
 	shake_init(&sc, 256);
 	shake_inject(&sc, DOM_SIGN_E, strlen(DOM_SIGN_E));
 	shake_inject(&sc, c, 32);
-	curve9767_point_encode(tmp, Q);
-	shake_inject(&sc, tmp, 32);
+	shake_inject(&sc, eQ, 32);
 	shake_inject(&sc, hash_oid, strlen(hash_oid));
 	shake_inject(&sc, ":", 1);
 	shake_inject(&sc, hv, hv_len);
@@ -43,6 +59,36 @@ make_e(curve9767_scalar *e, const uint8_t c[32], const curve9767_point *Q,
 	curve9767_scalar_decode_reduce(e, tmp, 64);
 }
 
+/* see inner.h */
+void
+curve9767_inner_sign_make_e(curve9767_scalar *e, const uint8_t c[32],
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	uint8_t eQ[32];
+
+	curve9767_point_encode(eQ, Q);
+	make_e_enc(e, c, eQ, hash_oid, hv, hv_len);
+}
+
+/*
+ * Core of signature generation, once k is known: compute the commitment
+ * point C, its encoding c (32 bytes), and the response scalar d. The
+ * public key is provided in encoded format (eQ).
+ */
+static void
+sign_core(curve9767_point *C, uint8_t c[32], curve9767_scalar *d,
+	const curve9767_scalar *k, const curve9767_scalar *s,
+	const uint8_t eQ[32],
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_point_mulgen(C, k);
+	curve9767_point_encode(c, C);
+	make_e_enc(d, c, eQ, hash_oid, hv, hv_len);
+	curve9767_scalar_mul(d, d, s);
+	curve9767_scalar_add(d, d, k);
+}
+
 /* see curve9767.h */
 void
 curve9767_sign_generate(void *sig,
@@ -50,17 +96,79 @@ curve9767_sign_generate(void *sig,
 	const curve9767_point *Q,
 	const char *hash_oid, const void *hv, size_t hv_len)
 {
-	curve9767_scalar k, e;
+	curve9767_scalar k, d;
 	curve9767_point C;
+	shake_context sc;
 	uint8_t tmp[64];
 
-	make_k(&k, t, hash_oid, hv, hv_len);
-	curve9767_point_mulgen(&C, &k);
-	curve9767_point_encode(tmp, &C);
-	make_e(&e, tmp, Q, hash_oid, hv, hv_len);
-	curve9767_scalar_mul(&e, &e, s);
-	curve9767_scalar_add(&e, &e, &k);
-	curve9767_scalar_encode(tmp + 32, &e);
+	make_k_prefix(&sc, t);
+	make_k_finish(&k, &sc, hash_oid, hv, hv_len);
+	curve9767_point_encode(tmp + 32, Q);
+	sign_core(&C, tmp, &d, &k, s, tmp + 32, hash_oid, hv, hv_len);
+	curve9767_scalar_encode(tmp + 32, &d);
+	memcpy(sig, tmp, 64);
+}
+
+/* see curve9767.h */
+void
+curve9767_sign_generate_full(void *sig,
+	const curve9767_scalar *s, const uint8_t t[32],
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_scalar k, d;
+	curve9767_point C;
+	shake_context sc;
+	uint8_t tmp[96];
+
+	make_k_prefix(&sc, t);
+	make_k_finish(&k, &sc, hash_oid, hv, hv_len);
+	curve9767_point_encode(tmp + 64, Q);
+	sign_core(&C, tmp, &d, &k, s, tmp + 64, hash_oid, hv, hv_len);
+	curve9767_point_encode_full(tmp, &C);
+	curve9767_scalar_encode(tmp + 64, &d);
+	memcpy(sig, tmp, 96);
+}
+
+/* see curve9767.h */
+void
+curve9767_sign_key_init(curve9767_sign_key *sk,
+	const curve9767_scalar *s, const uint8_t t[32],
+	const curve9767_point *Q)
+{
+	sk->s = *s;
+	curve9767_point_encode(sk->eQ, Q);
+	make_k_prefix(&sk->kc, t);
+}
+
+/* see curve9767.h */
+void
+curve9767_sign_key_from_seed(curve9767_sign_key *sk,
+	const void *seed, size_t seed_len)
+{
+	curve9767_point Q;
+	uint8_t t[32];
+
+	curve9767_keygen(&sk->s, t, &Q, seed, seed_len);
+	curve9767_point_encode(sk->eQ, &Q);
+	make_k_prefix(&sk->kc, t);
+	memset(t, 0, sizeof t);
+}
+
+/* see curve9767.h */
+void
+curve9767_sign_generate_key(void *sig, const curve9767_sign_key *sk,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_scalar k, d;
+	curve9767_point C;
+	shake_context sc;
+	uint8_t tmp[64];
+
+	sc = sk->kc;
+	make_k_finish(&k, &sc, hash_oid, hv, hv_len);
+	sign_core(&C, tmp, &d, &k, &sk->s, sk->eQ, hash_oid, hv, hv_len);
+	curve9767_scalar_encode(tmp + 32, &d);
 	memcpy(sig, tmp, 64);
 }
 
@@ -79,7 +187,7 @@ curve9767_sign_verify(const void *sig,
 
 	buf = sig;
 	r = curve9767_scalar_decode_strict(&d, buf + 32, 32);
-	make_e(&e, buf, Q, hash_oid, hv, hv_len);
+	curve9767_inner_sign_make_e(&e, buf, Q, hash_oid, hv, hv_len);
 	curve9767_scalar_neg(&e, &e);
 	curve9767_point_mul_mulgen_add(&C, Q, &e, &d);
 	curve9767_point_encode(tmp, &C);
@@ -90,13 +198,32 @@ curve9767_sign_verify(const void *sig,
 	return r & ((w - 1) >> 31);
 }
 
+/*
+ * Core of the vartime signature verification, once the commitment
+ * point C has been decoded (c is its 32-byte compressed encoding, and
+ * dbuf points to the encoded response scalar).
+ */
+static int
+verify_core_vartime(const curve9767_point *C, const uint8_t c[32],
+	const uint8_t *dbuf, const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_scalar d, e;
+
+	if (!curve9767_scalar_decode_strict(&d, dbuf, 32)) {
+		return 0;
+	}
+	curve9767_inner_sign_make_e(&e, c, Q, hash_oid, hv, hv_len);
+	curve9767_scalar_neg(&e, &e);
+	return curve9767_point_verify_mul_mulgen_add_vartime(Q, &e, &d, C);
+}
+
 /* see curve9767.h */
 int
 curve9767_sign_verify_vartime(const void *sig,
 	const curve9767_point *Q,
 	const char *hash_oid, const void *hv, size_t hv_len)
 {
-	curve9767_scalar d, e;
 	curve9767_point C;
 	const uint8_t *buf;
 
@@ -104,10 +231,75 @@ curve9767_sign_verify_vartime(const void *sig,
 	if (!curve9767_point_decode(&C, buf)) {
 		return 0;
 	}
-	if (!curve9767_scalar_decode_strict(&d, buf + 32, 32)) {
+	return verify_core_vartime(&C, buf, buf + 32,
+		Q, hash_oid, hv, hv_len);
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_verify_full_vartime(const void *sig,
+	const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_point C;
+	const uint8_t *buf;
+	uint8_t c[32];
+
+	/*
+	 * The challenge is computed over the compressed encoding of C,
+	 * which is cheap to rebuild from the decoded point.
+	 */
+	buf = sig;
+	if (!curve9767_point_decode_full(&C, buf)) {
+		return 0;
+	}
+	curve9767_point_encode(c, &C);
+	return verify_core_vartime(&C, c, buf + 64,
+		Q, hash_oid, hv, hv_len);
+}
+
+/* see curve9767.h */
+void
+curve9767_sign_nonce_generate(curve9767_sign_nonce *nonce,
+	const void *seed, size_t seed_len)
+{
+	shake_context sc;
+	uint8_t tmp[64];
+	curve9767_point C;
+
+	shake_init(&sc, 256);
+	shake_inject(&sc, DOM_SIGN_N, strlen(DOM_SIGN_N));
+	shake_inject(&sc, seed, seed_len);
+	shake_flip(&sc);
+	shake_extract(&sc, tmp, 64);
+	curve9767_scalar_decode_reduce(&nonce->k, tmp, 64);
+	curve9767_scalar_condcopy(&nonce->k, &curve9767_scalar_one,
+		curve9767_scalar_is_zero(&nonce->k));
+	curve9767_point_mulgen(&C, &nonce->k);
+	curve9767_point_encode(nonce->c, &C);
+	nonce->ready = 1;
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_generate_online(void *sig,
+	const curve9767_scalar *s, const curve9767_point *Q,
+	curve9767_sign_nonce *nonce,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_scalar e;
+	uint8_t tmp[64];
+
+	if (nonce->ready != 1) {
 		return 0;
 	}
-	make_e(&e, buf, Q, hash_oid, hv, hv_len);
-	curve9767_scalar_neg(&e, &e);
-	return curve9767_point_verify_mul_mulgen_add_vartime(Q, &e, &d, &C);
+	nonce->ready = 0;
+	memcpy(tmp, nonce->c, 32);
+	curve9767_inner_sign_make_e(&e, tmp, Q, hash_oid, hv, hv_len);
+	curve9767_scalar_mul(&e, &e, s);
+	curve9767_scalar_add(&e, &e, &nonce->k);
+	curve9767_scalar_encode(tmp + 32, &e);
+	memset(nonce, 0, sizeof *nonce);
+	memcpy(sig, tmp, 64);
+	return 1;
 }
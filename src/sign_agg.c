@@ -0,0 +1,303 @@
+#include <stdlib.h>
+
+#include "inner.h"
+
+/*
+ * Signature half-aggregation and batch verification. These functions
+ * use heap allocation and curve9767_point_mulN_vartime() (msm.c), so
+ * they are kept out of sign.c, which the bare-metal benchmark builds
+ * also compile.
+ */
+
+#define DOM_SIGN_AGG "curve9767-sign-agg:"
+#define DOM_SIGN_BAT "curve9767-sign-batch:"
+
+/*
+ * Number of signatures processed per multi-scalar multiplication in
+ * aggregate and batch signature verification, for small inputs.
+ */
+#define AGG_BATCH    8
+
+/*
+ * From this number of signatures, aggregate and batch signature
+ * verification use curve9767_point_mulN_vartime() (which switches to
+ * Pippenger's method at about 64 points).
+ */
+#define AGG_MSM_MIN  32
+
+/*
+ * Initialize the SHAKE context for the aggregation coefficients z_i,
+ * with domain separation string dom. The values c_i are read from cc[],
+ * with a stride of 'stride' bytes from one c_i to the next (64 for a
+ * list of signatures, 32 for an aggregate signature); for each i, the
+ * first clen bytes at that position are injected (32 for c_i alone, 64
+ * for a full signature). The challenges e_i are computed here; if ee is
+ * not NULL, they are also written into ee[]. On output, the context is
+ * ready to output the z_i values (16 bytes each).
+ */
+static void
+make_z_init(shake_context *zc, const char *dom,
+	const uint8_t *cc, size_t stride, size_t clen,
+	const curve9767_sign_msg *msg, size_t num, curve9767_scalar *ee)
+{
+	curve9767_scalar e;
+	uint8_t tmp[32];
+	uint64_t x;
+	size_t u;
+	int i;
+
+	shake_init(zc, 256);
+	shake_inject(zc, dom, strlen(dom));
+	x = (uint64_t)num;
+	for (i = 0; i < 8; i ++) {
+		tmp[i] = (uint8_t)(x >> (i << 3));
+	}
+	shake_inject(zc, tmp, 8);
+	for (u = 0; u < num; u ++) {
+		const uint8_t *c;
+
+		c = cc + u * stride;
+		curve9767_inner_sign_make_e(&e, c, msg[u].Q,
+			msg[u].hash_oid, msg[u].hv, msg[u].hv_len);
+		shake_inject(zc, c, clen);
+		curve9767_scalar_encode(tmp, &e);
+		shake_inject(zc, tmp, 32);
+		if (ee != NULL) {
+			ee[u] = e;
+		}
+	}
+	shake_flip(zc);
+}
+
+/*
+ * Get the next aggregation coefficient z_i.
+ */
+static void
+next_z(curve9767_scalar *z, shake_context *zc)
+{
+	uint8_t tmp[16];
+
+	shake_extract(zc, tmp, 16);
+	curve9767_scalar_decode_strict(z, tmp, 16);
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_aggregate(void *agg, const void *sigs,
+	const curve9767_sign_msg *msg, size_t num)
+{
+	shake_context zc;
+	curve9767_scalar d, di, z;
+	const uint8_t *sbuf;
+	uint8_t *abuf;
+	size_t u;
+
+	if (num == 0) {
+		return 0;
+	}
+	sbuf = sigs;
+	abuf = agg;
+	make_z_init(&zc, DOM_SIGN_AGG, sbuf, 64, 32, msg, num, NULL);
+	d = curve9767_scalar_zero;
+	for (u = 0; u < num; u ++) {
+		if (!curve9767_scalar_decode_strict(&di,
+			sbuf + (u << 6) + 32, 32))
+		{
+			return 0;
+		}
+		next_z(&z, &zc);
+		curve9767_scalar_mul(&di, &di, &z);
+		curve9767_scalar_add(&d, &d, &di);
+		memcpy(abuf + (u << 5), sbuf + (u << 6), 32);
+	}
+	curve9767_scalar_encode(abuf + (num << 5), &d);
+	return 1;
+}
+
+/*
+ * Check that:
+ *   \sum z_i*C_i + \sum (z_i*e_i)*Q_i - d*G = 0
+ * where the points C_i are decoded from cc[] (with the provided stride,
+ * as in make_z_init()), and the z_i are obtained from zc. The challenges
+ * e_i are read from ee[], as output by make_z_init(); if ee is NULL
+ * (allocation failure), then they are computed again.
+ *
+ * If pp and ss are not NULL, then they have room for 2*num+1 points and
+ * scalars, and a single call to curve9767_point_mulN_vartime() is used.
+ * Otherwise, a multi-scalar multiplication is performed per batch of
+ * AGG_BATCH signatures, with the term in G (which uses precomputed
+ * windows) processed with the first batch.
+ */
+static int
+verify_combined(const curve9767_scalar *d, const uint8_t *cc, size_t stride,
+	shake_context *zc, const curve9767_sign_msg *msg, size_t num,
+	const curve9767_scalar *ee, curve9767_point *pp, curve9767_scalar *ss)
+{
+	curve9767_point P[2 * AGG_BATCH], S, T;
+	curve9767_scalar nd, e, z;
+	uint8_t c[2 * AGG_BATCH * 32], c2[32];
+	size_t u, v, n;
+
+	curve9767_scalar_neg(&nd, d);
+	if (pp != NULL) {
+		for (u = 0; u < num; u ++) {
+			if (!curve9767_point_decode(&pp[u], cc + u * stride)) {
+				return 0;
+			}
+			pp[num + u] = *msg[u].Q;
+			next_z(&ss[u], zc);
+			curve9767_scalar_mul(&ss[num + u], &ee[u], &ss[u]);
+		}
+		pp[num << 1] = curve9767_generator;
+		ss[num << 1] = nd;
+		curve9767_point_mulN_vartime(&S, pp, ss, (num << 1) + 1, 1);
+		return S.neutral;
+	}
+
+	curve9767_scalar_encode(c2, &nd);
+	curve9767_point_set_neutral(&S);
+	for (v = 0; v < num; v += n) {
+		n = num - v;
+		if (n > AGG_BATCH) {
+			n = AGG_BATCH;
+		}
+		for (u = 0; u < n; u ++) {
+			const curve9767_sign_msg *m;
+			const uint8_t *ci;
+
+			m = &msg[v + u];
+			ci = cc + (v + u) * stride;
+			if (!curve9767_point_decode(&P[u], ci)) {
+				return 0;
+			}
+			P[n + u] = *m->Q;
+			if (ee != NULL) {
+				e = ee[v + u];
+			} else {
+				curve9767_inner_sign_make_e(&e, ci, m->Q,
+					m->hash_oid, m->hv, m->hv_len);
+			}
+			next_z(&z, zc);
+			curve9767_scalar_encode(c + (u << 5), &z);
+			curve9767_scalar_mul(&e, &e, &z);
+			curve9767_scalar_encode(c + ((n + u) << 5), &e);
+		}
+		curve9767_inner_mulN_mulgen_add_vartime(&T,
+			P, c, n << 1, v == 0 ? c2 : NULL);
+		curve9767_point_add(&S, &S, &T);
+	}
+	return S.neutral;
+}
+
+/*
+ * Allocate the buffers used by verify_combined() for num signatures.
+ * The returned array has room for the num challenges e_i; if num is at
+ * least AGG_MSM_MIN, then 2*num+1 points and scalars are also allocated
+ * into *pp and *ss (otherwise, these are set to NULL). On allocation
+ * failure, NULL is returned, and *pp and *ss are set to NULL. All three
+ * arrays are released with free_combined().
+ */
+static curve9767_scalar *
+alloc_combined(curve9767_point **pp, curve9767_scalar **ss, size_t num)
+{
+	curve9767_scalar *ee;
+	size_t n;
+
+	*pp = NULL;
+	*ss = NULL;
+	if (num > ((size_t)-1 >> 2) / sizeof(curve9767_point)) {
+		return NULL;
+	}
+	ee = malloc(num * sizeof(curve9767_scalar));
+	if (ee == NULL || num < AGG_MSM_MIN) {
+		return ee;
+	}
+	n = (num << 1) + 1;
+	*pp = malloc(n * sizeof(curve9767_point));
+	*ss = malloc(n * sizeof(curve9767_scalar));
+	if (*pp == NULL || *ss == NULL) {
+		free(*pp);
+		free(*ss);
+		*pp = NULL;
+		*ss = NULL;
+	}
+	return ee;
+}
+
+/*
+ * Release the buffers obtained from alloc_combined().
+ */
+static void
+free_combined(curve9767_scalar *ee, curve9767_point *pp, curve9767_scalar *ss)
+{
+	free(ee);
+	free(pp);
+	free(ss);
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_verify_aggregate_vartime(const void *agg,
+	const curve9767_sign_msg *msg, size_t num)
+{
+	shake_context zc;
+	curve9767_scalar d, *ss, *ee;
+	curve9767_point *pp;
+	const uint8_t *buf;
+	int r;
+
+	if (num == 0) {
+		return 0;
+	}
+	buf = agg;
+	if (!curve9767_scalar_decode_strict(&d, buf + (num << 5), 32)) {
+		return 0;
+	}
+	ee = alloc_combined(&pp, &ss, num);
+	make_z_init(&zc, DOM_SIGN_AGG, buf, 32, 32, msg, num, ee);
+	r = verify_combined(&d, buf, 32, &zc, msg, num, ee, pp, ss);
+	free_combined(ee, pp, ss);
+	return r;
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_verify_batch_vartime(const void *sigs,
+	const curve9767_sign_msg *msg, size_t num)
+{
+	/*
+	 * The z_i are derived from the full signatures (including the
+	 * d_i), so that invalid signatures cannot be crafted to cancel
+	 * each other out in the combined equation.
+	 */
+	shake_context zc, zc2;
+	curve9767_scalar d, di, z, *ss, *ee;
+	curve9767_point *pp;
+	const uint8_t *buf;
+	size_t u;
+	int r;
+
+	if (num == 0) {
+		return 0;
+	}
+	buf = sigs;
+	ee = alloc_combined(&pp, &ss, num);
+	make_z_init(&zc, DOM_SIGN_BAT, buf, 64, 64, msg, num, ee);
+	zc2 = zc;
+	d = curve9767_scalar_zero;
+	r = 0;
+	for (u = 0; u < num; u ++) {
+		if (!curve9767_scalar_decode_strict(&di,
+			buf + (u << 6) + 32, 32))
+		{
+			goto cleanup;
+		}
+		next_z(&z, &zc);
+		curve9767_scalar_mul(&di, &di, &z);
+		curve9767_scalar_add(&d, &d, &di);
+	}
+	r = verify_combined(&d, buf, 64, &zc2, msg, num, ee, pp, ss);
+cleanup:
+	free_combined(ee, pp, ss);
+	return r;
+}
@@ -0,0 +1,132 @@
+#include "inner.h"
+
+/*
+ * The nonce pool is a bounded multi-producer multi-consumer queue (as
+ * described by D. Vyukov). Each entry has a sequence number which tells
+ * whether the entry is free for the producer at a given position, or
+ * holds a nonce for the consumer at that position. Positions are 32-bit
+ * counters which may wrap around; only differences between positions
+ * and sequence numbers are used.
+ *
+ * A producer first reserves an entry, then computes the nonce directly
+ * into it, and finally publishes it. A consumer reserves an entry, uses
+ * the nonce (which erases it), then releases the entry for producers.
+ * The heavy computations thus happen outside of any shared critical
+ * state, and a nonce is never visible to two consumers.
+ */
+
+static inline uint32_t
+load_acquire(uint32_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t
+load_relaxed(uint32_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static inline void
+store_release(uint32_t *p, uint32_t v)
+{
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static inline int
+cas_relaxed(uint32_t *p, uint32_t old, uint32_t v)
+{
+	return __atomic_compare_exchange_n(p, &old, v, 0,
+		__ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/*
+ * Reserve the entry at the next position of the counter *ctr. Parameter
+ * off is 0 for producers, 1 for consumers. Returned value is NULL if no
+ * entry is available (queue full for producers, queue empty for
+ * consumers). On success, *pos is set to the reserved position.
+ */
+static curve9767_sign_pool_entry *
+reserve(curve9767_sign_pool *pool, uint32_t *ctr, uint32_t off, uint32_t *pos)
+{
+	uint32_t p;
+
+	p = load_relaxed(ctr);
+	for (;;) {
+		curve9767_sign_pool_entry *ent;
+		int32_t dif;
+
+		ent = &pool->buf[p & pool->mask];
+		dif = (int32_t)(load_acquire(&ent->seq) - (p + off));
+		if (dif == 0) {
+			if (cas_relaxed(ctr, p, p + 1)) {
+				*pos = p;
+				return ent;
+			}
+			p = load_relaxed(ctr);
+		} else if (dif < 0) {
+			return NULL;
+		} else {
+			p = load_relaxed(ctr);
+		}
+	}
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_pool_init(curve9767_sign_pool *pool,
+	curve9767_sign_pool_entry *buf, size_t num)
+{
+	size_t u;
+
+	if (num == 0 || (num & (num - 1)) != 0 || num > ((size_t)1 << 31)) {
+		return 0;
+	}
+	memset(buf, 0, num * sizeof *buf);
+	for (u = 0; u < num; u ++) {
+		buf[u].seq = (uint32_t)u;
+	}
+	pool->buf = buf;
+	pool->mask = (uint32_t)(num - 1);
+	pool->head = 0;
+	pool->tail = 0;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	return 1;
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_pool_put(curve9767_sign_pool *pool,
+	const void *seed, size_t seed_len)
+{
+	curve9767_sign_pool_entry *ent;
+	uint32_t pos;
+
+	ent = reserve(pool, &pool->tail, 0, &pos);
+	if (ent == NULL) {
+		return 0;
+	}
+	curve9767_sign_nonce_generate(&ent->nonce, seed, seed_len);
+	store_release(&ent->seq, pos + 1);
+	return 1;
+}
+
+/* see curve9767.h */
+int
+curve9767_sign_pool_sign(void *sig, curve9767_sign_pool *pool,
+	const curve9767_scalar *s, const curve9767_point *Q,
+	const char *hash_oid, const void *hv, size_t hv_len)
+{
+	curve9767_sign_pool_entry *ent;
+	uint32_t pos;
+	int r;
+
+	ent = reserve(pool, &pool->head, 1, &pos);
+	if (ent == NULL) {
+		return 0;
+	}
+	r = curve9767_sign_generate_online(sig,
+		s, Q, &ent->nonce, hash_oid, hv, hv_len);
+	store_release(&ent->seq, pos + pool->mask + 1);
+	return r;
+}
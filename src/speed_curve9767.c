@@ -0,0 +1,1813 @@
+#if defined __linux__ && !defined _GNU_SOURCE
+/* for pthread_setaffinity_np() */
+#define _GNU_SOURCE   1
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#if defined __linux__
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#define SPEED_PERF   1
+#else
+#define SPEED_PERF   0
+#endif
+
+#if defined __x86_64__ || defined __i386__
+#include <x86intrin.h>
+#define SPEED_RDTSC   1
+#else
+#define SPEED_RDTSC   0
+#endif
+
+#include "inner.h"
+
+/*
+ * Benchmark harness. Each benchmark is an entry in the bench_list[]
+ * registry, with an initialization function (which prepares the inputs
+ * in a context structure) and a run function (which performs one
+ * instance of the benchmarked operation). The harness runs a number
+ * of warm-up invocations, then measures each of a number of invocations
+ * individually, and reports the median, 90th and 99th percentiles. It
+ * then runs the same number of invocations in a single timed batch to
+ * obtain the throughput (ns/op and ops/s).
+ *
+ * On x86, individual measures are in clock cycles (rdtsc, serialized
+ * with lfence; this is the invariant TSC frequency, not necessarily the
+ * core frequency). On other architectures, they are in nanoseconds.
+ *
+ * With the -t option, the harness runs in throughput mode instead:
+ * for each listed thread count, that many threads (each with its own
+ * context, pinned to distinct CPUs when possible) run the operation
+ * in a loop for a fixed duration. The aggregate throughput (ops/s,
+ * summed over all threads) is reported, along with the median and
+ * 99th percentile latency over all operations, and the worst
+ * per-thread 99th percentile. This shows how operations scale with the
+ * number of cores, including effects of the shared precomputed tables
+ * and of frequency changes under load.
+ *
+ * With the -p option (Linux only), hardware performance counters are
+ * also read (with perf_event_open()) around the batch of invocations,
+ * and the average number of core cycles, instructions, branches,
+ * branch misses and L1 data cache read misses per operation are
+ * reported, along with the IPC. Unlike the TSC, these are core cycles.
+ * Counters that the CPU (or virtual machine) does not provide are
+ * omitted; if perf_event_open() fails altogether (e.g. because of
+ * the kernel.perf_event_paranoid setting), a warning is printed and
+ * only the timer-based measures are reported.
+ *
+ * With the -s option, the harness instead reports, for each selected
+ * benchmark, the number of field and scalar primitive invocations
+ * performed by one instance of the operation. This requires the library
+ * to be compiled with CURVE9767_STATS=1 (see curve9767_stats).
+ *
+ * With the -k option, the harness reports, for each selected benchmark,
+ * the peak stack usage (in bytes) of one instance of the operation,
+ * measured by stack painting: the operation runs in a thread whose
+ * stack is a buffer filled with a known pattern, and the overwritten
+ * part of the buffer is measured afterwards. The usage of an empty
+ * thread is subtracted. Compiling the library with CURVE9767_LOWRAM=1
+ * (see inner.h) shows the savings of the low-RAM profile.
+ *
+ * Usage: speed_curve9767 [options] [name...]
+ *   -n num     number of measured invocations per benchmark (default: 1000)
+ *   -w num     number of warm-up invocations per benchmark (default: 100)
+ *   -r ms      CPU ramp-up time before the first benchmark (default: 100)
+ *   -t list    throughput mode, with the comma-separated thread counts
+ *   -d ms      duration of each throughput measure (default: 1000)
+ *   -o fmt     output format: text (default), json or csv
+ *   -p         also read hardware performance counters (Linux)
+ *   -s         report operation counts instead of timings
+ *   -k         report peak stack usage instead of timings
+ *   -l         list benchmark names and exit
+ * Benchmarks are selected by name: each extra argument is a substring
+ * that is matched against benchmark names (no argument: run all; in
+ * throughput mode, run the ECDH and signature benchmarks).
+ */
+
+/*
+ * Number of distinct inputs for variable-time operations.
+ */
+#define VAR_NUM   200
+
+static const uint8_t bx[] = {
+	0xE0, 0xE9, 0x54, 0x89, 0x0D, 0x2C, 0xE9, 0x4E,
+	0x5E, 0x05, 0xB4, 0x81, 0x80, 0x02, 0x6F, 0xFB,
+	0x2B, 0x49, 0x2C, 0x1D, 0x5D, 0x3C, 0x23, 0x26,
+	0x6C, 0x4F, 0xC9, 0x6B, 0xE4, 0xBC, 0x9D, 0x13
+};
+
+static const uint8_t by[] = {
+	0x18, 0x94, 0x5A, 0x59, 0x7C, 0x2B, 0xF1, 0x98,
+	0x02, 0xAC, 0xD0, 0x4C, 0xD5, 0x30, 0xF4, 0x24,
+	0x9D, 0x11, 0xA5, 0x01, 0xBC, 0x4C, 0x18, 0x27,
+	0x7E, 0xB8, 0x3B, 0x8F, 0x26, 0x60, 0xF4, 0x0D
+};
+
+static const uint8_t bs[] = {
+	0x38, 0x9E, 0x39, 0x77, 0xCE, 0x5A, 0x72, 0x23,
+	0x0F, 0x42, 0x86, 0x6D, 0x12, 0xD8, 0x20, 0x7A,
+	0x98, 0x2F, 0x3A, 0x9E, 0x69, 0x23, 0x8A, 0x40,
+	0x75, 0x91, 0x73, 0x1D, 0x37, 0xF3, 0x7E, 0x0A
+};
+
+/*
+ * Benchmark context: inputs and outputs of the benchmarked operations.
+ * Each context is independent from the others, so that several threads
+ * may run benchmarks concurrently, each with its own context.
+ */
+typedef struct {
+	field_element x, y, z;
+	curve9767_point Q1, Q2;
+	curve9767_scalar s, s_short;
+	uint8_t t[32];
+	curve9767_sign_key sk;
+	uint8_t hv[32];
+	uint8_t sig[64];
+	uint8_t enc[32];
+	uint8_t enc_full[64];
+	uint8_t buf[48];
+	int arg;
+
+	/* inputs for variable-time operations */
+	size_t idx;
+	curve9767_scalar vs[VAR_NUM];
+	uint8_t vhv[VAR_NUM][32];
+	uint8_t vsig[VAR_NUM][64];
+} bench_context;
+
+typedef struct {
+	const char *name;
+	void (*init)(bench_context *bc);
+	void (*run)(bench_context *bc);
+	int arg;
+} bench;
+
+/* ===================================================================== */
+/*
+ * Initialization functions.
+ */
+
+static void
+init_field(bench_context *bc)
+{
+	curve9767_inner_gf_decode(bc->x.v, bx);
+	curve9767_inner_gf_decode(bc->y.v, by);
+	bc->z = bc->y;
+}
+
+static void
+init_point(bench_context *bc)
+{
+	uint8_t tmp[32];
+
+	curve9767_point_decode(&bc->Q1, bx);
+	curve9767_point_add(&bc->Q2, &bc->Q1, &bc->Q1);
+	curve9767_scalar_decode_strict(&bc->s, bs, sizeof bs);
+	memcpy(tmp, bs, 16);
+	memset(tmp + 16, 0, 16);
+	curve9767_scalar_decode_strict(&bc->s_short, tmp, sizeof tmp);
+	curve9767_point_encode(bc->enc, &bc->Q1);
+	curve9767_point_encode_full(bc->enc_full, &bc->Q1);
+}
+
+static void
+init_map(bench_context *bc)
+{
+	shake_context sc;
+
+	shake_init(&sc, 256);
+	memset(bc->buf, 0, sizeof bc->buf);
+	shake_inject(&sc, bc->buf, sizeof bc->buf);
+	shake_flip(&sc);
+	shake_extract(&sc, bc->buf, sizeof bc->buf);
+}
+
+static void
+init_reduce_basis(bench_context *bc)
+{
+	int i;
+
+	for (i = 0; i < VAR_NUM; i ++) {
+		shake_context sc;
+		uint8_t tmp[64];
+
+		tmp[0] = (uint8_t)i;
+		shake_init(&sc, 256);
+		shake_inject(&sc, tmp, 1);
+		shake_flip(&sc);
+		shake_extract(&sc, tmp, sizeof tmp);
+		curve9767_scalar_decode_reduce(&bc->vs[i], tmp, sizeof tmp);
+	}
+	bc->idx = 0;
+}
+
+static void
+init_ecdh(bench_context *bc)
+{
+	/*
+	 * We use our public key as the key received from the peer (since
+	 * the whole implementation is constant-time, it does not matter
+	 * for benchmarks which point we are using).
+	 */
+	memset(bc->t, 0, sizeof bc->t);
+	curve9767_ecdh_keygen(&bc->s, bc->enc, bc->t, sizeof bc->t);
+}
+
+static void
+init_sign(bench_context *bc)
+{
+	uint8_t seed[32];
+	int i;
+
+	/*
+	 * We use an all-zero pseudo hash value as input message (it will
+	 * get re-hashed internally for challenge generation, and the
+	 * whole code is constant-time anyway). For variable-time
+	 * verification, we use VAR_NUM distinct messages.
+	 */
+	memset(seed, 0, sizeof seed);
+	curve9767_keygen(&bc->s, bc->t, &bc->Q1, seed, sizeof seed);
+	curve9767_sign_key_init(&bc->sk, &bc->s, bc->t, &bc->Q1);
+	memset(bc->hv, 0, sizeof bc->hv);
+	curve9767_sign_generate(bc->sig, &bc->s, bc->t, &bc->Q1,
+		CURVE9767_OID_SHA3_256, bc->hv, sizeof bc->hv);
+	for (i = 0; i < VAR_NUM; i ++) {
+		memset(bc->vhv[i], 0, sizeof bc->vhv[i]);
+		bc->vhv[i][0] = (uint8_t)i;
+		curve9767_sign_generate(bc->vsig[i], &bc->s, bc->t, &bc->Q1,
+			CURVE9767_OID_SHA3_256, bc->vhv[i], sizeof bc->vhv[i]);
+	}
+	bc->idx = 0;
+}
+
+/* ===================================================================== */
+/*
+ * Benchmarked operations. Outputs are fed back into inputs when
+ * possible, so that the compiler cannot optimize away the calls.
+ */
+
+#if defined __AVX2__ || defined __aarch64__
+/*
+ * These functions are defined only in the AVX2 and NEON implementations
+ * (ops_avx2.c and ops_neon.c).
+ *
+ * curve9767_inner_gf_dummy_1() performs the decoding and encoding
+ * to/from vector registers, but with a quasi-trivial body (simple copy
+ * from input to output). This mimics the overhead of a field inversion.
+ *
+ * curve9767_inner_gf_dummy_2() performs the decoding and encoding
+ * to/from vector registers, but with a quasi-trivial body (word-wise
+ * addition, no reduction whatsoever). This mimics the overhead of a
+ * field multiplication.
+ *
+ * curve9767_inner_gf_mul_sub() computes a*b-d*e with a single Montgomery
+ * reduction (lazy reduction, as used in the point doubling and addition
+ * formulas). Compare with twice the cost of gf_mul.
+ */
+void curve9767_inner_gf_dummy_1(uint16_t *c, const uint16_t *a);
+void curve9767_inner_gf_dummy_2(uint16_t *c,
+	const uint16_t *a, const uint16_t *b);
+void curve9767_inner_gf_mul_sub(uint16_t *c, const uint16_t *a,
+	const uint16_t *b, const uint16_t *d, const uint16_t *e);
+
+static void
+run_gf_dummy_1(bench_context *bc)
+{
+	curve9767_inner_gf_dummy_1(bc->z.v, bc->x.v);
+}
+
+static void
+run_gf_dummy_2(bench_context *bc)
+{
+	curve9767_inner_gf_dummy_2(bc->z.v, bc->y.v, bc->x.v);
+}
+
+static void
+run_gf_mul_sub(bench_context *bc)
+{
+	curve9767_inner_gf_mul_sub(bc->z.v, bc->y.v, bc->x.v,
+		bc->x.v, bc->z.v);
+}
+#endif
+
+static void
+run_gf_mul(bench_context *bc)
+{
+	curve9767_inner_gf_mul(bc->z.v, bc->y.v, bc->x.v);
+}
+
+static void
+run_gf_inv(bench_context *bc)
+{
+	curve9767_inner_gf_inv(bc->z.v, bc->x.v);
+}
+
+static void
+run_gf_sqrt(bench_context *bc)
+{
+	curve9767_inner_gf_sqrt(bc->z.v, bc->x.v);
+}
+
+static void
+run_gf_isqrt(bench_context *bc)
+{
+	curve9767_inner_gf_isqrt(bc->z.v, bc->x.v);
+}
+
+static void
+run_gf_sqrt_ratio(bench_context *bc)
+{
+	curve9767_inner_gf_sqrt_ratio(bc->z.v, bc->y.v, bc->x.v);
+}
+
+static void
+run_gf_test_qr(bench_context *bc)
+{
+	curve9767_inner_gf_sqrt(NULL, bc->x.v);
+}
+
+static void
+run_gf_cubert(bench_context *bc)
+{
+	curve9767_inner_gf_cubert(bc->z.v, bc->x.v);
+}
+
+static void
+run_reduce_basis(bench_context *bc)
+{
+	uint8_t c0[16], c1[16];
+
+	curve9767_inner_reduce_basis_vartime(c0, c1, &bc->vs[bc->idx]);
+	if (++ bc->idx == VAR_NUM) {
+		bc->idx = 0;
+	}
+}
+
+static void
+run_point_add(bench_context *bc)
+{
+	curve9767_point_add(&bc->Q2, &bc->Q1, &bc->Q2);
+}
+
+static void
+run_point_mul2k(bench_context *bc)
+{
+	curve9767_point_mul2k(&bc->Q1, &bc->Q1, (unsigned)bc->arg);
+}
+
+static void
+run_point_decode(bench_context *bc)
+{
+	curve9767_point_decode(&bc->Q1, bx);
+}
+
+static void
+run_point_decode_full(bench_context *bc)
+{
+	curve9767_point_decode_full(&bc->Q1, bc->enc_full);
+}
+
+static void
+run_point_encode(bench_context *bc)
+{
+	curve9767_point_encode(bc->enc, &bc->Q1);
+}
+
+static void
+run_map_to_field(bench_context *bc)
+{
+	curve9767_inner_gf_map_to_base(bc->z.v, bc->buf);
+}
+
+static void
+run_hash_to_curve(bench_context *bc)
+{
+	shake_context sc;
+
+	shake_init(&sc, 256);
+	shake_inject(&sc, bc->buf, sizeof bc->buf);
+	shake_flip(&sc);
+	curve9767_hash_to_curve(&bc->Q1, &sc);
+}
+
+static void
+run_encode_to_curve(bench_context *bc)
+{
+	shake_context sc;
+
+	shake_init(&sc, 256);
+	shake_inject(&sc, bc->buf, sizeof bc->buf);
+	shake_flip(&sc);
+	curve9767_encode_to_curve(&bc->Q1, &sc);
+}
+
+static void
+run_point_mul(bench_context *bc)
+{
+	curve9767_point_mul(&bc->Q1, &bc->Q1, &bc->s);
+}
+
+static void
+run_point_mul_short(bench_context *bc)
+{
+	curve9767_point_mul_short(&bc->Q1, &bc->Q1,
+		&bc->s_short, (unsigned)bc->arg);
+}
+
+static void
+run_point_mulgen(bench_context *bc)
+{
+	curve9767_point_mulgen(&bc->Q1, &bc->s);
+}
+
+static void
+run_point_mul_mulgen_add(bench_context *bc)
+{
+	curve9767_point_mul_mulgen_add(&bc->Q1, &bc->Q1, &bc->s, &bc->s);
+}
+
+static void
+run_point_mul2_add(bench_context *bc)
+{
+	curve9767_point_mul2_add(&bc->Q1, &bc->Q1, &bc->s, &bc->Q2, &bc->s);
+}
+
+static void
+run_ecdh_keygen(bench_context *bc)
+{
+	curve9767_ecdh_keygen(&bc->s, bc->enc, bc->t, sizeof bc->t);
+}
+
+static void
+run_ecdh_recv(bench_context *bc)
+{
+	curve9767_ecdh_recv(bc->buf, 32, &bc->s, bc->enc);
+}
+
+static void
+run_sign_generate(bench_context *bc)
+{
+	curve9767_sign_generate(bc->sig, &bc->s, bc->t, &bc->Q1,
+		CURVE9767_OID_SHA3_256, bc->hv, sizeof bc->hv);
+}
+
+static void
+run_sign_generate_key(bench_context *bc)
+{
+	curve9767_sign_generate_key(bc->sig, &bc->sk,
+		CURVE9767_OID_SHA3_256, bc->hv, sizeof bc->hv);
+}
+
+static void
+run_sign_verify(bench_context *bc)
+{
+	curve9767_sign_verify(bc->sig, &bc->Q1,
+		CURVE9767_OID_SHA3_256, bc->hv, sizeof bc->hv);
+}
+
+static void
+run_sign_verify_vartime(bench_context *bc)
+{
+	curve9767_sign_verify_vartime(bc->vsig[bc->idx], &bc->Q1,
+		CURVE9767_OID_SHA3_256, bc->vhv[bc->idx], sizeof bc->vhv[0]);
+	if (++ bc->idx == VAR_NUM) {
+		bc->idx = 0;
+	}
+}
+
+static const bench bench_list[] = {
+#if defined __AVX2__ || defined __aarch64__
+	{ "gf_dummy_1", init_field, run_gf_dummy_1, 0 },
+	{ "gf_dummy_2", init_field, run_gf_dummy_2, 0 },
+#endif
+	{ "gf_mul", init_field, run_gf_mul, 0 },
+#if defined __AVX2__ || defined __aarch64__
+	{ "gf_mul_sub", init_field, run_gf_mul_sub, 0 },
+#endif
+	{ "gf_inv", init_field, run_gf_inv, 0 },
+	{ "gf_sqrt", init_field, run_gf_sqrt, 0 },
+	{ "gf_isqrt", init_field, run_gf_isqrt, 0 },
+	{ "gf_sqrt_ratio", init_field, run_gf_sqrt_ratio, 0 },
+	{ "gf_test_qr", init_field, run_gf_test_qr, 0 },
+	{ "gf_cubert", init_field, run_gf_cubert, 0 },
+	{ "reduce_basis", init_reduce_basis, run_reduce_basis, 0 },
+	{ "point_add", init_point, run_point_add, 0 },
+	{ "point_mul2k_1", init_point, run_point_mul2k, 1 },
+	{ "point_mul2k_2", init_point, run_point_mul2k, 2 },
+	{ "point_mul2k_3", init_point, run_point_mul2k, 3 },
+	{ "point_mul2k_4", init_point, run_point_mul2k, 4 },
+	{ "point_mul2k_5", init_point, run_point_mul2k, 5 },
+	{ "point_decode", init_point, run_point_decode, 0 },
+	{ "point_decode_full", init_point, run_point_decode_full, 0 },
+	{ "point_encode", init_point, run_point_encode, 0 },
+	{ "map_to_field", init_map, run_map_to_field, 0 },
+	{ "hash_to_curve", init_map, run_hash_to_curve, 0 },
+	{ "encode_to_curve", init_map, run_encode_to_curve, 0 },
+	{ "point_mul", init_point, run_point_mul, 0 },
+	{ "point_mul_short_128", init_point, run_point_mul_short, 128 },
+	{ "point_mulgen", init_point, run_point_mulgen, 0 },
+	{ "point_mul_mulgen_add", init_point, run_point_mul_mulgen_add, 0 },
+	{ "point_mul2_add", init_point, run_point_mul2_add, 0 },
+	{ "ecdh_keygen", init_ecdh, run_ecdh_keygen, 0 },
+	{ "ecdh_recv", init_ecdh, run_ecdh_recv, 0 },
+	{ "sign_generate", init_sign, run_sign_generate, 0 },
+	{ "sign_generate_key", init_sign, run_sign_generate_key, 0 },
+	{ "sign_verify", init_sign, run_sign_verify, 0 },
+	{ "sign_verify_vartime", init_sign, run_sign_verify_vartime, 0 },
+	{ NULL, 0, 0, 0 }
+};
+
+/* ===================================================================== */
+/*
+ * Timing and statistics.
+ */
+
+/*
+ * Get current monotonic time, in nanoseconds.
+ */
+static uint64_t
+get_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Get current time for individual measures (cycles on x86, nanoseconds
+ * otherwise).
+ */
+static inline uint64_t
+get_ticks(void)
+{
+#if SPEED_RDTSC
+	_mm_lfence();
+	return __rdtsc();
+#else
+	return get_ns();
+#endif
+}
+
+static const char *const ticks_unit = SPEED_RDTSC ? "cycles" : "ns";
+
+static int
+cmp_u64(const void *v1, const void *v2)
+{
+	uint64_t x1, x2;
+
+	x1 = *(const uint64_t *)v1;
+	x2 = *(const uint64_t *)v2;
+	return (x1 > x2) - (x1 < x2);
+}
+
+/*
+ * Get a percentile (nearest rank) out of a sorted array of n samples.
+ */
+static uint64_t
+percentile(const uint64_t *tt, size_t n, unsigned q)
+{
+	size_t k;
+
+	k = (n * q + 99) / 100;
+	if (k > 0) {
+		k --;
+	}
+	return tt[k];
+}
+
+/*
+ * Hardware performance counters (Linux perf_event). All counters are
+ * opened as a single group, so that they are scheduled together; they
+ * count only user-space events of the calling thread.
+ */
+
+enum {
+	PC_CYCLES,
+	PC_INSTRUCTIONS,
+	PC_BRANCHES,
+	PC_BRANCH_MISSES,
+	PC_L1D_MISSES,
+	PC_NUM
+};
+
+static const char *const pc_names[PC_NUM] = {
+	"cycles", "instructions", "branches", "branch_misses", "l1d_misses"
+};
+
+typedef struct {
+	int fd[PC_NUM];
+	int pos[PC_NUM];
+	int num;
+} perf_group;
+
+#if SPEED_PERF
+
+static int
+perf_open_event(uint32_t type, uint64_t config, int group_fd)
+{
+	struct perf_event_attr pe;
+
+	memset(&pe, 0, sizeof pe);
+	pe.size = sizeof pe;
+	pe.type = type;
+	pe.config = config;
+	pe.disabled = group_fd < 0;
+	pe.exclude_kernel = 1;
+	pe.exclude_hv = 1;
+	pe.read_format = PERF_FORMAT_GROUP
+		| PERF_FORMAT_TOTAL_TIME_ENABLED
+		| PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return (int)syscall(SYS_perf_event_open, &pe, 0, -1, group_fd, 0);
+}
+
+/*
+ * Open the counters. Returned value is 1 on success, 0 if the cycle
+ * counter (group leader) could not be opened. Other counters are
+ * optional: those that cannot be opened are marked with fd = -1.
+ */
+static int
+perf_open(perf_group *pg)
+{
+	static const struct {
+		uint32_t type;
+		uint64_t config;
+	} ev[PC_NUM] = {
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+			| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) }
+	};
+	int i;
+
+	pg->num = 0;
+	for (i = 0; i < PC_NUM; i ++) {
+		pg->fd[i] = perf_open_event(ev[i].type, ev[i].config,
+			i == 0 ? -1 : pg->fd[0]);
+		if (pg->fd[i] < 0) {
+			if (i == 0) {
+				return 0;
+			}
+			pg->fd[i] = -1;
+			pg->pos[i] = -1;
+		} else {
+			pg->pos[i] = pg->num ++;
+		}
+	}
+	return 1;
+}
+
+static void
+perf_close(perf_group *pg)
+{
+	int i;
+
+	for (i = PC_NUM - 1; i >= 0; i --) {
+		if (pg->fd[i] >= 0) {
+			close(pg->fd[i]);
+		}
+	}
+}
+
+static void
+perf_start(perf_group *pg)
+{
+	ioctl(pg->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(pg->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+/*
+ * Stop the counters and get their values into v[] (-1 for unavailable
+ * counters). If the group was multiplexed with other events, values
+ * are scaled to the full enabled time.
+ */
+static void
+perf_stop(perf_group *pg, double *v)
+{
+	uint64_t buf[3 + PC_NUM];
+	double scale;
+	ssize_t len;
+	int i;
+
+	ioctl(pg->fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	len = read(pg->fd[0], buf, sizeof buf);
+	if (len < (ssize_t)((3 + pg->num) * sizeof buf[0])
+		|| buf[0] != (uint64_t)pg->num || buf[2] == 0)
+	{
+		for (i = 0; i < PC_NUM; i ++) {
+			v[i] = -1.0;
+		}
+		return;
+	}
+	scale = (double)buf[1] / (double)buf[2];
+	for (i = 0; i < PC_NUM; i ++) {
+		v[i] = pg->pos[i] < 0 ? -1.0
+			: (double)buf[3 + pg->pos[i]] * scale;
+	}
+}
+
+#else
+
+static int
+perf_open(perf_group *pg)
+{
+	(void)pg;
+	return 0;
+}
+
+static void
+perf_close(perf_group *pg)
+{
+	(void)pg;
+}
+
+static void
+perf_start(perf_group *pg)
+{
+	(void)pg;
+}
+
+static void
+perf_stop(perf_group *pg, double *v)
+{
+	int i;
+
+	(void)pg;
+	for (i = 0; i < PC_NUM; i ++) {
+		v[i] = -1.0;
+	}
+}
+
+#endif
+
+typedef struct {
+	const char *name;
+	size_t iterations;
+	uint64_t median, p90, p99;
+	double ns_per_op;
+	double pc[PC_NUM];  /* per operation; negative: unavailable */
+} bench_result;
+
+/*
+ * Run a benchmark: warm-up, then num individual measures (sorted into
+ * tt[]), then a batch of num invocations for throughput. If pg is not
+ * NULL, hardware counters are read around the batch.
+ */
+static void
+run_bench(bench_result *br, const bench *b, bench_context *bc,
+	size_t warmup, size_t num, uint64_t *tt, perf_group *pg)
+{
+	size_t i;
+	int j;
+	uint64_t begin, end;
+
+	bc->arg = b->arg;
+	b->init(bc);
+
+	/*
+	 * Some blank invocations to fill caches and train branch prediction.
+	 */
+	for (i = 0; i < warmup; i ++) {
+		b->run(bc);
+	}
+
+	for (i = 0; i < num; i ++) {
+		begin = get_ticks();
+		b->run(bc);
+		end = get_ticks();
+		tt[i] = end - begin;
+	}
+	qsort(tt, num, sizeof *tt, cmp_u64);
+
+	if (pg != NULL) {
+		perf_start(pg);
+	}
+	begin = get_ns();
+	for (i = 0; i < num; i ++) {
+		b->run(bc);
+	}
+	end = get_ns();
+	if (pg != NULL) {
+		perf_stop(pg, br->pc);
+	} else {
+		for (j = 0; j < PC_NUM; j ++) {
+			br->pc[j] = -1.0;
+		}
+	}
+	for (j = 0; j < PC_NUM; j ++) {
+		if (br->pc[j] >= 0.0) {
+			br->pc[j] /= (double)num;
+		}
+	}
+
+	br->name = b->name;
+	br->iterations = num;
+	br->median = percentile(tt, num, 50);
+	br->p90 = percentile(tt, num, 90);
+	br->p99 = percentile(tt, num, 99);
+	br->ns_per_op = (double)(end - begin) / (double)num;
+}
+
+/*
+ * Run some curve operations for the specified time, in order to ensure
+ * that the CPU frequency scaled up to nominal.
+ */
+static void
+ramp_up(unsigned ms)
+{
+	curve9767_point Q;
+	curve9767_scalar s;
+	uint64_t limit;
+
+	curve9767_point_decode(&Q, bx);
+	curve9767_scalar_decode_strict(&s, bs, sizeof bs);
+	limit = get_ns() + (uint64_t)ms * 1000000;
+	while (get_ns() < limit) {
+		curve9767_point_mul(&Q, &Q, &s);
+	}
+}
+
+/* ===================================================================== */
+/*
+ * Throughput mode.
+ */
+
+/*
+ * Maximum number of threads, and number of latency samples kept per
+ * thread (the most recent ones). TP_SAMPLES must be a power of two.
+ */
+#define TP_MAX_THREADS   256
+#define TP_SAMPLES       65536
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	unsigned ready;
+	int go;
+	int stop;
+} tp_control;
+
+typedef struct {
+	pthread_t tid;
+	const bench *b;
+	tp_control *ctl;
+	unsigned cpu;
+	size_t warmup;
+	bench_context *bc;
+	uint64_t *tt;
+	uint64_t count;
+	uint64_t elapsed;
+} tp_thread;
+
+/*
+ * Pin the current thread to the specified CPU. This is best effort;
+ * on systems other than Linux, this does nothing.
+ */
+static void
+pin_thread(unsigned cpu)
+{
+#if defined __linux__
+	cpu_set_t cs;
+
+	CPU_ZERO(&cs);
+	CPU_SET(cpu % CPU_SETSIZE, &cs);
+	pthread_setaffinity_np(pthread_self(), sizeof cs, &cs);
+#else
+	(void)cpu;
+#endif
+}
+
+static void *
+tp_worker(void *arg)
+{
+	tp_thread *th;
+	tp_control *ctl;
+	size_t i;
+	uint64_t n, begin;
+
+	th = arg;
+	ctl = th->ctl;
+	pin_thread(th->cpu);
+	th->bc->arg = th->b->arg;
+	th->b->init(th->bc);
+	for (i = 0; i < th->warmup; i ++) {
+		th->b->run(th->bc);
+	}
+
+	/*
+	 * Wait for all threads to be ready.
+	 */
+	pthread_mutex_lock(&ctl->lock);
+	ctl->ready ++;
+	pthread_cond_broadcast(&ctl->cond);
+	while (!ctl->go) {
+		pthread_cond_wait(&ctl->cond, &ctl->lock);
+	}
+	pthread_mutex_unlock(&ctl->lock);
+
+	n = 0;
+	begin = get_ns();
+	while (!__atomic_load_n(&ctl->stop, __ATOMIC_RELAXED)) {
+		uint64_t t0, t1;
+
+		t0 = get_ticks();
+		th->b->run(th->bc);
+		t1 = get_ticks();
+		th->tt[n & (TP_SAMPLES - 1)] = t1 - t0;
+		n ++;
+	}
+	th->elapsed = get_ns() - begin;
+	th->count = n;
+	return NULL;
+}
+
+typedef struct {
+	const char *name;
+	unsigned threads;
+	double ops_per_s;
+	uint64_t median, p99, worst_p99;
+} tp_result;
+
+/*
+ * Run a benchmark with the specified number of threads, for the
+ * specified duration (in milliseconds). Returned value is 1 on success,
+ * 0 on error (threads could not be started).
+ */
+static int
+run_throughput(tp_result *tr, const bench *b, tp_thread *ths,
+	unsigned nth, size_t warmup, unsigned ms, uint64_t *all)
+{
+	tp_control ctl;
+	struct timespec ts;
+	unsigned i, ncpu, started;
+	size_t num_all;
+	long x;
+
+	x = sysconf(_SC_NPROCESSORS_ONLN);
+	ncpu = x > 0 ? (unsigned)x : 1;
+	pthread_mutex_init(&ctl.lock, NULL);
+	pthread_cond_init(&ctl.cond, NULL);
+	ctl.ready = 0;
+	ctl.go = 0;
+	ctl.stop = 0;
+
+	for (started = 0; started < nth; started ++) {
+		tp_thread *th;
+
+		th = &ths[started];
+		th->b = b;
+		th->ctl = &ctl;
+		th->cpu = started % ncpu;
+		th->warmup = warmup;
+		th->count = 0;
+		th->elapsed = 0;
+		if (pthread_create(&th->tid, NULL, tp_worker, th) != 0) {
+			break;
+		}
+	}
+
+	/*
+	 * Start all threads at once, let them run for the requested
+	 * duration, then stop them. If some threads could not be created,
+	 * then we stop the others immediately.
+	 */
+	pthread_mutex_lock(&ctl.lock);
+	while (ctl.ready < started) {
+		pthread_cond_wait(&ctl.cond, &ctl.lock);
+	}
+	ctl.go = 1;
+	pthread_cond_broadcast(&ctl.cond);
+	pthread_mutex_unlock(&ctl.lock);
+	if (started == nth) {
+		ts.tv_sec = ms / 1000;
+		ts.tv_nsec = (long)(ms % 1000) * 1000000;
+		nanosleep(&ts, NULL);
+	}
+	__atomic_store_n(&ctl.stop, 1, __ATOMIC_RELAXED);
+	for (i = 0; i < started; i ++) {
+		pthread_join(ths[i].tid, NULL);
+	}
+	pthread_cond_destroy(&ctl.cond);
+	pthread_mutex_destroy(&ctl.lock);
+	if (started != nth) {
+		return 0;
+	}
+
+	/*
+	 * Aggregate the results.
+	 */
+	tr->name = b->name;
+	tr->threads = nth;
+	tr->ops_per_s = 0.0;
+	tr->worst_p99 = 0;
+	num_all = 0;
+	for (i = 0; i < nth; i ++) {
+		tp_thread *th;
+		size_t n;
+		uint64_t p99;
+
+		th = &ths[i];
+		if (th->count == 0) {
+			continue;
+		}
+		if (th->elapsed > 0) {
+			tr->ops_per_s += (double)th->count * 1000000000.0
+				/ (double)th->elapsed;
+		}
+		n = th->count < TP_SAMPLES ? (size_t)th->count : TP_SAMPLES;
+		qsort(th->tt, n, sizeof *th->tt, cmp_u64);
+		p99 = percentile(th->tt, n, 99);
+		if (p99 > tr->worst_p99) {
+			tr->worst_p99 = p99;
+		}
+		memcpy(all + num_all, th->tt, n * sizeof *all);
+		num_all += n;
+	}
+	if (num_all > 0) {
+		qsort(all, num_all, sizeof *all, cmp_u64);
+		tr->median = percentile(all, num_all, 50);
+		tr->p99 = percentile(all, num_all, 99);
+	} else {
+		tr->median = 0;
+		tr->p99 = 0;
+	}
+	return 1;
+}
+
+/* ===================================================================== */
+/*
+ * Output.
+ */
+
+enum { FMT_TEXT, FMT_JSON, FMT_CSV };
+
+/*
+ * Per-operation hardware counter columns (with -p). In text output,
+ * unavailable counters are shown as "-"; in JSON, they are null; in
+ * CSV, they are empty.
+ */
+static const char *const pc_text_names[PC_NUM] = {
+	"cycles/op", "instr/op", "branch/op", "br-miss/op", "l1d-miss/op"
+};
+
+static double
+get_ipc(const bench_result *br)
+{
+	if (br->pc[PC_CYCLES] <= 0.0 || br->pc[PC_INSTRUCTIONS] < 0.0) {
+		return -1.0;
+	}
+	return br->pc[PC_INSTRUCTIONS] / br->pc[PC_CYCLES];
+}
+
+static void
+print_pc_value(int fmt, double v, int prec)
+{
+	switch (fmt) {
+	case FMT_TEXT:
+		if (v < 0.0) {
+			printf(" %11s", "-");
+		} else {
+			printf(" %11.*f", prec, v);
+		}
+		break;
+	case FMT_JSON:
+		if (v < 0.0) {
+			printf("null");
+		} else {
+			printf("%.*f", prec, v);
+		}
+		break;
+	case FMT_CSV:
+		if (v >= 0.0) {
+			printf("%.*f", prec, v);
+		}
+		break;
+	}
+}
+
+static void
+print_header(int fmt, int perf)
+{
+	int j;
+
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%-22s %12s %12s %12s %12s %14s", "name",
+			"median", "p90", "p99", "ns/op", "ops/s");
+		if (perf) {
+			for (j = 0; j < PC_NUM; j ++) {
+				printf(" %11s", pc_text_names[j]);
+			}
+			printf(" %11s", "IPC");
+		}
+		printf("\n");
+		printf("%-22s %12s %12s %12s\n", "",
+			ticks_unit, ticks_unit, ticks_unit);
+		break;
+	case FMT_JSON:
+		printf("{\n  \"unit\": \"%s\",\n  \"results\": [", ticks_unit);
+		break;
+	case FMT_CSV:
+		printf("name,unit,iterations,median,p90,p99,"
+			"ns_per_op,ops_per_s");
+		if (perf) {
+			for (j = 0; j < PC_NUM; j ++) {
+				printf(",%s", pc_names[j]);
+			}
+			printf(",ipc");
+		}
+		printf("\n");
+		break;
+	}
+}
+
+static void
+print_result(int fmt, const bench_result *br, int first, int perf)
+{
+	double ops;
+	int j;
+
+	ops = br->ns_per_op > 0.0 ? 1000000000.0 / br->ns_per_op : 0.0;
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%-22s %12llu %12llu %12llu %12.1f %14.2f", br->name,
+			(unsigned long long)br->median,
+			(unsigned long long)br->p90,
+			(unsigned long long)br->p99,
+			br->ns_per_op, ops);
+		if (perf) {
+			for (j = 0; j < PC_NUM; j ++) {
+				print_pc_value(fmt, br->pc[j], 1);
+			}
+			print_pc_value(fmt, get_ipc(br), 2);
+		}
+		printf("\n");
+		break;
+	case FMT_JSON:
+		printf("%s\n    { \"name\": \"%s\", \"iterations\": %lu,"
+			" \"median\": %llu, \"p90\": %llu, \"p99\": %llu,"
+			" \"ns_per_op\": %.1f, \"ops_per_s\": %.2f",
+			first ? "" : ",", br->name,
+			(unsigned long)br->iterations,
+			(unsigned long long)br->median,
+			(unsigned long long)br->p90,
+			(unsigned long long)br->p99,
+			br->ns_per_op, ops);
+		if (perf) {
+			printf(", \"perf\": {");
+			for (j = 0; j < PC_NUM; j ++) {
+				printf(" \"%s\": ", pc_names[j]);
+				print_pc_value(fmt, br->pc[j], 1);
+				printf(",");
+			}
+			printf(" \"ipc\": ");
+			print_pc_value(fmt, get_ipc(br), 2);
+			printf(" }");
+		}
+		printf(" }");
+		break;
+	case FMT_CSV:
+		printf("%s,%s,%lu,%llu,%llu,%llu,%.1f,%.2f",
+			br->name, ticks_unit, (unsigned long)br->iterations,
+			(unsigned long long)br->median,
+			(unsigned long long)br->p90,
+			(unsigned long long)br->p99,
+			br->ns_per_op, ops);
+		if (perf) {
+			for (j = 0; j < PC_NUM; j ++) {
+				printf(",");
+				print_pc_value(fmt, br->pc[j], 1);
+			}
+			printf(",");
+			print_pc_value(fmt, get_ipc(br), 2);
+		}
+		printf("\n");
+		break;
+	}
+	fflush(stdout);
+}
+
+static void
+print_tp_header(int fmt)
+{
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%-22s %7s %14s %14s %12s %12s %12s\n", "name",
+			"threads", "ops/s", "ops/s/thread",
+			"median", "p99", "worst p99");
+		printf("%-22s %7s %14s %14s %12s %12s %12s\n", "", "", "", "",
+			ticks_unit, ticks_unit, ticks_unit);
+		break;
+	case FMT_JSON:
+		printf("{\n  \"unit\": \"%s\",\n  \"throughput\": [",
+			ticks_unit);
+		break;
+	case FMT_CSV:
+		printf("name,unit,threads,ops_per_s,ops_per_s_per_thread,"
+			"median,p99,worst_p99\n");
+		break;
+	}
+}
+
+static void
+print_tp_result(int fmt, const tp_result *tr, int first)
+{
+	double opt;
+
+	opt = tr->ops_per_s / (double)tr->threads;
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%-22s %7u %14.2f %14.2f %12llu %12llu %12llu\n",
+			tr->name, tr->threads, tr->ops_per_s, opt,
+			(unsigned long long)tr->median,
+			(unsigned long long)tr->p99,
+			(unsigned long long)tr->worst_p99);
+		break;
+	case FMT_JSON:
+		printf("%s\n    { \"name\": \"%s\", \"threads\": %u,"
+			" \"ops_per_s\": %.2f, \"ops_per_s_per_thread\": %.2f,"
+			" \"median\": %llu, \"p99\": %llu,"
+			" \"worst_p99\": %llu }",
+			first ? "" : ",", tr->name, tr->threads,
+			tr->ops_per_s, opt,
+			(unsigned long long)tr->median,
+			(unsigned long long)tr->p99,
+			(unsigned long long)tr->worst_p99);
+		break;
+	case FMT_CSV:
+		printf("%s,%s,%u,%.2f,%.2f,%llu,%llu,%llu\n",
+			tr->name, ticks_unit, tr->threads, tr->ops_per_s, opt,
+			(unsigned long long)tr->median,
+			(unsigned long long)tr->p99,
+			(unsigned long long)tr->worst_p99);
+		break;
+	}
+	fflush(stdout);
+}
+
+/*
+ * Operation counters, in the order of curve9767_stats.
+ */
+#define STATS_FIELD(name)   { #name, offsetof(curve9767_stats, name) }
+
+static const struct {
+	const char *name;
+	size_t off;
+} stats_fields[] = {
+	STATS_FIELD(gf_add),
+	STATS_FIELD(gf_sub),
+	STATS_FIELD(gf_neg),
+	STATS_FIELD(gf_mul),
+	STATS_FIELD(gf_sqr),
+	STATS_FIELD(gf_mul_const),
+	STATS_FIELD(gf_frob),
+	STATS_FIELD(gf_inv),
+	STATS_FIELD(gf_sqrt),
+	STATS_FIELD(gf_cubert),
+	STATS_FIELD(scalar_add),
+	STATS_FIELD(scalar_mul),
+	STATS_FIELD(scalar_reduce),
+	STATS_FIELD(scalar_reduce_basis)
+};
+
+#define STATS_NUM   (sizeof stats_fields / sizeof stats_fields[0])
+
+static uint64_t
+stats_value(const curve9767_stats *st, size_t k)
+{
+	uint64_t x;
+
+	memcpy(&x, (const unsigned char *)st + stats_fields[k].off, sizeof x);
+	return x;
+}
+
+static void
+print_stats_header(int fmt)
+{
+	switch (fmt) {
+	case FMT_JSON:
+		printf("{\n  \"counters\": [");
+		break;
+	case FMT_CSV:
+		printf("name,counter,count\n");
+		break;
+	}
+}
+
+/*
+ * In text output, only non-zero counters are printed.
+ */
+static void
+print_stats(int fmt, const char *name, const curve9767_stats *st, int first)
+{
+	size_t k;
+
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%s%s\n", first ? "" : "\n", name);
+		for (k = 0; k < STATS_NUM; k ++) {
+			uint64_t x;
+
+			x = stats_value(st, k);
+			if (x != 0) {
+				printf("  %-20s %12llu\n", stats_fields[k].name,
+					(unsigned long long)x);
+			}
+		}
+		break;
+	case FMT_JSON:
+		printf("%s\n    { \"name\": \"%s\"", first ? "" : ",", name);
+		for (k = 0; k < STATS_NUM; k ++) {
+			printf(", \"%s\": %llu", stats_fields[k].name,
+				(unsigned long long)stats_value(st, k));
+		}
+		printf(" }");
+		break;
+	case FMT_CSV:
+		for (k = 0; k < STATS_NUM; k ++) {
+			printf("%s,%s,%llu\n", name, stats_fields[k].name,
+				(unsigned long long)stats_value(st, k));
+		}
+		break;
+	}
+	fflush(stdout);
+}
+
+static void
+print_footer(int fmt)
+{
+	if (fmt == FMT_JSON) {
+		printf("\n  ]\n}\n");
+	}
+}
+
+/* ===================================================================== */
+/*
+ * Stack usage measure (stack painting). This assumes that the stack
+ * grows downward (toward lower addresses), which is the case on all
+ * supported architectures.
+ */
+
+#define STACK_SIZE      ((size_t)1 << 20)
+#define STACK_PATTERN   0xA5
+
+typedef struct {
+	const bench *b;
+	bench_context *bc;
+} stack_job;
+
+static void *
+stack_worker(void *arg)
+{
+	stack_job *sj;
+
+	sj = arg;
+	if (sj->b != NULL) {
+		sj->b->run(sj->bc);
+	}
+	return NULL;
+}
+
+/*
+ * Run one instance of the operation (nothing, if b is NULL) in a thread
+ * that uses the provided stack buffer (of size STACK_SIZE), and return
+ * the number of bytes of the buffer that were used. On error, 0 is
+ * returned.
+ */
+static size_t
+stack_run(const bench *b, bench_context *bc, unsigned char *stk)
+{
+	pthread_attr_t attr;
+	pthread_t tid;
+	stack_job sj;
+	size_t u;
+	int r;
+
+	memset(stk, STACK_PATTERN, STACK_SIZE);
+	if (pthread_attr_init(&attr) != 0) {
+		return 0;
+	}
+	sj.b = b;
+	sj.bc = bc;
+	r = pthread_attr_setstack(&attr, stk, STACK_SIZE) == 0
+		&& pthread_create(&tid, &attr, stack_worker, &sj) == 0;
+	pthread_attr_destroy(&attr);
+	if (!r) {
+		return 0;
+	}
+	pthread_join(tid, NULL);
+	for (u = 0; u < STACK_SIZE; u ++) {
+		if (stk[u] != STACK_PATTERN) {
+			break;
+		}
+	}
+	return STACK_SIZE - u;
+}
+
+static void
+print_stack_header(int fmt, size_t base)
+{
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%-22s %12s\n", "name", "stack");
+		printf("%-22s %12s   (thread overhead: %lu bytes)\n", "",
+			"bytes", (unsigned long)base);
+		break;
+	case FMT_JSON:
+		printf("{\n  \"thread_overhead\": %lu,\n  \"stack\": [",
+			(unsigned long)base);
+		break;
+	case FMT_CSV:
+		printf("name,stack_bytes\n");
+		break;
+	}
+}
+
+static void
+print_stack(int fmt, const char *name, size_t len, int first)
+{
+	switch (fmt) {
+	case FMT_TEXT:
+		printf("%-22s %12lu\n", name, (unsigned long)len);
+		break;
+	case FMT_JSON:
+		printf("%s\n    { \"name\": \"%s\", \"stack_bytes\": %lu }",
+			first ? "" : ",", name, (unsigned long)len);
+		break;
+	case FMT_CSV:
+		printf("%s,%lu\n", name, (unsigned long)len);
+		break;
+	}
+	fflush(stdout);
+}
+
+/* ===================================================================== */
+
+static void
+usage(const char *pname)
+{
+	fprintf(stderr,
+"usage: %s [options] [name...]\n"
+"options:\n"
+"   -n num     number of measured invocations (default: 1000)\n"
+"   -w num     number of warm-up invocations (default: 100)\n"
+"   -r ms      CPU ramp-up time before benchmarks (default: 100)\n"
+"   -t list    throughput mode, with comma-separated thread counts\n"
+"   -d ms      duration of each throughput measure (default: 1000)\n"
+"   -o fmt     output format: text, json or csv (default: text)\n"
+"   -p         also read hardware performance counters (Linux)\n"
+"   -s         report operation counts (needs CURVE9767_STATS=1)\n"
+"   -k         report peak stack usage\n"
+"   -l         list benchmark names\n"
+"Only benchmarks whose name contains one of the provided names are run\n"
+"(default: all; in throughput mode: ECDH and signatures).\n", pname);
+	exit(EXIT_FAILURE);
+}
+
+static int
+selected(const char *name, char **filters, int num_filters)
+{
+	int i;
+
+	if (num_filters == 0) {
+		return 1;
+	}
+	for (i = 0; i < num_filters; i ++) {
+		if (strstr(name, filters[i]) != NULL) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static unsigned long
+parse_num(const char *pname, const char *s)
+{
+	char *end;
+	unsigned long x;
+
+	x = strtoul(s, &end, 10);
+	if (*s == 0 || *end != 0) {
+		usage(pname);
+	}
+	return x;
+}
+
+/*
+ * Parse a comma-separated list of thread counts. Returned value is the
+ * number of entries.
+ */
+static int
+parse_threads(const char *pname, char *s, unsigned *nth, int max)
+{
+	int n;
+	char *t;
+
+	n = 0;
+	for (t = strtok(s, ","); t != NULL; t = strtok(NULL, ",")) {
+		unsigned long x;
+
+		x = parse_num(pname, t);
+		if (x == 0 || x > TP_MAX_THREADS || n >= max) {
+			usage(pname);
+		}
+		nth[n ++] = (unsigned)x;
+	}
+	if (n == 0) {
+		usage(pname);
+	}
+	return n;
+}
+
+/*
+ * Benchmarks run in throughput mode when no name is provided.
+ */
+static char *tp_default_filters[] = { "ecdh_", "sign_" };
+
+int
+main(int argc, char *argv[])
+{
+	size_t warmup, num;
+	unsigned ramp, duration;
+	unsigned tp_threads[32];
+	int num_tp, fmt, i, first, stats, perf, stack;
+	perf_group pg;
+	char **filters;
+	int num_filters;
+	bench_context *bc;
+	uint64_t *tt;
+	const bench *b;
+
+	warmup = 100;
+	num = 1000;
+	ramp = 100;
+	duration = 1000;
+	num_tp = 0;
+	fmt = FMT_TEXT;
+	stats = 0;
+	perf = 0;
+	stack = 0;
+	filters = argv + 1;
+	num_filters = 0;
+	for (i = 1; i < argc; i ++) {
+		const char *opt;
+
+		opt = argv[i];
+		if (strcmp(opt, "-l") == 0) {
+			for (b = bench_list; b->name != NULL; b ++) {
+				printf("%s\n", b->name);
+			}
+			return 0;
+		}
+		if (strcmp(opt, "-s") == 0) {
+			stats = 1;
+			continue;
+		}
+		if (strcmp(opt, "-p") == 0) {
+			perf = 1;
+			continue;
+		}
+		if (strcmp(opt, "-k") == 0) {
+			stack = 1;
+			continue;
+		}
+		if (opt[0] != '-') {
+			filters[num_filters ++] = argv[i];
+			continue;
+		}
+		if (opt[1] == 0 || opt[2] != 0 || i + 1 >= argc) {
+			usage(argv[0]);
+		}
+		switch (opt[1]) {
+		case 'n':
+			num = parse_num(argv[0], argv[++ i]);
+			if (num == 0) {
+				usage(argv[0]);
+			}
+			break;
+		case 'w':
+			warmup = parse_num(argv[0], argv[++ i]);
+			break;
+		case 'r':
+			ramp = (unsigned)parse_num(argv[0], argv[++ i]);
+			break;
+		case 't':
+			i ++;
+			num_tp = parse_threads(argv[0], argv[i], tp_threads,
+				(int)(sizeof tp_threads / sizeof *tp_threads));
+			break;
+		case 'd':
+			duration = (unsigned)parse_num(argv[0], argv[++ i]);
+			break;
+		case 'o':
+			i ++;
+			if (strcmp(argv[i], "text") == 0) {
+				fmt = FMT_TEXT;
+			} else if (strcmp(argv[i], "json") == 0) {
+				fmt = FMT_JSON;
+			} else if (strcmp(argv[i], "csv") == 0) {
+				fmt = FMT_CSV;
+			} else {
+				usage(argv[0]);
+			}
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+
+	if (stats) {
+		curve9767_stats st;
+
+		if (!curve9767_stats_get(&st)) {
+			fprintf(stderr, "operation counters are not supported"
+				" (compile with -DCURVE9767_STATS=1)\n");
+			exit(EXIT_FAILURE);
+		}
+		bc = malloc(sizeof *bc);
+		if (bc == NULL) {
+			fprintf(stderr, "memory allocation error\n");
+			exit(EXIT_FAILURE);
+		}
+		print_stats_header(fmt);
+		first = 1;
+		for (b = bench_list; b->name != NULL; b ++) {
+			if (!selected(b->name, filters, num_filters)) {
+				continue;
+			}
+			bc->arg = b->arg;
+			b->init(bc);
+			curve9767_stats_reset();
+			b->run(bc);
+			curve9767_stats_get(&st);
+			print_stats(fmt, b->name, &st, first);
+			first = 0;
+		}
+		print_footer(fmt);
+		free(bc);
+		return 0;
+	}
+
+	if (stack) {
+		void *stk;
+		size_t base;
+
+		bc = malloc(sizeof *bc);
+		if (bc == NULL || posix_memalign(&stk, 4096, STACK_SIZE) != 0) {
+			fprintf(stderr, "memory allocation error\n");
+			exit(EXIT_FAILURE);
+		}
+		base = stack_run(NULL, NULL, stk);
+		if (base == 0) {
+			fprintf(stderr, "cannot start thread\n");
+			exit(EXIT_FAILURE);
+		}
+		print_stack_header(fmt, base);
+		first = 1;
+		for (b = bench_list; b->name != NULL; b ++) {
+			size_t len;
+
+			if (!selected(b->name, filters, num_filters)) {
+				continue;
+			}
+			bc->arg = b->arg;
+			b->init(bc);
+
+			/*
+			 * A first run in the main thread ensures that
+			 * lazily bound symbols are resolved, so that the
+			 * dynamic linker does not use the measured stack.
+			 */
+			b->run(bc);
+			len = stack_run(b, bc, stk);
+			if (len == 0) {
+				fprintf(stderr, "cannot start thread\n");
+				exit(EXIT_FAILURE);
+			}
+			print_stack(fmt, b->name, len > base ? len - base : 0,
+				first);
+			first = 0;
+		}
+		print_footer(fmt);
+		free(stk);
+		free(bc);
+		return 0;
+	}
+
+	if (ramp > 0) {
+		ramp_up(ramp);
+	}
+
+	if (num_tp > 0) {
+		tp_thread *ths;
+		unsigned max_th;
+		int j;
+
+		if (num_filters == 0) {
+			filters = tp_default_filters;
+			num_filters = (int)(sizeof tp_default_filters
+				/ sizeof tp_default_filters[0]);
+		}
+		max_th = 0;
+		for (j = 0; j < num_tp; j ++) {
+			if (tp_threads[j] > max_th) {
+				max_th = tp_threads[j];
+			}
+		}
+		ths = calloc(max_th, sizeof *ths);
+		tt = malloc((size_t)max_th * TP_SAMPLES * sizeof *tt);
+		if (ths == NULL || tt == NULL) {
+			fprintf(stderr, "memory allocation error\n");
+			exit(EXIT_FAILURE);
+		}
+		for (j = 0; j < (int)max_th; j ++) {
+			ths[j].bc = malloc(sizeof *ths[j].bc);
+			ths[j].tt = malloc(TP_SAMPLES * sizeof *ths[j].tt);
+			if (ths[j].bc == NULL || ths[j].tt == NULL) {
+				fprintf(stderr, "memory allocation error\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		print_tp_header(fmt);
+		first = 1;
+		for (b = bench_list; b->name != NULL; b ++) {
+			if (!selected(b->name, filters, num_filters)) {
+				continue;
+			}
+			for (j = 0; j < num_tp; j ++) {
+				tp_result tr;
+
+				if (!run_throughput(&tr, b, ths, tp_threads[j],
+					warmup, duration, tt))
+				{
+					fprintf(stderr,
+						"cannot start %u threads\n",
+						tp_threads[j]);
+					exit(EXIT_FAILURE);
+				}
+				print_tp_result(fmt, &tr, first);
+				first = 0;
+			}
+		}
+		print_footer(fmt);
+
+		for (j = 0; j < (int)max_th; j ++) {
+			free(ths[j].bc);
+			free(ths[j].tt);
+		}
+		free(ths);
+		free(tt);
+		return 0;
+	}
+
+	bc = malloc(sizeof *bc);
+	tt = malloc(num * sizeof *tt);
+	if (bc == NULL || tt == NULL) {
+		fprintf(stderr, "memory allocation error\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (perf && !perf_open(&pg)) {
+		fprintf(stderr, "warning: hardware performance counters"
+			" are not available (%s), using %s only\n",
+			SPEED_PERF ? strerror(errno) : "not Linux",
+			SPEED_RDTSC ? "rdtsc" : "the system clock");
+		perf = 0;
+	}
+
+	print_header(fmt, perf);
+	first = 1;
+	for (b = bench_list; b->name != NULL; b ++) {
+		bench_result br;
+
+		if (!selected(b->name, filters, num_filters)) {
+			continue;
+		}
+		run_bench(&br, b, bc, warmup, num, tt, perf ? &pg : NULL);
+		print_result(fmt, &br, first, perf);
+		first = 0;
+	}
+	print_footer(fmt);
+
+	if (perf) {
+		perf_close(&pg);
+	}
+
+	free(bc);
+	free(tt);
+	return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * Micro-benchmark for the C++ wrapper (curve9767.hpp): each operation is
+ * run through the raw C API and through the wrapper, and both timings
+ * (ns/op) are reported, along with their ratio. Results of both paths
+ * are also compared, and the program fails if they differ.
+ *
+ * Usage: speed_curve9767_hpp [num]
+ *   num   number of iterations per measure (default: 2000)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "curve9767.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/*
+ * Accumulator that prevents the compiler from optimizing out the
+ * benchmarked calls.
+ */
+volatile unsigned sink;
+
+template<typename F>
+double
+time_ns(F f, long num)
+{
+	/* Warm-up run, then keep the best of three measures. */
+	f(num / 10 + 1);
+	double best = 0;
+	for (int k = 0; k < 3; k ++) {
+		auto t0 = clock_type::now();
+		f(num);
+		auto t1 = clock_type::now();
+		double d = std::chrono::duration<double, std::nano>(
+			t1 - t0).count() / (double)num;
+		if (k == 0 || d < best) {
+			best = d;
+		}
+	}
+	return best;
+}
+
+void
+report(const char *name, double raw, double wrapped)
+{
+	std::printf("%-24s %12.1f %12.1f %8.3f\n",
+		name, raw, wrapped, wrapped / raw);
+}
+
+void
+check(bool ok, const char *name)
+{
+	if (!ok) {
+		std::fprintf(stderr, "wrapper mismatch: %s\n", name);
+		std::exit(EXIT_FAILURE);
+	}
+}
+
+}
+
+int
+main(int argc, char *argv[])
+{
+	long num = 2000;
+	if (argc > 1) {
+		num = std::strtol(argv[1], nullptr, 10);
+		if (num <= 0) {
+			std::fprintf(stderr, "invalid iteration count\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	/*
+	 * Inputs: a key pair, a few scalars and points, a signature.
+	 */
+	static const std::uint8_t seed[] = "speed_curve9767_hpp";
+	static const std::uint8_t hv[32] = { 1, 2, 3 };
+	curve9767::private_key sk(curve9767::bytes(seed, sizeof seed));
+	curve9767::encoded_scalar es;
+	for (std::size_t u = 0; u < es.size(); u ++) {
+		es[u] = (std::uint8_t)(u * 37 + 11);
+	}
+	curve9767::scalar a = curve9767::scalar::reduce(es);
+	curve9767::scalar b = a * a;
+	curve9767::point P = curve9767::point::mulgen(a);
+	curve9767::point Q = curve9767::point::mulgen(b);
+	curve9767::signature sig = sk.sign(curve9767::oid::sha3_256, hv);
+	const curve9767::public_key& pk = sk.pub();
+
+	/* private_key::sign() uses an expanded key; compare with the C API. */
+	{
+		curve9767_scalar s1;
+		curve9767_point Q1;
+		std::uint8_t t1[32], sig1[64];
+
+		curve9767_keygen(&s1, t1, &Q1, seed, sizeof seed);
+		curve9767_sign_generate(sig1, &s1, t1, &Q1,
+			curve9767::oid::sha3_256, hv, sizeof hv);
+		check(std::memcmp(sig1, sig.data(), sizeof sig1) == 0,
+			"sign_generate");
+	}
+
+	std::printf("%-24s %12s %12s %8s\n",
+		"operation (ns/op)", "C API", "C++", "ratio");
+
+	/* scalar_mul */
+	{
+		curve9767_scalar r1 = *a.c();
+		curve9767::scalar r2 = a;
+		double t1 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				curve9767_scalar_mul(&r1, &r1, b.c());
+			}
+		}, num);
+		double t2 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				r2 = r2 * b;
+			}
+		}, num);
+		check(curve9767_scalar_eq(&r1, r2.c()) != 0, "scalar_mul");
+		report("scalar_mul", t1, t2);
+	}
+
+	/* point_add */
+	{
+		curve9767_point r1 = *P.c();
+		curve9767::point r2 = P;
+		double t1 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				curve9767_point_add(&r1, &r1, Q.c());
+			}
+		}, num);
+		double t2 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				r2 = r2 + Q;
+			}
+		}, num);
+		std::uint8_t e1[32];
+		curve9767_point_encode(e1, &r1);
+		check(std::memcmp(e1, r2.encode().data(), 32) == 0,
+			"point_add");
+		report("point_add", t1, t2);
+	}
+
+	/* point_mul */
+	{
+		curve9767_point r1 = *P.c();
+		curve9767::point r2 = P;
+		long n2 = num / 20 + 1;
+		double t1 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				curve9767_point_mul(&r1, &r1, a.c());
+			}
+		}, n2);
+		double t2 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				r2 *= a;
+			}
+		}, n2);
+		std::uint8_t e1[32];
+		curve9767_point_encode(e1, &r1);
+		check(std::memcmp(e1, r2.encode().data(), 32) == 0,
+			"point_mul");
+		report("point_mul", t1, t2);
+	}
+
+	/* point encode + decode */
+	{
+		std::uint8_t e1[32];
+		curve9767_point r1;
+		curve9767::point r2;
+		long n2 = num / 4 + 1;
+		double t1 = time_ns([&](long n) {
+			unsigned z = 0;
+			for (long i = 0; i < n; i ++) {
+				curve9767_point_encode(e1, P.c());
+				z += curve9767_point_decode(&r1, e1);
+			}
+			sink = z;
+		}, n2);
+		double t2 = time_ns([&](long n) {
+			unsigned z = 0;
+			for (long i = 0; i < n; i ++) {
+				z += r2.decode(P.encode());
+			}
+			sink = z;
+		}, n2);
+		check(std::memcmp(r1.x, r2.c()->x, sizeof r1.x) == 0,
+			"point_decode");
+		report("point_encode_decode", t1, t2);
+	}
+
+	/* sign_verify_vartime */
+	{
+		long n2 = num / 20 + 1;
+		double t1 = time_ns([&](long n) {
+			unsigned z = 0;
+			for (long i = 0; i < n; i ++) {
+				z += curve9767_sign_verify_vartime(sig.data(),
+					pk.Q().c(), CURVE9767_OID_SHA3_256,
+					hv, sizeof hv);
+			}
+			sink = z;
+		}, n2);
+		double t2 = time_ns([&](long n) {
+			unsigned z = 0;
+			for (long i = 0; i < n; i ++) {
+				z += pk.verify_vartime(sig,
+					curve9767::oid::sha3_256, hv);
+			}
+			sink = z;
+		}, n2);
+		check(pk.verify_vartime(sig, curve9767::oid::sha3_256, hv),
+			"sign_verify_vartime");
+		report("sign_verify_vartime", t1, t2);
+	}
+
+	/* point_mulN_vartime (span overload) */
+	{
+		const std::size_t msm_num = 256;
+		std::vector<curve9767::point> pts(msm_num);
+		std::vector<curve9767::scalar> ss(msm_num);
+		for (std::size_t u = 0; u < msm_num; u ++) {
+			es[0] = (std::uint8_t)u;
+			ss[u] = curve9767::scalar::reduce(es);
+			pts[u] = (u == 0) ? P : pts[u - 1] + Q;
+		}
+		curve9767_point r1;
+		curve9767::point r2;
+		long n2 = num / 1000 + 1;
+		double t1 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				curve9767_point_mulN_vartime(&r1,
+					pts[0].c(), ss[0].c(), msm_num, 1);
+			}
+		}, n2);
+		double t2 = time_ns([&](long n) {
+			for (long i = 0; i < n; i ++) {
+				curve9767::mulN_vartime(r2, pts, ss);
+			}
+		}, n2);
+		std::uint8_t e1[32];
+		curve9767_point_encode(e1, &r1);
+		check(std::memcmp(e1, r2.encode().data(), 32) == 0,
+			"point_mulN_vartime");
+		check(!curve9767::mulN_vartime(r2, pts,
+			std::span(ss).first(msm_num - 1)),
+			"point_mulN_vartime (size mismatch)");
+		report("point_mulN_vartime/256", t1, t2);
+	}
+
+	return 0;
+}
@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <sched.h>
+#include <time.h>
 
 #include "curve9767.h"
 #include "inner.h"
@@ -1626,6 +1628,138 @@ test_SHA3(void)
 	fflush(stdout);
 }
 
+static const char *const KAT_PARALLELHASH[] = {
+	/*
+	 * Each test vector: input (hexadecimal), block size B, output
+	 * length (bytes), customization string, and output. The first
+	 * three vectors are from NIST SP 800-185 sample values.
+	 */
+	"000102030405060710111213141516172021222324252627",
+	"8", "64", "",
+	"bc1ef124da34495e948ead207dd9842235da432d2bbc54b4c110e64c451105531b7f2a3e0ce055c02805e7c2de1fb746af97a1dd01f43b824e31b87612410429",
+
+	"000102030405060710111213141516172021222324252627",
+	"8", "64", "Parallel Data",
+	"cdf15289b54f6212b4bc270528b49526006dd9b54e2b6add1ef6900dda3963bb33a72491f236969ca8afaea29c682d47a393c065b38e29fae651a2091c833110",
+
+	"000102030405060708090a0b101112131415161718191a1b202122232425262728292a2b303132333435363738393a3b404142434445464748494a4b505152535455565758595a5b",
+	"12", "64", "Parallel Data",
+	"69d0fcb764ea055dd09334bc6021cb7e4b61348dff375da262671cdec3effa8d1b4568a6cce16b1cad946ddde27f6ce2b8dee4cd1b24851ebf00eb90d43813e9",
+
+	"",
+	"8192", "64", "",
+	"fe94d54ec0a5083a8880b4b4102ba049708ed8d2fd83f489fa5490ba9bf994ab35d8daa2340bbdb9b7b010851df783c7954af215f8ebc5fe3a206602077cb384",
+
+	NULL
+};
+
+/*
+ * Large ParallelHash256 test vectors: input is 100000 bytes, with byte
+ * i set to (7*i + floor(i/256)) mod 256.
+ */
+static const char *const KAT_PARALLELHASH_LARGE[] = {
+	"8192", "64", "",
+	"1b4957330c05fdb399b4465cc537925af7d7e2462d0773328c967b3367cd84ba41ff9a818679722552fc98f597e985d2520b30083eea4722cdaf9ce0196495af",
+
+	"1000", "32", "curve9767",
+	"144c32c8a6f0dc2fdc113ecb2907c3062833fc85243bfb35f658734e077313f9",
+
+	NULL
+};
+
+static void
+test_ParallelHash(void)
+{
+	static uint8_t data[100000];
+	const char *const *st;
+	size_t u;
+
+	printf("Test ParallelHash: ");
+	fflush(stdout);
+
+	for (st = KAT_PARALLELHASH; *st != NULL; st += 5) {
+		uint8_t src[100], ref[64], tmp[64];
+		size_t src_len, blen, olen;
+		const char *custom;
+		parallelhash_context pc;
+
+		src_len = hextobin(src, sizeof src, st[0]);
+		blen = (size_t)strtoul(st[1], NULL, 10);
+		olen = (size_t)strtoul(st[2], NULL, 10);
+		custom = st[3];
+		hextobin(ref, sizeof ref, st[4]);
+
+		parallelhash_init(&pc, 256, blen, custom, strlen(custom));
+		parallelhash_update(&pc, src, src_len);
+		parallelhash_close(&pc, tmp, olen);
+		check_equals(tmp, ref, olen, "ParallelHash KAT 1");
+
+		parallelhash_init(&pc, 256, blen, custom, strlen(custom));
+		for (u = 0; u < src_len; u ++) {
+			parallelhash_update(&pc, src + u, 1);
+		}
+		parallelhash_close(&pc, tmp, olen);
+		check_equals(tmp, ref, olen, "ParallelHash KAT 2");
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	for (u = 0; u < sizeof data; u ++) {
+		data[u] = (uint8_t)(7 * u + (u >> 8));
+	}
+	for (st = KAT_PARALLELHASH_LARGE; *st != NULL; st += 4) {
+		uint8_t ref[64], tmp[64];
+		size_t blen, olen, v;
+		const char *custom;
+		parallelhash_context pc;
+		unsigned nt;
+
+		blen = (size_t)strtoul(st[0], NULL, 10);
+		olen = (size_t)strtoul(st[1], NULL, 10);
+		custom = st[2];
+		hextobin(ref, sizeof ref, st[3]);
+
+		parallelhash_init(&pc, 256, blen, custom, strlen(custom));
+		parallelhash_update(&pc, data, sizeof data);
+		parallelhash_close(&pc, tmp, olen);
+		check_equals(tmp, ref, olen, "ParallelHash large 1");
+
+		/*
+		 * Chunks of varying sizes, not aligned on blocks.
+		 */
+		parallelhash_init(&pc, 256, blen, custom, strlen(custom));
+		for (u = 0, v = 1; u < sizeof data; v = v * 3 + 1) {
+			size_t clen;
+
+			clen = v % 20011;
+			if (clen > sizeof data - u) {
+				clen = sizeof data - u;
+			}
+			parallelhash_update(&pc, data + u, clen);
+			u += clen;
+		}
+		parallelhash_close(&pc, tmp, olen);
+		check_equals(tmp, ref, olen, "ParallelHash large 2");
+
+		for (nt = 1; nt <= 8; nt ++) {
+			parallelhash_init(&pc, 256, blen,
+				custom, strlen(custom));
+			parallelhash_update(&pc, data, 777);
+			parallelhash_update_mt(&pc,
+				data + 777, sizeof data - 777, nt);
+			parallelhash_close(&pc, tmp, olen);
+			check_equals(tmp, ref, olen, "ParallelHash large MT");
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 /*
  * For tests, we use a custom, inefficient, non-constant-time
  * implementation of operations modulo p and in GF(p^19).
@@ -2099,6 +2233,96 @@ test_gf_sqrt(void)
 	fflush(stdout);
 }
 
+static void
+test_gf_isqrt(void)
+{
+	shake_context rng;
+	field_element u, c;
+	long ctr;
+
+	static const field_element zero = {
+		{ P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P }
+	};
+	static const field_element one = {
+		{ R, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P }
+	};
+
+	printf("Test poly isqrt: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_isqrt", 0);
+
+	/*
+	 * Zero inputs yield a zero output.
+	 */
+	if (curve9767_inner_gf_isqrt(c.v, zero.v) != 1) {
+		fprintf(stderr, "zero declared non-QR\n");
+		exit(EXIT_FAILURE);
+	}
+	check_poly("isqrt (zero)", zero.v, c.v);
+	polyrand(&rng, u.v);
+	curve9767_inner_gf_sqrt_ratio(c.v, u.v, zero.v);
+	check_poly("sqrt_ratio (v = 0)", zero.v, c.v);
+	curve9767_inner_gf_sqrt_ratio(c.v, zero.v, u.v);
+	check_poly("sqrt_ratio (u = 0)", zero.v, c.v);
+
+	for (ctr = 0; ctr < 20000; ctr ++) {
+		field_element a, v, d;
+		uint32_t r;
+
+		polyrand(&rng, a.v);
+		curve9767_inner_gf_sqr(a.v, a.v);
+		if (curve9767_inner_gf_isqrt(c.v, a.v) != 1) {
+			fprintf(stderr, "QR declared non-QR (isqrt)\n");
+			polyprint("a", a.v);
+			exit(EXIT_FAILURE);
+		}
+		curve9767_inner_gf_sqr(d.v, c.v);
+		curve9767_inner_gf_mul(d.v, d.v, a.v);
+		check_poly("isqrt (QR)", one.v, d.v);
+
+		curve9767_inner_gf_neg(a.v, a.v);
+		if (curve9767_inner_gf_isqrt(c.v, a.v) != 0) {
+			fprintf(stderr, "non-QR declared QR (isqrt)\n");
+			polyprint("a", a.v);
+			exit(EXIT_FAILURE);
+		}
+		curve9767_inner_gf_sqr(d.v, c.v);
+		curve9767_inner_gf_mul(d.v, d.v, a.v);
+		curve9767_inner_gf_neg(d.v, d.v);
+		check_poly("isqrt (non-QR)", one.v, d.v);
+
+		/*
+		 * For sqrt_ratio(), we use random u and v; the QR
+		 * status must match that of u*v.
+		 */
+		polyrand(&rng, u.v);
+		polyrand(&rng, v.v);
+		r = curve9767_inner_gf_sqrt_ratio(c.v, u.v, v.v);
+		curve9767_inner_gf_mul(d.v, u.v, v.v);
+		if (r != curve9767_inner_gf_is_qr(d.v)) {
+			fprintf(stderr, "wrong QR status (sqrt_ratio)\n");
+			polyprint("u", u.v);
+			polyprint("v", v.v);
+			exit(EXIT_FAILURE);
+		}
+		curve9767_inner_gf_sqr(d.v, c.v);
+		curve9767_inner_gf_mul(d.v, d.v, v.v);
+		if (!r) {
+			curve9767_inner_gf_neg(d.v, d.v);
+		}
+		check_poly("sqrt_ratio", u.v, d.v);
+
+		if ((ctr & 1023) == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static void
 test_gf_cubert(void)
 {
@@ -3251,6 +3475,79 @@ static const char *const KAT_HASH_TO_CURVE[] = {
 	NULL
 };
 
+static const char *const KAT_ENCODE_TO_CURVE[] = {
+	/*
+	 * Encode-to-curve tests.
+	 *
+	 * Each sequence of two lines consists in a message (ASCII string)
+	 * followed by the encoding of the curve point obtained by applying
+	 * the encode-to-curve process (a single Icart's map) to that
+	 * message. SHAKE256 is used for the first step (seed extraction).
+	 */
+
+	"curve9767-test10:000",
+	"e4f0db31d643e3ddccd4077a87050babb996d101ff630c83c6e25c33a2ba5111",
+
+	"curve9767-test10:001",
+	"8a8e354fb467d9c253d4174fb16e3d15e6b5df1e638b15d04bc34c9fb1c0ab47",
+
+	"curve9767-test10:002",
+	"0f6200d447082aa25f19d03649667ccf3d156511a656b636043a74a0d21eb552",
+
+	"curve9767-test10:003",
+	"8b29607e9107144a369260660bf397554fc506978b075d2ff59adaa2ac8a1012",
+
+	"curve9767-test10:004",
+	"618413d48eb9341a562c5e30fc7db94f56dacc74dafce27a497360a5c7695050",
+
+	"curve9767-test10:005",
+	"73eb19a15041071fc3c36347f155b6020ac468704b86da09c98a7b8c114dee43",
+
+	"curve9767-test10:006",
+	"a7ea7e183de5910f820e7446d7227f0f2eabb84e9fb302100bf01b46ae105e20",
+
+	"curve9767-test10:007",
+	"8a65b60c6cc11d6ab4ac958c0f7628774eea60b1186d5c4ea510903d39b6c153",
+
+	"curve9767-test10:008",
+	"29c7c6a0af444ef0eca378883b7c56279d4763cba99530f9bc4113c32e915621",
+
+	"curve9767-test10:009",
+	"a0d853f526dbac94bf2c733ecace333f0187354d29d120804e0000776c1e6a16",
+
+	"curve9767-test10:010",
+	"3a72ea2a7b2fe9ce149d4ca28d027ca63c3701572065a36ba3f0fc97b7aa800f",
+
+	"curve9767-test10:011",
+	"a9040fab65ee7a6d095b91b6f5b6664bc33b72e2a6c7a83e46e818e0e1e49440",
+
+	"curve9767-test10:012",
+	"ec12b03e12d7044ba6befd60780c33a93b672b1678b3800e06f9070a5b8c6920",
+
+	"curve9767-test10:013",
+	"ba27e965074867973ed47b75969eb449ec6dc49b74b397d200a5cfa9875b241e",
+
+	"curve9767-test10:014",
+	"8965964441d9a5c02039bcb9d739781302d48976ad5ec1c5ba03df1c409d4705",
+
+	"curve9767-test10:015",
+	"b2d385b54b53f1fd9f561903a2ed5f96e9b7505305fe1d4353dd88fba73b0114",
+
+	"curve9767-test10:016",
+	"7fcf3703ecd9ab85e43e2408cc6959a0ef4650b161e5eb4ddda6e02e534a2613",
+
+	"curve9767-test10:017",
+	"669a838b1f1b70f2cb099dc0ef59e901cc15bf5d11b024d50e9d0ca911a88d4a",
+
+	"curve9767-test10:018",
+	"9bbfcbc59880e8d7fabd45956f4ec973a4cd5bcd039d3abb15a7d451a821d856",
+
+	"curve9767-test10:019",
+	"c749753457f910db7eae375cf8c89770adfc07dd5a176ae6234cda0dbf63af58",
+
+	NULL
+};
+
 static void
 test_hash_to_curve(void)
 {
@@ -3289,6 +3586,44 @@ test_hash_to_curve(void)
 	fflush(stdout);
 }
 
+static void
+test_encode_to_curve(void)
+{
+	const char *const *s;
+
+	printf("Test encode_to_curve: ");
+	fflush(stdout);
+
+	s = KAT_ENCODE_TO_CURVE;
+	for (;;) {
+		uint8_t bQ[32], bb[32];
+		const char *msg;
+		shake_context sc;
+		curve9767_point Q;
+
+		if (*s == NULL) {
+			break;
+		}
+		msg = *s ++;
+		HEXTOBIN(bQ, *s ++);
+		shake_init(&sc, 256);
+		shake_inject(&sc, msg, strlen(msg));
+		shake_flip(&sc);
+		curve9767_encode_to_curve(&Q, &sc);
+		if (!curve9767_point_encode(bb, &Q)) {
+			fprintf(stderr, "Invalid point\n");
+			exit(EXIT_FAILURE);
+		}
+		check_equals(bQ, bb, 32, "KAT");
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static void
 test_codec(void)
 {
@@ -3339,6 +3674,105 @@ test_codec(void)
 	fflush(stdout);
 }
 
+static void
+test_point_full(void)
+{
+	const char *const *s;
+	uint8_t bb[64], cc[64], dd[32];
+	curve9767_point Q, Q2;
+
+	printf("Test encode/decode (full): ");
+	fflush(stdout);
+
+	s = KAT_CODEC;
+	for (;;) {
+		int vv;
+
+		if (*s == NULL) {
+			break;
+		}
+		HEXTOBIN(dd, *s ++);
+		vv = (*s ++)[0] == '1';
+		if (!vv) {
+			continue;
+		}
+		curve9767_point_decode(&Q, dd);
+		if (!curve9767_point_encode_full(bb, &Q)) {
+			fprintf(stderr, "full encode failure\n");
+			exit(EXIT_FAILURE);
+		}
+		curve9767_point_encode_X(cc, &Q);
+		check_equals(bb, cc, 32, "full encode X");
+		if (!curve9767_point_decode_full(&Q2, bb)) {
+			fprintf(stderr, "full decode failure\n");
+			exit(EXIT_FAILURE);
+		}
+		curve9767_point_encode(cc, &Q2);
+		check_equals(cc, dd, 32, "full reencode");
+
+		/*
+		 * -Q must also decode, but not to Q.
+		 */
+		curve9767_point_neg(&Q2, &Q);
+		curve9767_point_encode_full(cc, &Q2);
+		if (!curve9767_point_decode_full(&Q2, cc)) {
+			fprintf(stderr, "full decode failure (neg)\n");
+			exit(EXIT_FAILURE);
+		}
+		curve9767_point_encode(cc, &Q2);
+		if (memcmp(cc, dd, 32) == 0) {
+			fprintf(stderr, "full decode lost the Y sign\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/*
+		 * Altered Y coordinate and set top bits must be rejected.
+		 */
+		memcpy(cc, bb, 64);
+		cc[32] ^= 0x01;
+		if (curve9767_point_decode_full(&Q2, cc)) {
+			fprintf(stderr, "off-curve point not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!curve9767_point_is_neutral(&Q2)) {
+			fprintf(stderr, "decode failure should"
+				" yield neutral\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(cc, bb, 64);
+		cc[63] |= 0x40;
+		if (curve9767_point_decode_full(&Q2, cc)) {
+			fprintf(stderr, "top bit not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(cc, bb, 64);
+		cc[31] |= 0x80;
+		if (curve9767_point_decode_full(&Q2, cc)) {
+			fprintf(stderr, "top bit not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * The encoding of the point-at-infinity is invalid.
+	 */
+	curve9767_point_set_neutral(&Q);
+	if (curve9767_point_encode_full(bb, &Q)) {
+		fprintf(stderr, "full encode of neutral should fail\n");
+		exit(EXIT_FAILURE);
+	}
+	if (curve9767_point_decode_full(&Q, bb)) {
+		fprintf(stderr, "full decode of neutral should fail\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static void
 pointdec(curve9767_point *Q, const void *src)
 {
@@ -3599,33 +4033,217 @@ test_combined(void)
 }
 
 static void
-test_combined_vartime(void)
+test_point_mul_short(void)
+{
+	static const unsigned bitlens[] = {
+		0, 1, 2, 3, 4, 5, 7, 16, 64, 127, 128, 129, 200,
+		245, 249, 250, 251, 252, 256
+	};
+	shake_context rng;
+	size_t u;
+
+	printf("Test point_mul_short: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_point_mul_short", 0);
+	for (u = 0; u < (sizeof bitlens) / sizeof(bitlens[0]); u ++) {
+		unsigned bitlen;
+		int i;
+
+		bitlen = bitlens[u];
+		for (i = 0; i < 10; i ++) {
+			uint8_t tmp[40], bb1[32], bb2[32];
+			curve9767_scalar s0, s;
+			curve9767_point Q1, Q3, T3;
+			int j;
+
+			/*
+			 * Random point Q1 (neutral for i == 0), and a
+			 * random scalar lower than 2^bitlen; the scalar
+			 * is zero for i == 1, and 2^bitlen-1 for i == 2.
+			 */
+			if (i == 0) {
+				curve9767_point_set_neutral(&Q1);
+			} else {
+				shake_extract(&rng, tmp, sizeof tmp);
+				curve9767_scalar_decode_reduce(&s0,
+					tmp, sizeof tmp);
+				curve9767_point_mulgen(&Q1, &s0);
+			}
+			if (bitlen >= 252) {
+				shake_extract(&rng, tmp, sizeof tmp);
+				curve9767_scalar_decode_reduce(&s,
+					tmp, sizeof tmp);
+			} else {
+				if (i == 1) {
+					memset(tmp, 0x00, 32);
+				} else if (i == 2) {
+					memset(tmp, 0xFF, 32);
+				} else {
+					shake_extract(&rng, tmp, 32);
+				}
+				for (j = 0; j < 32; j ++) {
+					int k;
+
+					k = (int)bitlen - (j << 3);
+					if (k <= 0) {
+						tmp[j] = 0;
+					} else if (k < 8) {
+						tmp[j] &= (1 << k) - 1;
+					}
+				}
+				curve9767_scalar_decode_reduce(&s, tmp, 32);
+			}
+
+			curve9767_point_mul_short(&Q3, &Q1, &s, bitlen);
+			if (!curve9767_point_encode(bb1, &Q3)) {
+				memset(bb1, 0xFF, sizeof bb1);
+			}
+			curve9767_point_mul(&T3, &Q1, &s);
+			if (!curve9767_point_encode(bb2, &T3)) {
+				memset(bb2, 0xFF, sizeof bb2);
+			}
+			check_equals(bb1, bb2, sizeof bb1, "point_mul_short");
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_mul2_add(void)
 {
 	int i;
 	shake_context rng;
 
-	printf("Test combined vartime: ");
+	printf("Test mul2_add: ");
 	fflush(stdout);
 
-	rand_init(&rng, "test_combined_vartime", 0);
+	rand_init(&rng, "test_mul2_add", 0);
 	for (i = 0; i < 100; i ++) {
-		curve9767_point Q0, Q1, Q2;
-		uint8_t c0[16], c1[16], c2[32], bb0[32], bb2[32];
-		int neg0, neg1;
-		curve9767_scalar s;
+		uint8_t tmp[40], bb1[32], bb2[32];
+		curve9767_scalar s0, s1, s2;
+		curve9767_point P1, P2, Q3, T1, T3;
 
 		/*
-		 * We create random points Q0 and Q1 (using hash-to-curve)
-		 * and random multipliers within the allowed ranges. For
-		 * the first few tests, we use special multiplier values
-		 * to exercise edge cases.
+		 * Random points P1 and P2 and scalars s1 and s2, with
+		 * special cases for the first iterations:
+		 *   0   P1 = 0
+		 *   1   P2 = 0
+		 *   2   P1 = 0, P2 = 0
+		 *   3   s1 = 0
+		 *   4   s2 = 0
+		 *   5   P2 = P1
+		 *   6   P2 = -P1, s2 = s1 (result is 0)
+		 * Odd iterations (beyond 6) write the result over P1 or P2.
 		 */
-		curve9767_hash_to_curve(&Q0, &rng);
-		curve9767_hash_to_curve(&Q1, &rng);
-
-		shake_extract(&rng, c0, sizeof c0);
-		shake_extract(&rng, c1, sizeof c1);
-		shake_extract(&rng, c2, sizeof c2);
+		shake_extract(&rng, tmp, sizeof tmp);
+		curve9767_scalar_decode_reduce(&s0, tmp, sizeof tmp);
+		curve9767_point_mulgen(&P1, &s0);
+		shake_extract(&rng, tmp, sizeof tmp);
+		curve9767_scalar_decode_reduce(&s0, tmp, sizeof tmp);
+		curve9767_point_mulgen(&P2, &s0);
+		shake_extract(&rng, tmp, sizeof tmp);
+		curve9767_scalar_decode_reduce(&s1, tmp, sizeof tmp);
+		shake_extract(&rng, tmp, sizeof tmp);
+		curve9767_scalar_decode_reduce(&s2, tmp, sizeof tmp);
+		switch (i) {
+		case 0:
+			curve9767_point_set_neutral(&P1);
+			break;
+		case 1:
+			curve9767_point_set_neutral(&P2);
+			break;
+		case 2:
+			curve9767_point_set_neutral(&P1);
+			curve9767_point_set_neutral(&P2);
+			break;
+		case 3:
+			s1 = curve9767_scalar_zero;
+			break;
+		case 4:
+			s2 = curve9767_scalar_zero;
+			break;
+		case 5:
+			P2 = P1;
+			break;
+		case 6:
+			curve9767_point_neg(&P2, &P1);
+			s2 = s1;
+			break;
+		}
+
+		curve9767_point_mul(&T3, &P1, &s1);
+		curve9767_point_mul(&T1, &P2, &s2);
+		curve9767_point_add(&T3, &T3, &T1);
+		if (!curve9767_point_encode(bb2, &T3)) {
+			memset(bb2, 0xFF, sizeof bb2);
+		}
+		if (i == 6 && !curve9767_point_is_neutral(&T3)) {
+			fprintf(stderr, "s*P - s*P is not neutral\n");
+			exit(EXIT_FAILURE);
+		}
+
+		if (i > 6 && (i & 1) != 0) {
+			if ((i & 2) != 0) {
+				curve9767_point_mul2_add(&P1,
+					&P1, &s1, &P2, &s2);
+				Q3 = P1;
+			} else {
+				curve9767_point_mul2_add(&P2,
+					&P1, &s1, &P2, &s2);
+				Q3 = P2;
+			}
+		} else {
+			curve9767_point_mul2_add(&Q3, &P1, &s1, &P2, &s2);
+		}
+		if (!curve9767_point_encode(bb1, &Q3)) {
+			memset(bb1, 0xFF, sizeof bb1);
+		}
+		check_equals(bb1, bb2, sizeof bb1, "s1*P1+s2*P2");
+
+		if (i % 4 == 0) {
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_combined_vartime(void)
+{
+	int i;
+	shake_context rng;
+
+	printf("Test combined vartime: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_combined_vartime", 0);
+	for (i = 0; i < 100; i ++) {
+		curve9767_point Q0, Q1, Q2;
+		uint8_t c0[16], c1[16], c2[32], bb0[32], bb2[32];
+		int neg0, neg1;
+		curve9767_scalar s;
+
+		/*
+		 * We create random points Q0 and Q1 (using hash-to-curve)
+		 * and random multipliers within the allowed ranges. For
+		 * the first few tests, we use special multiplier values
+		 * to exercise edge cases.
+		 */
+		curve9767_hash_to_curve(&Q0, &rng);
+		curve9767_hash_to_curve(&Q1, &rng);
+
+		shake_extract(&rng, c0, sizeof c0);
+		shake_extract(&rng, c1, sizeof c1);
+		shake_extract(&rng, c2, sizeof c2);
 		neg0 = c0[15] >> 7;
 		c0[15] &= 0x7F;
 		neg1 = c1[15] >> 7;
@@ -3687,6 +4305,149 @@ test_combined_vartime(void)
 	fflush(stdout);
 }
 
+static void
+test_mulN_vartime(void)
+{
+	shake_context rng;
+	size_t num;
+
+	printf("Test mulN vartime: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_mulN_vartime", 0);
+	for (num = 0; num <= 20; num ++) {
+		curve9767_point pts[20], Q0, Q1;
+		curve9767_scalar s;
+		uint8_t c[20 * 32], c2[32], bb0[32], bb1[32];
+		size_t u;
+
+		/*
+		 * Random points and multipliers; for some points, the
+		 * multiplier is zero, or the point is the neutral.
+		 */
+		for (u = 0; u < num; u ++) {
+			curve9767_hash_to_curve(&pts[u], &rng);
+			shake_extract(&rng, c + (u << 5), 32);
+			c[(u << 5) + 31] &= 0x0F;
+			if (u == 3) {
+				memset(c + (u << 5), 0, 32);
+			}
+			if (u == 5) {
+				curve9767_point_set_neutral(&pts[u]);
+			}
+		}
+		shake_extract(&rng, c2, sizeof c2);
+		c2[31] &= 0x0F;
+
+		curve9767_inner_mulN_mulgen_add_vartime(&Q0,
+			pts, c, num, (num % 3) == 1 ? NULL : c2);
+		if (!curve9767_point_encode(bb0, &Q0)) {
+			memset(bb0, 0xFF, sizeof bb0);
+		}
+
+		if ((num % 3) == 1) {
+			curve9767_point_set_neutral(&Q1);
+		} else {
+			curve9767_scalar_decode_reduce(&s, c2, sizeof c2);
+			curve9767_point_mulgen(&Q1, &s);
+		}
+		for (u = 0; u < num; u ++) {
+			curve9767_point T;
+
+			curve9767_scalar_decode_reduce(&s, c + (u << 5), 32);
+			curve9767_point_mul(&T, &pts[u], &s);
+			curve9767_point_add(&Q1, &Q1, &T);
+		}
+		if (!curve9767_point_encode(bb1, &Q1)) {
+			memset(bb1, 0xFF, sizeof bb1);
+		}
+		check_equals(bb0, bb1, sizeof bb0, "sum c_i*P_i + c2*G");
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define MSM_TEST_NUM   1500
+
+static void
+test_point_mulN_vartime(void)
+{
+	static curve9767_point pts[MSM_TEST_NUM], sums[MSM_TEST_NUM + 1];
+	static curve9767_scalar sc[MSM_TEST_NUM];
+	static const size_t sizes[] = { 0, 1, 20, 63, 64, 65, 200, 1500 };
+	shake_context rng;
+	size_t u, k;
+
+	printf("Test point_mulN vartime: ");
+	fflush(stdout);
+
+	/*
+	 * Random points and scalars, with some special cases: zero
+	 * scalars, scalar -1, neutral points, repeated points (doublings
+	 * in the buckets) and opposite points (cancellations).
+	 */
+	rand_init(&rng, "test_point_mulN_vartime", 0);
+	curve9767_point_set_neutral(&sums[0]);
+	for (u = 0; u < MSM_TEST_NUM; u ++) {
+		uint8_t tmp[64];
+		curve9767_point T;
+
+		curve9767_hash_to_curve(&pts[u], &rng);
+		shake_extract(&rng, tmp, sizeof tmp);
+		curve9767_scalar_decode_reduce(&sc[u], tmp, sizeof tmp);
+		switch (u % 50) {
+		case 3:
+			sc[u] = curve9767_scalar_zero;
+			break;
+		case 5:
+			curve9767_point_set_neutral(&pts[u]);
+			break;
+		case 7:
+			curve9767_scalar_neg(&sc[u], &curve9767_scalar_one);
+			break;
+		case 11:
+		case 12:
+			pts[u] = pts[u - 2];
+			sc[u] = sc[u - 2];
+			break;
+		case 13:
+			curve9767_point_neg(&pts[u], &pts[u - 1]);
+			sc[u] = sc[u - 1];
+			break;
+		}
+		curve9767_point_mul(&T, &pts[u], &sc[u]);
+		curve9767_point_add(&sums[u + 1], &sums[u], &T);
+	}
+
+	for (k = 0; k < sizeof sizes / sizeof sizes[0]; k ++) {
+		unsigned nt;
+
+		for (nt = 1; nt <= 3; nt += 2) {
+			curve9767_point Q;
+			uint8_t bb0[32], bb1[32];
+
+			curve9767_point_mulN_vartime(&Q,
+				pts, sc, sizes[k], nt);
+			if (!curve9767_point_encode(bb0, &Q)) {
+				memset(bb0, 0xFF, sizeof bb0);
+			}
+			if (!curve9767_point_encode(bb1, &sums[sizes[k]])) {
+				memset(bb1, 0xFF, sizeof bb1);
+			}
+			check_equals(bb0, bb1, sizeof bb0, "sum s_i*P_i");
+			printf(".");
+			fflush(stdout);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static const char *const KAT_ECDH[] = {
 	/*
 	 * ECDH tests.
@@ -3873,8 +4634,9 @@ test_ECDH(void)
 	for (;;) {
 		uint8_t seed[32], bs[32], bQ[32], bQ2[32];
 		uint8_t bk1[32], bQ3[32], bk2[32];
-		uint8_t tmp[32];
+		uint8_t tmp[32], full[64];
 		curve9767_scalar s;
+		curve9767_point Q2;
 
 		if (*st == NULL) {
 			break;
@@ -3896,6 +4658,18 @@ test_ECDH(void)
 			exit(EXIT_FAILURE);
 		}
 		check_equals(tmp, bk1, sizeof bk1, "secret1");
+		curve9767_point_decode(&Q2, bQ2);
+		curve9767_point_encode_full(full, &Q2);
+		if (curve9767_ecdh_recv_full(tmp, sizeof bk1, &s, full) != 1) {
+			fprintf(stderr, "ECDH(1, full) failed\n");
+			exit(EXIT_FAILURE);
+		}
+		check_equals(tmp, bk1, sizeof bk1, "secret1 (full)");
+		full[32] ^= 0x01;
+		if (curve9767_ecdh_recv_full(tmp, sizeof bk1, &s, full) != 0) {
+			fprintf(stderr, "ECDH(2, full) should have failed\n");
+			exit(EXIT_FAILURE);
+		}
 		if (curve9767_ecdh_recv(tmp, sizeof bk2, &s, bQ3) != 0) {
 			fprintf(stderr, "ECDH(2) should have failed\n");
 			exit(EXIT_FAILURE);
@@ -4075,10 +4849,11 @@ test_signature(void)
 	st = KAT_SIGN + 12;
 	for (;;) {
 		uint8_t seed[32], bs[32], t[32], bQ[32], sig[64];
-		uint8_t tmp[64], hv[32];
+		uint8_t tmp[64], hv[32], fsig[96];
 		const char *msg;
 		curve9767_scalar s;
-		curve9767_point Q;
+		curve9767_point Q, C;
+		curve9767_sign_key sk;
 		sha3_context sc;
 
 		if (*st == NULL) {
@@ -4104,6 +4879,21 @@ test_signature(void)
 		curve9767_sign_generate(tmp, &s, t, &Q,
 			CURVE9767_OID_SHA3_256, hv, sizeof hv);
 		check_equals(tmp, sig, sizeof sig, "sign (deterministic)");
+		curve9767_sign_generate_full(fsig, &s, t, &Q,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv);
+		curve9767_point_decode_full(&C, fsig);
+		curve9767_point_encode(tmp, &C);
+		memcpy(tmp + 32, fsig + 64, 32);
+		check_equals(tmp, sig, sizeof sig, "sign (full)");
+		curve9767_sign_key_init(&sk, &s, t, &Q);
+		curve9767_sign_generate_key(tmp, &sk,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv);
+		check_equals(tmp, sig, sizeof sig, "sign (key)");
+		memset(&sk, 0, sizeof sk);
+		curve9767_sign_key_from_seed(&sk, seed, sizeof seed);
+		curve9767_sign_generate_key(tmp, &sk,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv);
+		check_equals(tmp, sig, sizeof sig, "sign (key from seed)");
 
 		if (curve9767_sign_verify(sig, &Q,
 			CURVE9767_OID_SHA3_256, hv, sizeof hv) != 1)
@@ -4117,6 +4907,12 @@ test_signature(void)
 			fprintf(stderr, "Signature verification failed (2)\n");
 			exit(EXIT_FAILURE);
 		}
+		if (curve9767_sign_verify_full_vartime(fsig, &Q,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv) != 1)
+		{
+			fprintf(stderr, "Signature verification failed (3)\n");
+			exit(EXIT_FAILURE);
+		}
 		hv[0] ^= 0x01;
 		if (curve9767_sign_verify(sig, &Q,
 			CURVE9767_OID_SHA3_256, hv, sizeof hv) != 0)
@@ -4130,6 +4926,222 @@ test_signature(void)
 			fprintf(stderr, "Bad signature not rejected (2)\n");
 			exit(EXIT_FAILURE);
 		}
+		if (curve9767_sign_verify_full_vartime(fsig, &Q,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv) != 0)
+		{
+			fprintf(stderr, "Bad signature not rejected (3)\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_sign_online(void)
+{
+	shake_context rng;
+	curve9767_sign_pool_entry pbuf[4];
+	curve9767_sign_pool pool;
+	int i;
+
+	printf("Test sign online: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_sign_online", 0);
+	if (curve9767_sign_pool_init(&pool, pbuf, 3)) {
+		fprintf(stderr, "Invalid pool size not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+	if (!curve9767_sign_pool_init(&pool, pbuf, 4)) {
+		fprintf(stderr, "Pool initialization failed\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < 10; i ++) {
+		uint8_t seed[32], hv[32], sig[64], tmp[64];
+		curve9767_scalar s;
+		curve9767_point Q;
+		curve9767_sign_nonce nonce;
+		int j;
+
+		shake_extract(&rng, seed, sizeof seed);
+		curve9767_keygen(&s, NULL, &Q, seed, sizeof seed);
+		shake_extract(&rng, hv, sizeof hv);
+
+		/*
+		 * Single nonce: it can be used only once.
+		 */
+		shake_extract(&rng, seed, sizeof seed);
+		curve9767_sign_nonce_generate(&nonce, seed, sizeof seed);
+		memcpy(tmp, nonce.c, 32);
+		if (!curve9767_sign_generate_online(sig, &s, &Q, &nonce,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv))
+		{
+			fprintf(stderr, "Online signature failed\n");
+			exit(EXIT_FAILURE);
+		}
+		check_equals(sig, tmp, 32, "online signature commitment");
+		if (curve9767_sign_verify(sig, &Q,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv) != 1
+			|| curve9767_sign_verify_vartime(sig, &Q,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv) != 1)
+		{
+			fprintf(stderr, "Online signature verification failed\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(tmp, sig, 64);
+		if (curve9767_sign_generate_online(sig, &s, &Q, &nonce,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv))
+		{
+			fprintf(stderr, "Nonce reuse not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+		check_equals(sig, tmp, 64, "signature after nonce reuse");
+
+		/*
+		 * Pool: fill it, then drain it.
+		 */
+		for (j = 0; j < 4; j ++) {
+			shake_extract(&rng, seed, sizeof seed);
+			if (!curve9767_sign_pool_put(&pool, seed, sizeof seed)) {
+				fprintf(stderr, "Pool insertion failed\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (curve9767_sign_pool_put(&pool, seed, sizeof seed)) {
+			fprintf(stderr, "Full pool not detected\n");
+			exit(EXIT_FAILURE);
+		}
+		for (j = 0; j < 4; j ++) {
+			hv[0] = (uint8_t)j;
+			if (!curve9767_sign_pool_sign(sig, &pool, &s, &Q,
+				CURVE9767_OID_SHA3_256, hv, sizeof hv))
+			{
+				fprintf(stderr, "Pool signature failed\n");
+				exit(EXIT_FAILURE);
+			}
+			if (curve9767_sign_verify_vartime(sig, &Q,
+				CURVE9767_OID_SHA3_256, hv, sizeof hv) != 1)
+			{
+				fprintf(stderr, "Pool signature verification"
+					" failed\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (curve9767_sign_pool_sign(sig, &pool, &s, &Q,
+			CURVE9767_OID_SHA3_256, hv, sizeof hv))
+		{
+			fprintf(stderr, "Empty pool not detected\n");
+			exit(EXIT_FAILURE);
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_sign_aggregate(void)
+{
+	shake_context rng;
+	curve9767_point Q[40];
+	curve9767_sign_msg msg[40];
+	uint8_t hv[40][32], sigs[40 * 64], agg[41 * 32];
+	size_t u, num;
+
+	printf("Test sign aggregate: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_sign_aggregate", 0);
+	for (u = 0; u < 40; u ++) {
+		uint8_t seed[32], t[32];
+		curve9767_scalar s;
+
+		shake_extract(&rng, seed, sizeof seed);
+		curve9767_keygen(&s, t, &Q[u], seed, sizeof seed);
+		shake_extract(&rng, hv[u], sizeof hv[u]);
+		curve9767_sign_generate(sigs + (u << 6), &s, t, &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+		msg[u].Q = &Q[u];
+		msg[u].hash_oid = CURVE9767_OID_SHA3_256;
+		msg[u].hv = hv[u];
+		msg[u].hv_len = sizeof hv[u];
+	}
+
+	if (curve9767_sign_aggregate(agg, sigs, msg, 0)) {
+		fprintf(stderr, "Empty aggregation not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+	for (num = 1; num <= 40; num ++) {
+		curve9767_sign_msg tm;
+
+		if (!curve9767_sign_aggregate(agg, sigs, msg, num)) {
+			fprintf(stderr, "Aggregation failed\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!curve9767_sign_verify_aggregate_vartime(agg, msg, num)) {
+			fprintf(stderr, "Aggregate verification failed\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/*
+		 * Altered message.
+		 */
+		hv[num - 1][5] ^= 0x01;
+		if (curve9767_sign_verify_aggregate_vartime(agg, msg, num)) {
+			fprintf(stderr, "Bad aggregate not rejected (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		hv[num - 1][5] ^= 0x01;
+
+		/*
+		 * Altered aggregated scalar.
+		 */
+		agg[num << 5] ^= 0x01;
+		if (curve9767_sign_verify_aggregate_vartime(agg, msg, num)) {
+			fprintf(stderr, "Bad aggregate not rejected (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		agg[num << 5] ^= 0x01;
+
+		/*
+		 * Swapped messages.
+		 */
+		if (num >= 2) {
+			tm = msg[0];
+			msg[0] = msg[num - 1];
+			msg[num - 1] = tm;
+			if (curve9767_sign_verify_aggregate_vartime(
+				agg, msg, num))
+			{
+				fprintf(stderr,
+					"Bad aggregate not rejected (3)\n");
+				exit(EXIT_FAILURE);
+			}
+			tm = msg[0];
+			msg[0] = msg[num - 1];
+			msg[num - 1] = tm;
+		}
+
+		/*
+		 * Invalid source signature.
+		 */
+		sigs[((num - 1) << 6) + 40] ^= 0x01;
+		if (!curve9767_sign_aggregate(agg, sigs, msg, num)
+			|| curve9767_sign_verify_aggregate_vartime(
+			agg, msg, num))
+		{
+			fprintf(stderr, "Bad aggregate not rejected (4)\n");
+			exit(EXIT_FAILURE);
+		}
+		sigs[((num - 1) << 6) + 40] ^= 0x01;
 
 		printf(".");
 		fflush(stdout);
@@ -4139,6 +5151,794 @@ test_signature(void)
 	fflush(stdout);
 }
 
+static void
+test_sign_batch(void)
+{
+	shake_context rng;
+	curve9767_point Q[40];
+	curve9767_sign_msg msg[40];
+	uint8_t hv[40][32], sigs[40 * 64];
+	size_t u, num;
+
+	printf("Test sign batch: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_sign_batch", 0);
+	for (u = 0; u < 40; u ++) {
+		uint8_t seed[32], t[32];
+		curve9767_scalar s;
+
+		shake_extract(&rng, seed, sizeof seed);
+		curve9767_keygen(&s, t, &Q[u], seed, sizeof seed);
+		shake_extract(&rng, hv[u], sizeof hv[u]);
+		curve9767_sign_generate(sigs + (u << 6), &s, t, &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+		msg[u].Q = &Q[u];
+		msg[u].hash_oid = CURVE9767_OID_SHA3_256;
+		msg[u].hv = hv[u];
+		msg[u].hv_len = sizeof hv[u];
+	}
+
+	if (curve9767_sign_verify_batch_vartime(sigs, msg, 0)) {
+		fprintf(stderr, "Empty batch not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+	for (num = 1; num <= 40; num ++) {
+		if (!curve9767_sign_verify_batch_vartime(sigs, msg, num)) {
+			fprintf(stderr, "Batch verification failed\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/*
+		 * Altered message.
+		 */
+		hv[num - 1][5] ^= 0x01;
+		if (curve9767_sign_verify_batch_vartime(sigs, msg, num)) {
+			fprintf(stderr, "Bad batch not rejected (1)\n");
+			exit(EXIT_FAILURE);
+		}
+		hv[num - 1][5] ^= 0x01;
+
+		/*
+		 * Altered d_i (in the first and last signatures).
+		 */
+		sigs[40] ^= 0x01;
+		if (curve9767_sign_verify_batch_vartime(sigs, msg, num)) {
+			fprintf(stderr, "Bad batch not rejected (2)\n");
+			exit(EXIT_FAILURE);
+		}
+		sigs[40] ^= 0x01;
+		sigs[((num - 1) << 6) + 40] ^= 0x01;
+		if (curve9767_sign_verify_batch_vartime(sigs, msg, num)) {
+			fprintf(stderr, "Bad batch not rejected (3)\n");
+			exit(EXIT_FAILURE);
+		}
+		sigs[((num - 1) << 6) + 40] ^= 0x01;
+
+		/*
+		 * Altered c_i.
+		 */
+		sigs[((num - 1) << 6) + 3] ^= 0x01;
+		if (curve9767_sign_verify_batch_vartime(sigs, msg, num)) {
+			fprintf(stderr, "Bad batch not rejected (4)\n");
+			exit(EXIT_FAILURE);
+		}
+		sigs[((num - 1) << 6) + 3] ^= 0x01;
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+#define ENGINE_TEST_NUM   8
+
+static uint32_t engine_test_count;
+
+static void
+engine_test_done(curve9767_job *job)
+{
+	(void)job;
+	__atomic_add_fetch(&engine_test_count, 1, __ATOMIC_RELEASE);
+}
+
+static void
+test_engine(void)
+{
+	shake_context rng;
+	curve9767_engine *eng;
+	curve9767_job jobs[8 * ENGINE_TEST_NUM], *job;
+	curve9767_scalar s[ENGINE_TEST_NUM], s2[ENGINE_TEST_NUM];
+	curve9767_scalar s3[ENGINE_TEST_NUM];
+	curve9767_point Q[ENGINE_TEST_NUM], Q2[ENGINE_TEST_NUM];
+	uint8_t seed[ENGINE_TEST_NUM][32], t[ENGINE_TEST_NUM][32];
+	uint8_t t2[ENGINE_TEST_NUM][32], eQ[ENGINE_TEST_NUM][32];
+	uint8_t eQ2[ENGINE_TEST_NUM][32], hv[ENGINE_TEST_NUM][32];
+	uint8_t sigs[4 * ENGINE_TEST_NUM][64], sig2[ENGINE_TEST_NUM][64];
+	uint8_t ss[ENGINE_TEST_NUM][32], ss2[ENGINE_TEST_NUM][32];
+	int expected[8 * ENGINE_TEST_NUM];
+	size_t u, n, num_jobs;
+	int mode;
+
+	printf("Test engine: ");
+	fflush(stdout);
+
+	if (curve9767_engine_new(0, 64, 4) != NULL
+		|| curve9767_engine_new(2, 48, 4) != NULL
+		|| curve9767_engine_new(2, 64, 1) != NULL)
+	{
+		fprintf(stderr, "Invalid engine parameters not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+
+	rand_init(&rng, "test_engine", 0);
+	for (u = 0; u < ENGINE_TEST_NUM; u ++) {
+		shake_extract(&rng, seed[u], sizeof seed[u]);
+		shake_extract(&rng, hv[u], sizeof hv[u]);
+		curve9767_keygen(&s[u], t[u], &Q[u], seed[u], sizeof seed[u]);
+	}
+	for (u = 0; u < 4 * ENGINE_TEST_NUM; u ++) {
+		size_t k;
+
+		k = u % ENGINE_TEST_NUM;
+		curve9767_sign_generate(sigs[u], &s[k], t[k], &Q[k],
+			CURVE9767_OID_SHA3_256, hv[k], sizeof hv[k]);
+		if (u % 5 == 3) {
+			sigs[u][40] ^= 0x01;
+		}
+	}
+
+	for (mode = 0; mode < 3; mode ++) {
+		/*
+		 * mode 0: completion queue
+		 * mode 1: callbacks
+		 * mode 2: callbacks, engine released right after submission
+		 */
+		eng = curve9767_engine_new(2, 64, 4);
+		if (eng == NULL) {
+			fprintf(stderr, "Engine creation failed\n");
+			exit(EXIT_FAILURE);
+		}
+		memset(s2, 0, sizeof s2);
+		memset(s3, 0, sizeof s3);
+		memset(t2, 0, sizeof t2);
+		memset(Q2, 0, sizeof Q2);
+		memset(eQ, 0, sizeof eQ);
+		memset(sig2, 0, sizeof sig2);
+		memset(ss, 0, sizeof ss);
+		n = 0;
+		for (u = 0; u < ENGINE_TEST_NUM; u ++) {
+			curve9767_job_keygen(&jobs[n], &s2[u], t2[u], &Q2[u],
+				seed[u], sizeof seed[u]);
+			expected[n ++] = 1;
+			curve9767_job_ecdh_keygen(&jobs[n], &s3[u], eQ[u],
+				seed[u], sizeof seed[u]);
+			expected[n ++] = 1;
+			curve9767_point_encode(eQ2[u],
+				&Q[(u + 1) % ENGINE_TEST_NUM]);
+			if (u == 2) {
+				eQ2[u][0] ^= 0x01;
+			}
+			curve9767_job_ecdh_recv(&jobs[n], ss[u], sizeof ss[u],
+				&s[u], eQ2[u]);
+			expected[n ++] = curve9767_ecdh_recv(ss2[u],
+				sizeof ss2[u], &s[u], eQ2[u]);
+			curve9767_job_sign(&jobs[n], sig2[u], &s[u], t[u],
+				&Q[u], CURVE9767_OID_SHA3_256,
+				hv[u], sizeof hv[u]);
+			expected[n ++] = 1;
+		}
+		for (u = 0; u < 4 * ENGINE_TEST_NUM; u ++) {
+			size_t k;
+
+			k = u % ENGINE_TEST_NUM;
+			curve9767_job_verify(&jobs[n], sigs[u], &Q[k],
+				CURVE9767_OID_SHA3_256, hv[k], sizeof hv[k]);
+			expected[n ++] = (u % 5 != 3);
+		}
+		num_jobs = n;
+
+		engine_test_count = 0;
+		for (u = 0; u < num_jobs; u ++) {
+			jobs[u].user = &expected[u];
+			jobs[u].result = -1;
+			if (!curve9767_engine_submit(eng, &jobs[u],
+				mode == 0 ? NULL : engine_test_done))
+			{
+				fprintf(stderr, "Job submission failed\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (mode == 0) {
+			n = 0;
+			while (n < num_jobs) {
+				job = curve9767_engine_poll(eng);
+				if (job == NULL) {
+					sched_yield();
+					continue;
+				}
+				if (job->result != *(int *)job->user) {
+					fprintf(stderr, "Wrong job result\n");
+					exit(EXIT_FAILURE);
+				}
+				n ++;
+			}
+			if (curve9767_engine_poll(eng) != NULL) {
+				fprintf(stderr, "Extra completed job\n");
+				exit(EXIT_FAILURE);
+			}
+		} else if (mode == 1) {
+			while (__atomic_load_n(&engine_test_count,
+				__ATOMIC_ACQUIRE) < num_jobs)
+			{
+				sched_yield();
+			}
+		}
+		curve9767_engine_free(eng);
+		if (mode != 0 && engine_test_count != num_jobs) {
+			fprintf(stderr, "Missing job completions\n");
+			exit(EXIT_FAILURE);
+		}
+
+		for (u = 0; u < num_jobs; u ++) {
+			if (jobs[u].result != expected[u]) {
+				fprintf(stderr, "Wrong job result\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		for (u = 0; u < ENGINE_TEST_NUM; u ++) {
+			uint8_t tmp1[32], tmp2[32], sig[64];
+
+			curve9767_scalar_encode(tmp1, &s[u]);
+			curve9767_scalar_encode(tmp2, &s2[u]);
+			check_equals(tmp1, tmp2, 32, "engine keygen (s)");
+			check_equals(t[u], t2[u], 32, "engine keygen (t)");
+			curve9767_point_encode(tmp1, &Q[u]);
+			curve9767_point_encode(tmp2, &Q2[u]);
+			check_equals(tmp1, tmp2, 32, "engine keygen (Q)");
+			curve9767_scalar_encode(tmp2, &s3[u]);
+			curve9767_scalar_encode(tmp1, &s[u]);
+			check_equals(tmp1, tmp2, 32, "engine ECDH keygen (s)");
+			curve9767_point_encode(tmp1, &Q[u]);
+			check_equals(tmp1, eQ[u], 32, "engine ECDH keygen (Q)");
+			check_equals(ss[u], ss2[u], 32, "engine ECDH");
+			curve9767_sign_generate(sig, &s[u], t[u], &Q[u],
+				CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+			check_equals(sig, sig2[u], 64, "engine sign");
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+/*
+ * Mixed workload on a multi-worker engine: the first verification job
+ * to complete blocks its worker (in the callback) until all other jobs
+ * have completed. Since a worker that takes verification jobs does not
+ * take other jobs along, all non-verification jobs must complete while
+ * that worker is blocked.
+ */
+
+#define ENGINE_MIXED_NUM   48
+
+static uint32_t engine_mixed_blocked;
+static uint32_t engine_mixed_release;
+static uint32_t engine_mixed_count;
+static uint32_t engine_mixed_other;
+
+static void
+engine_mixed_done(curve9767_job *job)
+{
+	if (job->op == CURVE9767_JOB_VERIFY) {
+		if (__atomic_exchange_n(&engine_mixed_blocked, 1,
+			__ATOMIC_ACQ_REL) == 0)
+		{
+			while (!__atomic_load_n(&engine_mixed_release,
+				__ATOMIC_ACQUIRE))
+			{
+				sched_yield();
+			}
+		}
+	} else {
+		__atomic_add_fetch(&engine_mixed_other, 1, __ATOMIC_RELEASE);
+	}
+	__atomic_add_fetch(&engine_mixed_count, 1, __ATOMIC_RELEASE);
+}
+
+static void
+test_engine_mixed(void)
+{
+	shake_context rng;
+	curve9767_engine *eng;
+	curve9767_job jobs[ENGINE_MIXED_NUM];
+	curve9767_scalar s[ENGINE_TEST_NUM];
+	curve9767_point Q[ENGINE_TEST_NUM];
+	uint8_t t[ENGINE_TEST_NUM][32], hv[ENGINE_TEST_NUM][32];
+	uint8_t eQ[ENGINE_TEST_NUM][32], sigs[ENGINE_TEST_NUM][64];
+	uint8_t out[ENGINE_MIXED_NUM][64], tmp[64];
+	uint32_t num_other;
+	size_t u;
+	time_t start;
+
+	printf("Test engine (mixed): ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_engine_mixed", 0);
+	for (u = 0; u < ENGINE_TEST_NUM; u ++) {
+		uint8_t seed[32];
+
+		shake_extract(&rng, seed, sizeof seed);
+		shake_extract(&rng, hv[u], sizeof hv[u]);
+		curve9767_keygen(&s[u], t[u], &Q[u], seed, sizeof seed);
+		curve9767_sign_generate(sigs[u], &s[u], t[u], &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+	}
+	for (u = 0; u < ENGINE_TEST_NUM; u ++) {
+		curve9767_point_encode(eQ[u], &Q[(u + 1) % ENGINE_TEST_NUM]);
+	}
+
+	eng = curve9767_engine_new(4, 64, 4);
+	if (eng == NULL) {
+		fprintf(stderr, "Engine creation failed\n");
+		exit(EXIT_FAILURE);
+	}
+	engine_mixed_blocked = 0;
+	engine_mixed_release = 0;
+	engine_mixed_count = 0;
+	engine_mixed_other = 0;
+	num_other = 0;
+	memset(out, 0, sizeof out);
+	for (u = 0; u < ENGINE_MIXED_NUM; u ++) {
+		size_t k;
+
+		k = u % ENGINE_TEST_NUM;
+		switch (u % 3) {
+		case 0:
+			curve9767_job_verify(&jobs[u], sigs[k], &Q[k],
+				CURVE9767_OID_SHA3_256, hv[k], sizeof hv[k]);
+			break;
+		case 1:
+			curve9767_job_sign(&jobs[u], out[u], &s[k], t[k],
+				&Q[k], CURVE9767_OID_SHA3_256,
+				hv[k], sizeof hv[k]);
+			num_other ++;
+			break;
+		default:
+			curve9767_job_ecdh_recv(&jobs[u], out[u], 32,
+				&s[k], eQ[k]);
+			num_other ++;
+			break;
+		}
+		jobs[u].result = -1;
+		if (!curve9767_engine_submit(eng, &jobs[u],
+			engine_mixed_done))
+		{
+			fprintf(stderr, "Job submission failed\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/*
+	 * All non-verification jobs must complete while a worker is
+	 * blocked in a verification callback.
+	 */
+	start = time(NULL);
+	while (__atomic_load_n(&engine_mixed_other, __ATOMIC_ACQUIRE)
+		< num_other)
+	{
+		if (time(NULL) - start > 60) {
+			fprintf(stderr, "Jobs held back by a worker\n");
+			exit(EXIT_FAILURE);
+		}
+		sched_yield();
+	}
+	printf(".");
+	fflush(stdout);
+	__atomic_store_n(&engine_mixed_release, 1, __ATOMIC_RELEASE);
+	while (__atomic_load_n(&engine_mixed_count, __ATOMIC_ACQUIRE)
+		< ENGINE_MIXED_NUM)
+	{
+		sched_yield();
+	}
+	curve9767_engine_free(eng);
+
+	for (u = 0; u < ENGINE_MIXED_NUM; u ++) {
+		size_t k;
+
+		k = u % ENGINE_TEST_NUM;
+		if (jobs[u].result != 1) {
+			fprintf(stderr, "Wrong job result\n");
+			exit(EXIT_FAILURE);
+		}
+		switch (u % 3) {
+		case 1:
+			check_equals(out[u], sigs[k], 64, "engine mixed sign");
+			break;
+		case 2:
+			curve9767_ecdh_recv(tmp, 32, &s[k], eQ[k]);
+			check_equals(out[u], tmp, 32, "engine mixed ECDH");
+			break;
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+check_sigcache_stats(curve9767_sigcache *sc, uint64_t hits, uint64_t misses)
+{
+	uint64_t h, m;
+
+	curve9767_sigcache_stats(sc, &h, &m);
+	if (h != hits || m != misses) {
+		fprintf(stderr, "Wrong cache counters: %lu/%lu (exp: %lu/%lu)\n",
+			(unsigned long)h, (unsigned long)m,
+			(unsigned long)hits, (unsigned long)misses);
+		exit(EXIT_FAILURE);
+	}
+}
+
+#define SIGCACHE_TEST_NUM   20
+
+static void
+test_sigcache(void)
+{
+	shake_context rng;
+	curve9767_sigcache *sc;
+	curve9767_point Q[SIGCACHE_TEST_NUM];
+	uint8_t hv[SIGCACHE_TEST_NUM][32], sigs[SIGCACHE_TEST_NUM][64];
+	uint64_t hits, misses;
+	size_t u;
+
+	printf("Test sigcache: ");
+	fflush(stdout);
+
+	if (curve9767_sigcache_new(((size_t)1 << 30) + 1) != NULL) {
+		fprintf(stderr, "Invalid cache capacity not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+
+	rand_init(&rng, "test_sigcache", 0);
+	for (u = 0; u < SIGCACHE_TEST_NUM; u ++) {
+		uint8_t seed[32], t[32];
+		curve9767_scalar s;
+
+		shake_extract(&rng, seed, sizeof seed);
+		curve9767_keygen(&s, t, &Q[u], seed, sizeof seed);
+		shake_extract(&rng, hv[u], sizeof hv[u]);
+		curve9767_sign_generate(sigs[u], &s, t, &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+	}
+
+	/*
+	 * Large cache: first verification is a miss, next ones are hits.
+	 */
+	sc = curve9767_sigcache_new(64);
+	if (sc == NULL) {
+		fprintf(stderr, "Cache creation failed\n");
+		exit(EXIT_FAILURE);
+	}
+	hits = 0;
+	misses = 0;
+	for (u = 0; u < SIGCACHE_TEST_NUM; u ++) {
+		int k;
+
+		for (k = 0; k < 3; k ++) {
+			if (!curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+				CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]))
+			{
+				fprintf(stderr, "Cached verification failed\n");
+				exit(EXIT_FAILURE);
+			}
+			if (k == 0) {
+				misses ++;
+			} else {
+				hits ++;
+			}
+			check_sigcache_stats(sc, hits, misses);
+		}
+
+		/*
+		 * Invalid signatures are rejected and never cached; a
+		 * different key, message or hash function identifier is
+		 * a different entry.
+		 */
+		for (k = 0; k < 2; k ++) {
+			sigs[u][40] ^= 0x01;
+			if (curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+				CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]))
+			{
+				fprintf(stderr, "Bad signature not rejected\n");
+				exit(EXIT_FAILURE);
+			}
+			sigs[u][40] ^= 0x01;
+			misses ++;
+			check_sigcache_stats(sc, hits, misses);
+		}
+		if (curve9767_sign_verify_cached(sc, sigs[u],
+			&Q[(u + 1) % SIGCACHE_TEST_NUM],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u])
+			|| curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u] - 1)
+			|| curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+			CURVE9767_OID_SHA3_512, hv[u], sizeof hv[u]))
+		{
+			fprintf(stderr, "Bad signature not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+		misses += 3;
+		check_sigcache_stats(sc, hits, misses);
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * All valid signatures are still in the cache.
+	 */
+	for (u = 0; u < SIGCACHE_TEST_NUM; u ++) {
+		if (!curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]))
+		{
+			fprintf(stderr, "Cached verification failed\n");
+			exit(EXIT_FAILURE);
+		}
+		hits ++;
+	}
+	check_sigcache_stats(sc, hits, misses);
+
+	/*
+	 * After clearing, all verifications are misses again.
+	 */
+	curve9767_sigcache_clear(sc);
+	for (u = 0; u < SIGCACHE_TEST_NUM; u ++) {
+		if (!curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]))
+		{
+			fprintf(stderr, "Cached verification failed\n");
+			exit(EXIT_FAILURE);
+		}
+		misses ++;
+	}
+	check_sigcache_stats(sc, hits, misses);
+	curve9767_sigcache_free(sc);
+
+	/*
+	 * Minimal cache (a single set of four entries): entries are
+	 * evicted in LRU order.
+	 */
+	sc = curve9767_sigcache_new(0);
+	if (sc == NULL) {
+		fprintf(stderr, "Cache creation failed\n");
+		exit(EXIT_FAILURE);
+	}
+	for (u = 0; u < 5; u ++) {
+		curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+		if (u == 2) {
+			/* Entry 0 becomes most recently used. */
+			curve9767_sign_verify_cached(sc, sigs[0], &Q[0],
+				CURVE9767_OID_SHA3_256, hv[0], sizeof hv[0]);
+		}
+	}
+	check_sigcache_stats(sc, 1, 5);
+
+	/* Entry 1 was evicted; entries 0, 2, 3 and 4 are present. */
+	curve9767_sign_verify_cached(sc, sigs[0], &Q[0],
+		CURVE9767_OID_SHA3_256, hv[0], sizeof hv[0]);
+	for (u = 2; u < 5; u ++) {
+		curve9767_sign_verify_cached(sc, sigs[u], &Q[u],
+			CURVE9767_OID_SHA3_256, hv[u], sizeof hv[u]);
+	}
+	check_sigcache_stats(sc, 5, 5);
+	curve9767_sign_verify_cached(sc, sigs[1], &Q[1],
+		CURVE9767_OID_SHA3_256, hv[1], sizeof hv[1]);
+	check_sigcache_stats(sc, 5, 6);
+	curve9767_sigcache_free(sc);
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
+static void
+test_keystore(void)
+{
+	shake_context rng;
+	union {
+		uint32_t w;
+		uint8_t b[CURVE9767_KEYSTORE_HEADER
+			+ 33 * sizeof(curve9767_keystore_entry)];
+	} store;
+	uint8_t keys[33 * 32], sig[64], hv[32], tmp[32];
+	curve9767_keystore ks;
+	curve9767_keystore_entry *ent;
+	curve9767_scalar s[32];
+	uint8_t t[32][32];
+	size_t u, num, len;
+
+	printf("Test keystore: ");
+	fflush(stdout);
+
+	rand_init(&rng, "test_keystore", 0);
+	for (u = 0; u < 32; u ++) {
+		uint8_t seed[32];
+		curve9767_point Q;
+
+		shake_extract(&rng, seed, sizeof seed);
+		curve9767_keygen(&s[u], t[u], &Q, seed, sizeof seed);
+		curve9767_point_encode(keys + (u << 5), &Q);
+	}
+	shake_extract(&rng, hv, sizeof hv);
+	ent = (curve9767_keystore_entry *)
+		(store.b + CURVE9767_KEYSTORE_HEADER);
+
+	for (num = 0; num <= 32; num ++) {
+		len = curve9767_keystore_size(num);
+		if (len != CURVE9767_KEYSTORE_HEADER
+			+ num * sizeof(curve9767_keystore_entry))
+		{
+			fprintf(stderr, "Wrong store size\n");
+			exit(EXIT_FAILURE);
+		}
+		if (curve9767_keystore_build(store.b, len - 1, keys, num)) {
+			fprintf(stderr, "Short buffer not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!curve9767_keystore_build(store.b, len, keys, num)) {
+			fprintf(stderr, "Store build failed\n");
+			exit(EXIT_FAILURE);
+		}
+		if (!curve9767_keystore_open(&ks, store.b, len)
+			|| ks.num != num)
+		{
+			fprintf(stderr, "Store open failed\n");
+			exit(EXIT_FAILURE);
+		}
+		if (curve9767_keystore_open(&ks, store.b, len - 1)
+			|| curve9767_keystore_open(&ks, store.b, len + 1))
+		{
+			fprintf(stderr, "Bad store length not rejected\n");
+			exit(EXIT_FAILURE);
+		}
+		curve9767_keystore_open(&ks, store.b, len);
+		if (!curve9767_keystore_check(&ks)) {
+			fprintf(stderr, "Store check failed\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/*
+		 * Entries must be sorted, and each key must be found and
+		 * usable for signature verification.
+		 */
+		for (u = 1; u < num; u ++) {
+			if (memcmp(ks.entries[u - 1].encoded,
+				ks.entries[u].encoded, 32) >= 0)
+			{
+				fprintf(stderr, "Store not sorted\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		for (u = 0; u < num; u ++) {
+			const curve9767_point *Q;
+
+			Q = curve9767_keystore_find(&ks, keys + (u << 5));
+			if (Q == NULL) {
+				fprintf(stderr, "Key not found\n");
+				exit(EXIT_FAILURE);
+			}
+			curve9767_point_encode(tmp, Q);
+			check_equals(tmp, keys + (u << 5), 32, "keystore find");
+			curve9767_sign_generate(sig, &s[u], t[u], Q,
+				CURVE9767_OID_SHA3_256, hv, sizeof hv);
+			if (!curve9767_sign_verify(sig, Q,
+				CURVE9767_OID_SHA3_256, hv, sizeof hv))
+			{
+				fprintf(stderr, "Verification failed\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		for (u = 0; u < num; u ++) {
+			curve9767_point_encode(tmp,
+				curve9767_keystore_get(&ks, u));
+			check_equals(tmp, ks.entries[u].encoded, 32,
+				"keystore get");
+		}
+		if (num < 32 && curve9767_keystore_find(&ks,
+			keys + (num << 5)) != NULL)
+		{
+			fprintf(stderr, "Absent key found\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/*
+		 * Altered decoded point must be detected by the full check
+		 * (but not by the opening).
+		 */
+		if (num > 0) {
+			ent[num >> 1].Q.y[3] ^= 0x0001;
+			if (!curve9767_keystore_open(&ks, store.b, len)
+				|| curve9767_keystore_check(&ks))
+			{
+				fprintf(stderr, "Bad store not rejected (1)\n");
+				exit(EXIT_FAILURE);
+			}
+			ent[num >> 1].Q.y[3] ^= 0x0001;
+		}
+
+		/*
+		 * Altered header.
+		 */
+		for (u = 0; u < 32; u ++) {
+			if (u >= 20 && u < 24) {
+				continue;
+			}
+			store.b[u] ^= 0x01;
+			if (curve9767_keystore_open(&ks, store.b, len)) {
+				fprintf(stderr, "Bad store not rejected (2)\n");
+				exit(EXIT_FAILURE);
+			}
+			store.b[u] ^= 0x01;
+		}
+
+		printf(".");
+		fflush(stdout);
+	}
+
+	/*
+	 * Duplicate keys and invalid keys are rejected.
+	 */
+	memcpy(keys + (32 << 5), keys + (7 << 5), 32);
+	if (curve9767_keystore_build(store.b,
+		curve9767_keystore_size(33), keys, 33))
+	{
+		fprintf(stderr, "Duplicate key not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+	memset(keys + (32 << 5), 0xFF, 32);
+	if (curve9767_keystore_build(store.b,
+		curve9767_keystore_size(33), keys, 33))
+	{
+		fprintf(stderr, "Invalid key not rejected\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/*
+	 * A failed build over an existing store must leave a buffer
+	 * that cannot be opened.
+	 */
+	len = curve9767_keystore_size(32);
+	for (u = 0; u < 2; u ++) {
+		if (!curve9767_keystore_build(store.b, len, keys, 32)) {
+			fprintf(stderr, "Store build failed\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(tmp, keys + (5 << 5), 32);
+		if (u == 0) {
+			memset(keys + (5 << 5), 0xFF, 32);
+		} else {
+			memcpy(keys + (5 << 5), keys + (9 << 5), 32);
+		}
+		if (curve9767_keystore_build(store.b, len, keys, 32)) {
+			fprintf(stderr, "Bad key not rejected (rebuild)\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(keys + (5 << 5), tmp, 32);
+		if (curve9767_keystore_open(&ks, store.b, len)) {
+			fprintf(stderr, "Failed rebuild can be opened\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	printf(" done.\n");
+	fflush(stdout);
+}
+
 static const char *const KAT_MONTE_CARLO[] = {
 	/*
 	 * Point multiplications are performed repeatedly:
@@ -4237,6 +6037,7 @@ main(void)
 {
 	test_SHAKE();
 	test_SHA3();
+	test_ParallelHash();
 	test_gf_add();
 	test_gf_sub();
 	test_gf_neg();
@@ -4244,18 +6045,32 @@ main(void)
 	test_gf_sqr();
 	test_gf_inv();
 	test_gf_sqrt();
+	test_gf_isqrt();
 	test_gf_cubert();
 	test_scalar();
 	test_reduce_basis();
 	test_codec();
+	test_point_full();
 	test_map_to_base();
 	test_basic();
 	test_combined();
+	test_point_mul_short();
+	test_mul2_add();
 	test_combined_vartime();
+	test_mulN_vartime();
+	test_point_mulN_vartime();
 	test_Icart_map();
 	test_hash_to_curve();
+	test_encode_to_curve();
 	test_ECDH();
 	test_signature();
+	test_sign_online();
+	test_sign_aggregate();
+	test_sign_batch();
+	test_engine();
+	test_engine_mixed();
+	test_sigcache();
+	test_keystore();
 	test_monte_carlo();
 	return 0;
 }